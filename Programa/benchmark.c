@@ -0,0 +1,388 @@
+/*****Datos administrativos************************
+ * Nombre del archivo: benchmark
+ * Tipo de archivo: C Fuente
+ * Proyecto: Sistema de Análisis de Datos de Ventas
+ *****Descripción**********************************
+ * Programa de medición de rendimiento. Genera un conjunto
+ * sintético de ventas en JSON con tamaño, cantidad de
+ * categorías, tasa de duplicados y tasa de atributos
+ * faltantes configurables, y mide el tiempo de cada etapa
+ * del sistema (importación, limpieza, análisis y guardado),
+ * reportando filas por segundo y el pico de memoria (RSS).
+ * Con la variable de entorno VENTAS_METRICAS también vuelca
+ * las métricas detalladas de metricas.h.
+ *
+ * Compilación:
+ *   gcc benchmark.c -o benchmark -lcjson -lm -pthread -lz
+ *
+ * Uso:
+ *   ./benchmark [-n filas] [-c categorias] [-d tasa_duplicados]
+ *               [-m tasa_faltantes] [-r repeticiones] [-s semilla]
+ *               [-o archivo_temporal] [-p hilos] [-e]
+ * Con -p la limpieza se mide con el canal paralelo de
+ * limpieza.h (0 usa la cantidad de núcleos) y los totales
+ * con esa cantidad de hilos; totalVentas se compara con una
+ * suma secuencial directa para medir el costo de la
+ * reducción por bloques. La importación
+ * se mide con el canal de importacion.h, o con la versión
+ * secuencial si se indica -e.
+ **************************************************/
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/resource.h>
+#include "ventas.h"
+#include "limpieza.h"
+#include "importacion.h"
+#include "consultas.h"
+
+/*****Nombre****************************************
+ * struct ConfigBenchmark
+ *****Descripción***********************************
+ * Parámetros del conjunto sintético y de la medición.
+ *****Campos****************************************
+ * @filas: Cantidad de registros a generar.
+ * @categorias: Cantidad de categorías distintas.
+ * @tasa_duplicados: Probabilidad de repetir un venta_id anterior.
+ * @tasa_faltantes: Probabilidad de que falte algún atributo.
+ * @repeticiones: Veces que se repite cada análisis.
+ * @semilla: Semilla del generador aleatorio.
+ * @archivo: Ruta del archivo JSON temporal.
+ * @hilos: Hilos del canal de limpieza paralelo, o -1 para
+ *         medir las etapas secuenciales de limpieza.
+ * @importacion_secuencial: 1 para medir importarDatos en lugar
+ *                          de la importación en canal.
+ ***************************************************/
+typedef struct {
+    size_t filas;
+    int categorias;
+    double tasa_duplicados;
+    double tasa_faltantes;
+    int repeticiones;
+    unsigned int semilla;
+    const char *archivo;
+    int hilos;
+    int importacion_secuencial;
+} ConfigBenchmark;
+
+static int stdout_original = -1;
+
+// Evita que el compilador descarte los resultados de los análisis medidos
+static volatile double sumidero;
+
+double tiempoActual() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+long picoMemoriaKB() {
+    struct rusage uso;
+    getrusage(RUSAGE_SELF, &uso);
+    return uso.ru_maxrss;
+}
+
+// Las funciones del sistema imprimen mensajes por registro; se silencian durante la medición
+void silenciarSalida() {
+    fflush(stdout);
+    stdout_original = dup(STDOUT_FILENO);
+    int nulo = open("/dev/null", O_WRONLY);
+    dup2(nulo, STDOUT_FILENO);
+    close(nulo);
+}
+
+void restaurarSalida() {
+    fflush(stdout);
+    dup2(stdout_original, STDOUT_FILENO);
+    close(stdout_original);
+}
+
+double aleatorio() {
+    return rand() / ((double)RAND_MAX + 1.0);
+}
+
+/*****Nombre***************************************
+ * Función generarDatos
+ *****Descripción**********************************
+ * Escribe en `config->archivo` un arreglo JSON de ventas
+ * sintéticas. Con probabilidad `tasa_duplicados` se reutiliza
+ * un venta_id anterior; con probabilidad `tasa_faltantes` se
+ * omite un atributo (obligatorio, cantidad o precio).
+ *****Retorno**************************************
+ * @return: 1 si el archivo se generó, 0 en caso de error.
+ ****Entradas**************************************
+ * @param config: Parámetros del conjunto sintético.
+ **************************************************/
+int generarDatos(const ConfigBenchmark *config) {
+    FILE *archivo = fopen(config->archivo, "w");
+    if (archivo == NULL) {
+        fprintf(stderr, "Error al crear el archivo %s.\n", config->archivo);
+        return 0;
+    }
+
+    const char *atributos[] = { "venta_id", "fecha", "producto_id", "producto_nombre", "categoria", "cantidad", "precio_unitario" };
+    int siguiente_id = 1;
+
+    srand(config->semilla);
+    fputs("[\n", archivo);
+    for (size_t i = 0; i < config->filas; i++) {
+        int venta_id = (siguiente_id > 1 && aleatorio() < config->tasa_duplicados) ? 1 + rand() % (siguiente_id - 1) : siguiente_id++;
+        int categoria = 1 + rand() % config->categorias;
+        int producto_id = 100 + categoria * 1000 + rand() % 50;
+        int cantidad = 1 + rand() % 20;
+        double precio = (1 + rand() % 10000) / 100.0;
+        int faltante = aleatorio() < config->tasa_faltantes ? rand() % 7 : -1;
+
+        fputs(i == 0 ? "    {" : ",\n    {", archivo);
+        int campos = 0;
+        for (int a = 0; a < 7; a++) {
+            if (a == faltante) {
+                continue;
+            }
+            fprintf(archivo, "%s\"%s\": ", campos++ ? ", " : "", atributos[a]);
+            switch (a) {
+                case 0: fprintf(archivo, "%d", venta_id); break;
+                case 1: fprintf(archivo, "\"%04d-%02d-%02d\"", 2020 + rand() % 5, 1 + rand() % 12, 1 + rand() % 28); break;
+                case 2: fprintf(archivo, "%d", producto_id); break;
+                case 3: fprintf(archivo, "\"Producto %d\"", producto_id); break;
+                case 4: fprintf(archivo, "\"Categoría %d\"", categoria); break;
+                case 5: fprintf(archivo, "%d", cantidad); break;
+                case 6: fprintf(archivo, "%.2f", precio); break;
+            }
+        }
+        fprintf(archivo, ", \"total\": %.2f}", faltante == 5 || faltante == 6 ? 0.0 : cantidad * precio);
+    }
+    fputs("\n]\n", archivo);
+    fclose(archivo);
+    return 1;
+}
+
+void reportarEtapa(const char *etapa, double segundos, size_t filas, int repeticiones) {
+    double por_rep = segundos / repeticiones;
+    double filas_s = por_rep > 0 ? filas / por_rep : 0.0;
+    printf("  %-28s %12.6f s %14.0f filas/s %10ld KB\n", etapa, por_rep, filas_s, picoMemoriaKB());
+}
+
+void medirAnalisis(listaVentas *lista, int repeticiones, int hilos_medicion) {
+    size_t filas = lista->size;
+    double inicio;
+
+    silenciarSalida();
+    // Una pasada sin medir, para que la reducción y la suma de referencia partan con la misma caché
+    sumidero = totalVentas(lista);
+    inicio = tiempoActual();
+    for (int r = 0; r < repeticiones; r++) {
+        sumidero = totalVentas(lista);
+    }
+    double t_total = tiempoActual() - inicio;
+
+    // Referencia: suma secuencial directa, sin la reducción por bloques de reduccion.h
+    dinero referencia = 0;
+    inicio = tiempoActual();
+    for (int r = 0; r < repeticiones; r++) {
+        referencia = 0;
+        for (size_t i = 0; i < lista->size; i++) {
+            referencia += importeVenta(&lista->ventas[i]);
+        }
+        sumidero = referencia;
+    }
+    double t_total_secuencial = tiempoActual() - inicio;
+
+    // El total debe ser idéntico con cualquier cantidad de hilos
+    int identicos = 1;
+    for (int hilos = 1; hilos <= 8; hilos *= 2) {
+        configurarHilosReduccion(hilos);
+        identicos &= (totalVentas(lista) == referencia);
+    }
+    configurarHilosReduccion(hilos_medicion);
+
+    inicio = tiempoActual();
+    for (int r = 0; r < repeticiones; r++) {
+        char **meses;
+        dinero *totales;
+        size_t num;
+        totalVentasMensuales(lista, &meses, &totales, &num);
+        for (size_t i = 0; i < num; i++) {
+            free(meses[i]);
+        }
+        free(meses);
+        free(totales);
+    }
+    double t_mensual = tiempoActual() - inicio;
+
+    inicio = tiempoActual();
+    for (int r = 0; r < repeticiones; r++) {
+        char **años;
+        dinero *totales;
+        size_t num;
+        totalVentasAnuales(lista, &años, &totales, &num);
+        for (size_t i = 0; i < num; i++) {
+            free(años[i]);
+        }
+        free(años);
+        free(totales);
+    }
+    double t_anual = tiempoActual() - inicio;
+
+    inicio = tiempoActual();
+    for (int r = 0; r < repeticiones; r++) {
+        mesConMayorVenta(lista);
+    }
+    double t_mes = tiempoActual() - inicio;
+
+    inicio = tiempoActual();
+    for (int r = 0; r < repeticiones; r++) {
+        diaMasActivo(lista);
+    }
+    double t_dia = tiempoActual() - inicio;
+
+    inicio = tiempoActual();
+    for (int r = 0; r < repeticiones; r++) {
+        sumidero = tasaCrecimientoTrimestral(lista, 2, 2022);
+    }
+    double t_tasa = tiempoActual() - inicio;
+
+    inicio = tiempoActual();
+    for (int r = 0; r < repeticiones; r++) {
+        obtenerTopCategorias(lista);
+    }
+    double t_top = tiempoActual() - inicio;
+
+    Consulta consulta;
+    analizarConsulta(lista, "desde=2022-04;hasta=2022-06;categoria=Categoría 1;agrupar=mes", &consulta);
+    inicio = tiempoActual();
+    for (int r = 0; r < repeticiones; r++) {
+        ResultadoConsulta resultado;
+        if (ejecutarConsulta(lista, &consulta, &resultado)) {
+            sumidero = (double)resultado.num_grupos;
+            liberarResultadoConsulta(&resultado);
+        }
+    }
+    double t_consulta = tiempoActual() - inicio;
+    restaurarSalida();
+
+    reportarEtapa("totalVentas", t_total, filas, repeticiones);
+    reportarEtapa("totalVentas (secuencial)", t_total_secuencial, filas, repeticiones);
+    reportarEtapa("totalVentasMensuales", t_mensual, filas, repeticiones);
+    reportarEtapa("totalVentasAnuales", t_anual, filas, repeticiones);
+    reportarEtapa("mesConMayorVenta", t_mes, filas, repeticiones);
+    reportarEtapa("diaMasActivo", t_dia, filas, repeticiones);
+    reportarEtapa("tasaCrecimientoTrimestral", t_tasa, filas, repeticiones);
+    reportarEtapa("obtenerTopCategorias", t_top, filas, repeticiones);
+    reportarEtapa("ejecutarConsulta", t_consulta, filas, repeticiones);
+    printf("  Total idéntico con 1, 2, 4 y 8 hilos: %s\n", identicos ? "sí" : "no");
+}
+
+void mostrarUso(const char *programa) {
+    fprintf(stderr, "Uso: %s [-n filas] [-c categorias] [-d tasa_duplicados] [-m tasa_faltantes]\n", programa);
+    fprintf(stderr, "       [-r repeticiones] [-s semilla] [-o archivo_temporal] [-p hilos] [-e]\n");
+}
+
+int main(int argc, char *argv[]) {
+    ConfigBenchmark config = { 2000, 10, 0.05, 0.02, 5, 42, "benchmark_ventas.json", -1, 0 };
+
+    int opcion;
+    while ((opcion = getopt(argc, argv, "n:c:d:m:r:s:o:p:eh")) != -1) {
+        switch (opcion) {
+            case 'n': config.filas = strtoul(optarg, NULL, 10); break;
+            case 'c': config.categorias = atoi(optarg); break;
+            case 'd': config.tasa_duplicados = atof(optarg); break;
+            case 'm': config.tasa_faltantes = atof(optarg); break;
+            case 'r': config.repeticiones = atoi(optarg); break;
+            case 's': config.semilla = (unsigned int)strtoul(optarg, NULL, 10); break;
+            case 'o': config.archivo = optarg; break;
+            case 'p': config.hilos = atoi(optarg); break;
+            case 'e': config.importacion_secuencial = 1; break;
+            default:
+                mostrarUso(argv[0]);
+                return EXIT_FAILURE;
+        }
+    }
+    if (config.filas == 0 || config.categorias <= 0 || config.repeticiones <= 0) {
+        mostrarUso(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    // Con VENTAS_METRICAS definida, también se vuelca el resumen JSON por etapa
+    iniciarMetricasDesdeEntorno();
+
+    // El detalle por registro se descarta; solo se cuentan los eventos
+    configurarDiagnosticos(1, 0, NULL);
+
+    printf("Benchmark: %zu filas, %d categorías, %.1f%% duplicados, %.1f%% faltantes, %d repeticiones\n",
+           config.filas, config.categorias, config.tasa_duplicados * 100, config.tasa_faltantes * 100, config.repeticiones);
+
+    double inicio = tiempoActual();
+    if (!generarDatos(&config)) {
+        return EXIT_FAILURE;
+    }
+    printf("Datos generados en %.3f s\n\n", tiempoActual() - inicio);
+
+    char salida[512];
+    snprintf(salida, sizeof(salida), "%s.procesado", config.archivo);
+
+    listaVentas *lista = crearListaVentas();
+    if (lista == NULL) {
+        return EXIT_FAILURE;
+    }
+
+    printf("  %-28s %14s %20s %13s\n", "Etapa", "Tiempo", "Rendimiento", "Pico RSS");
+
+    silenciarSalida();
+    inicio = tiempoActual();
+    if (config.importacion_secuencial) {
+        importarDatos(lista, config.archivo);
+    } else {
+        importarDatosEnParalelo(lista, config.archivo, config.hilos > 0 ? config.hilos : 0);
+    }
+    double t_importar = tiempoActual() - inicio;
+    restaurarSalida();
+    reportarEtapa("importarDatos", t_importar, config.filas, 1);
+
+    size_t filas = lista->size;
+    if (config.hilos >= 0) {
+        silenciarSalida();
+        inicio = tiempoActual();
+        limpiarDatos(lista, '1', config.hilos);
+        double t_limpieza = tiempoActual() - inicio;
+        restaurarSalida();
+        reportarEtapa("limpiarDatos", t_limpieza, filas, 1);
+    } else {
+        silenciarSalida();
+        inicio = tiempoActual();
+        eliminarDatosDuplicados(lista);
+        double t_duplicados = tiempoActual() - inicio;
+        restaurarSalida();
+        reportarEtapa("eliminarDatosDuplicados", t_duplicados, filas, 1);
+
+        filas = lista->size;
+        silenciarSalida();
+        inicio = tiempoActual();
+        completarDatosConMetodo(lista, '1');
+        double t_completar = tiempoActual() - inicio;
+        restaurarSalida();
+        reportarEtapa("completarDatos", t_completar, filas, 1);
+    }
+
+    configurarHilosReduccion(config.hilos > 0 ? config.hilos : 0);
+    medirAnalisis(lista, config.repeticiones, config.hilos > 0 ? config.hilos : 0);
+
+    silenciarSalida();
+    inicio = tiempoActual();
+    guardarDatosProcesados(lista, salida);
+    double t_guardar = tiempoActual() - inicio;
+    restaurarSalida();
+    reportarEtapa("guardarDatosProcesados", t_guardar, lista->size, 1);
+
+    printf("\nRegistros finales: %zu de %zu generados\n", lista->size, config.filas);
+    printf("Pico de memoria (RSS): %ld KB\n", picoMemoriaKB());
+
+    liberarListaVentas(lista);
+    remove(config.archivo);
+    remove(salida);
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,573 @@
+#ifndef BOSQUEJOS_H
+#define BOSQUEJOS_H
+
+/*****Datos administrativos************************
+ * Nombre del archivo: bosquejos
+ * Tipo de archivo: C Encabezado
+ * Proyecto: Sistema de Análisis de Datos de Ventas
+ *****Descripción**********************************
+ * Estructuras de resumen aproximado ("sketches") para
+ * el modo de análisis aproximado. Se actualizan una vez
+ * por venta durante la importación y responden en
+ * memoria constante, con error acotado:
+ *  - HyperLogLog: cantidad de valores distintos
+ *    (error relativo típico de 1.04 / sqrt(2^14) ~ 0.8%).
+ *  - Count-Min: estimación por exceso del peso de una clave.
+ *  - Space-Saving: claves más pesadas (top-k) con cota de error.
+ *  - t-digest: cuantiles (mediana, p90, p99) de un valor.
+ **************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <math.h>
+#include "metricas.h"
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+#define HLL_PRECISION 14
+#define HLL_REGISTROS (1 << HLL_PRECISION)
+#define CM_PROFUNDIDAD 4
+#define CM_ANCHO 2048
+#define MAX_FRECUENTES 64
+#define TDIGEST_COMPRESION 100
+#define TDIGEST_BUFFER 512
+
+// Mezcla de 64 bits (splitmix64) para los hashes de los bosquejos
+uint64_t mezclar64(uint64_t x) {
+    x += 0x9e3779b97f4a7c15ULL;
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+    return x ^ (x >> 31);
+}
+
+// Hash FNV-1a de una cadena, mezclado
+uint64_t hashCadena(const char *cadena) {
+    uint64_t hash = 0xcbf29ce484222325ULL;
+    for (const unsigned char *c = (const unsigned char *)cadena; *c; c++) {
+        hash ^= *c;
+        hash *= 0x100000001b3ULL;
+    }
+    return mezclar64(hash);
+}
+
+/*****Nombre****************************************
+ * struct hyperLogLog
+ *****Descripción***********************************
+ * Contador aproximado de valores distintos.
+ *****Campos****************************************
+ * @registros: Máximo rango observado por registro.
+ ***************************************************/
+typedef struct {
+    uint8_t registros[HLL_REGISTROS];
+} hyperLogLog;
+
+void agregarHyperLogLog(hyperLogLog *hll, uint64_t hash) {
+    size_t registro = hash >> (64 - HLL_PRECISION);
+    uint64_t resto = (hash << HLL_PRECISION) | (1ULL << (HLL_PRECISION - 1));
+    uint8_t rango = (uint8_t)(__builtin_clzll(resto) + 1);
+    if (rango > hll->registros[registro]) {
+        hll->registros[registro] = rango;
+    }
+}
+
+// Une dos HyperLogLog: el resultado cuenta la unión de ambos conjuntos
+void combinarHyperLogLog(hyperLogLog *destino, const hyperLogLog *origen) {
+    for (size_t i = 0; i < HLL_REGISTROS; i++) {
+        if (origen->registros[i] > destino->registros[i]) {
+            destino->registros[i] = origen->registros[i];
+        }
+    }
+}
+
+/*****Nombre***************************************
+ * Función estimarHyperLogLog
+ *****Descripción**********************************
+ * Estima la cantidad de valores distintos, con la
+ * corrección de conteo lineal para cardinalidades bajas.
+ *****Retorno**************************************
+ * @return: Cantidad estimada de valores distintos.
+ ****Entradas**************************************
+ * @param hll: Un puntero al struct `hyperLogLog`.
+ **************************************************/
+double estimarHyperLogLog(const hyperLogLog *hll) {
+    double m = HLL_REGISTROS;
+    double suma = 0.0;
+    size_t vacios = 0;
+    for (size_t i = 0; i < HLL_REGISTROS; i++) {
+        suma += ldexp(1.0, -hll->registros[i]);
+        if (hll->registros[i] == 0) {
+            vacios++;
+        }
+    }
+
+    double alfa = 0.7213 / (1.0 + 1.079 / m);
+    double estimacion = alfa * m * m / suma;
+    if (estimacion <= 2.5 * m && vacios > 0) {
+        estimacion = m * log(m / vacios);
+    }
+    return estimacion;
+}
+
+/*****Nombre****************************************
+ * struct conteoMinimo
+ *****Descripción***********************************
+ * Bosquejo Count-Min: estima por exceso el peso
+ * acumulado de cualquier clave.
+ *****Campos****************************************
+ * @celdas: Contadores por fila y columna.
+ ***************************************************/
+typedef struct {
+    double celdas[CM_PROFUNDIDAD][CM_ANCHO];
+} conteoMinimo;
+
+void agregarConteoMinimo(conteoMinimo *cm, uint64_t hash, double peso) {
+    for (int fila = 0; fila < CM_PROFUNDIDAD; fila++) {
+        size_t columna = mezclar64(hash + fila) % CM_ANCHO;
+        cm->celdas[fila][columna] += peso;
+    }
+}
+
+// Suma las celdas de otro Count-Min con las mismas dimensiones
+void combinarConteoMinimo(conteoMinimo *destino, const conteoMinimo *origen) {
+    for (int fila = 0; fila < CM_PROFUNDIDAD; fila++) {
+        for (size_t columna = 0; columna < CM_ANCHO; columna++) {
+            destino->celdas[fila][columna] += origen->celdas[fila][columna];
+        }
+    }
+}
+
+double estimarConteoMinimo(const conteoMinimo *cm, uint64_t hash) {
+    double minimo = INFINITY;
+    for (int fila = 0; fila < CM_PROFUNDIDAD; fila++) {
+        double valor = cm->celdas[fila][mezclar64(hash + fila) % CM_ANCHO];
+        if (valor < minimo) {
+            minimo = valor;
+        }
+    }
+    return minimo;
+}
+
+/*****Nombre****************************************
+ * struct elementosFrecuentes
+ *****Descripción***********************************
+ * Resumen Space-Saving ponderado de las claves más
+ * pesadas. El peso real de cada clave guardada está
+ * entre `peso - error` y `peso`.
+ *****Campos****************************************
+ * @claves: Hash de cada clave guardada.
+ * @etiquetas: Texto de cada clave guardada.
+ * @pesos: Peso estimado de cada clave.
+ * @errores: Sobreestimación máxima de cada clave.
+ * @num: Cantidad de claves guardadas.
+ ***************************************************/
+typedef struct {
+    uint64_t claves[MAX_FRECUENTES];
+    char *etiquetas[MAX_FRECUENTES];
+    double pesos[MAX_FRECUENTES];
+    double errores[MAX_FRECUENTES];
+    size_t num;
+} elementosFrecuentes;
+
+// Agrega un peso que ya trae una sobreestimación máxima (0 para una venta)
+void agregarElementosFrecuentesConError(elementosFrecuentes *ef, uint64_t clave, const char *etiqueta, double peso, double error) {
+    size_t minimo = 0;
+    for (size_t i = 0; i < ef->num; i++) {
+        if (ef->claves[i] == clave) {
+            ef->pesos[i] += peso;
+            ef->errores[i] += error;
+            return;
+        }
+        if (ef->pesos[i] < ef->pesos[minimo]) {
+            minimo = i;
+        }
+    }
+
+    if (ef->num < MAX_FRECUENTES) {
+        size_t i = ef->num++;
+        ef->claves[i] = clave;
+        ef->etiquetas[i] = strdupContado(etiqueta);
+        ef->pesos[i] = peso;
+        ef->errores[i] = error;
+        return;
+    }
+
+    // Reemplazar la clave de menor peso; el nuevo peso hereda el anterior como error
+    free(ef->etiquetas[minimo]);
+    ef->claves[minimo] = clave;
+    ef->etiquetas[minimo] = strdupContado(etiqueta);
+    ef->errores[minimo] = ef->pesos[minimo] + error;
+    ef->pesos[minimo] += peso;
+}
+
+void agregarElementosFrecuentes(elementosFrecuentes *ef, uint64_t clave, const char *etiqueta, double peso) {
+    agregarElementosFrecuentesConError(ef, clave, etiqueta, peso, 0.0);
+}
+
+// Agrega las claves de otro resumen, conservando sus cotas de error
+void combinarElementosFrecuentes(elementosFrecuentes *destino, const elementosFrecuentes *origen) {
+    for (size_t i = 0; i < origen->num; i++) {
+        agregarElementosFrecuentesConError(destino, origen->claves[i], origen->etiquetas[i], origen->pesos[i], origen->errores[i]);
+    }
+}
+
+// Ordena las claves guardadas de mayor a menor peso
+void ordenarElementosFrecuentes(elementosFrecuentes *ef) {
+    for (size_t i = 1; i < ef->num; i++) {
+        for (size_t j = i; j > 0 && ef->pesos[j] > ef->pesos[j - 1]; j--) {
+            uint64_t clave = ef->claves[j]; ef->claves[j] = ef->claves[j - 1]; ef->claves[j - 1] = clave;
+            char *etiqueta = ef->etiquetas[j]; ef->etiquetas[j] = ef->etiquetas[j - 1]; ef->etiquetas[j - 1] = etiqueta;
+            double peso = ef->pesos[j]; ef->pesos[j] = ef->pesos[j - 1]; ef->pesos[j - 1] = peso;
+            double error = ef->errores[j]; ef->errores[j] = ef->errores[j - 1]; ef->errores[j - 1] = error;
+        }
+    }
+}
+
+/*****Nombre****************************************
+ * struct Centroide
+ *****Descripción***********************************
+ * Grupo de valores de un t-digest.
+ *****Campos****************************************
+ * @media: Media de los valores del grupo.
+ * @peso: Cantidad de valores del grupo.
+ ***************************************************/
+typedef struct {
+    double media;
+    double peso;
+} Centroide;
+
+/*****Nombre****************************************
+ * struct tDigest
+ *****Descripción***********************************
+ * t-digest con fusión por lotes: los valores nuevos se
+ * acumulan en un buffer y se fusionan con los centroides
+ * cuando el buffer se llena. La cantidad de centroides
+ * queda acotada por la compresión.
+ *****Campos****************************************
+ * @centroides: Centroides fusionados, ordenados por media.
+ * @num_centroides: Cantidad de centroides.
+ * @buffer: Valores pendientes de fusionar.
+ * @num_buffer: Cantidad de valores pendientes.
+ * @peso_total: Cantidad total de valores agregados.
+ * @minimo: Menor valor agregado.
+ * @maximo: Mayor valor agregado.
+ ***************************************************/
+typedef struct {
+    Centroide centroides[TDIGEST_COMPRESION * 2 + TDIGEST_BUFFER];
+    size_t num_centroides;
+    double buffer[TDIGEST_BUFFER];
+    size_t num_buffer;
+    double peso_total;
+    double minimo;
+    double maximo;
+} tDigest;
+
+int compararCentroides(const void *a, const void *b) {
+    double x = ((const Centroide *)a)->media;
+    double y = ((const Centroide *)b)->media;
+    return (x > y) - (x < y);
+}
+
+// Función de escala k1 del t-digest
+double escalaTDigest(double q) {
+    return TDIGEST_COMPRESION / (2.0 * M_PI) * asin(2.0 * q - 1.0);
+}
+
+// Ordena los primeros `total` centroides por media y une los vecinos según la función de escala
+void compactarCentroides(tDigest *td, size_t total) {
+    if (total == 0) {
+        td->num_centroides = 0;
+        return;
+    }
+    qsort(td->centroides, total, sizeof(Centroide), compararCentroides);
+
+    size_t salida = 0;
+    double acumulado = 0.0;
+    double k_inicio = escalaTDigest(0.0);
+    Centroide actual = td->centroides[0];
+    for (size_t i = 1; i < total; i++) {
+        Centroide siguiente = td->centroides[i];
+        double q = (acumulado + actual.peso + siguiente.peso) / td->peso_total;
+        if (escalaTDigest(q) - k_inicio <= 1.0) {
+            actual.media += (siguiente.media - actual.media) * siguiente.peso / (actual.peso + siguiente.peso);
+            actual.peso += siguiente.peso;
+        } else {
+            acumulado += actual.peso;
+            k_inicio = escalaTDigest(acumulado / td->peso_total);
+            td->centroides[salida++] = actual;
+            actual = siguiente;
+        }
+    }
+    td->centroides[salida++] = actual;
+    td->num_centroides = salida;
+}
+
+/*****Nombre***************************************
+ * Función fusionarTDigest
+ *****Descripción**********************************
+ * Fusiona el buffer con los centroides existentes:
+ * ordena todo por media y une centroides vecinos
+ * mientras el grupo resultante no supere una unidad
+ * de la función de escala.
+ *****Retorno**************************************
+ *
+ ****Entradas**************************************
+ * @param td: Un puntero al struct `tDigest`.
+ **************************************************/
+void fusionarTDigest(tDigest *td) {
+    if (td->num_buffer == 0) {
+        return;
+    }
+
+    size_t total = td->num_centroides;
+    for (size_t i = 0; i < td->num_buffer; i++) {
+        td->centroides[total].media = td->buffer[i];
+        td->centroides[total].peso = 1.0;
+        total++;
+        td->peso_total += 1.0;
+    }
+    td->num_buffer = 0;
+    compactarCentroides(td, total);
+}
+
+void agregarTDigest(tDigest *td, double valor) {
+    if (td->peso_total == 0.0 && td->num_buffer == 0) {
+        td->minimo = valor;
+        td->maximo = valor;
+    }
+    if (valor < td->minimo) td->minimo = valor;
+    if (valor > td->maximo) td->maximo = valor;
+
+    td->buffer[td->num_buffer++] = valor;
+    if (td->num_buffer == TDIGEST_BUFFER) {
+        fusionarTDigest(td);
+    }
+}
+
+/*****Nombre***************************************
+ * Función combinarTDigest
+ *****Descripción**********************************
+ * Agrega los centroides de otro t-digest como si sus
+ * valores se hubieran agregado a este, compactando
+ * cada vez que se llena el arreglo de centroides.
+ *****Retorno**************************************
+ *
+ ****Entradas**************************************
+ * @param destino: t-digest que recibe los valores.
+ * @param origen: t-digest que se agrega (se fusiona su buffer).
+ **************************************************/
+void combinarTDigest(tDigest *destino, tDigest *origen) {
+    fusionarTDigest(origen);
+    if (origen->num_centroides == 0) {
+        return;
+    }
+    fusionarTDigest(destino);
+    if (destino->num_centroides == 0) {
+        destino->minimo = origen->minimo;
+        destino->maximo = origen->maximo;
+    }
+    if (origen->minimo < destino->minimo) destino->minimo = origen->minimo;
+    if (origen->maximo > destino->maximo) destino->maximo = origen->maximo;
+
+    size_t capacidad = sizeof(destino->centroides) / sizeof(Centroide);
+    size_t total = destino->num_centroides;
+    for (size_t i = 0; i < origen->num_centroides; i++) {
+        if (total == capacidad) {
+            compactarCentroides(destino, total);
+            total = destino->num_centroides;
+        }
+        destino->centroides[total++] = origen->centroides[i];
+        destino->peso_total += origen->centroides[i].peso;
+    }
+    compactarCentroides(destino, total);
+}
+
+/*****Nombre***************************************
+ * Función cuantilTDigest
+ *****Descripción**********************************
+ * Estima el cuantil `q` interpolando entre los centros
+ * de los centroides vecinos.
+ *****Retorno**************************************
+ * @return: El valor estimado del cuantil, o NAN si no
+ *          hay datos.
+ ****Entradas**************************************
+ * @param td: Un puntero al struct `tDigest`.
+ * @param q: Cuantil entre 0 y 1 (0.5 para la mediana).
+ **************************************************/
+double cuantilTDigest(tDigest *td, double q) {
+    fusionarTDigest(td);
+    if (td->num_centroides == 0) {
+        return NAN;
+    }
+    if (td->num_centroides == 1) {
+        return td->centroides[0].media;
+    }
+
+    double indice = q * td->peso_total;
+    Centroide *c = td->centroides;
+    if (indice < c[0].peso / 2.0) {
+        return td->minimo + (c[0].media - td->minimo) * indice / (c[0].peso / 2.0);
+    }
+
+    double acumulado = 0.0;
+    for (size_t i = 0; i + 1 < td->num_centroides; i++) {
+        double izquierda = acumulado + c[i].peso / 2.0;
+        double derecha = acumulado + c[i].peso + c[i + 1].peso / 2.0;
+        if (indice <= derecha) {
+            double t = (indice - izquierda) / (derecha - izquierda);
+            return c[i].media + t * (c[i + 1].media - c[i].media);
+        }
+        acumulado += c[i].peso;
+    }
+
+    Centroide *ultimo = &c[td->num_centroides - 1];
+    double restante = td->peso_total - indice;
+    if (restante <= 0.0) {
+        return td->maximo;
+    }
+    return td->maximo - (td->maximo - ultimo->media) * restante / (ultimo->peso / 2.0);
+}
+
+/*****Nombre****************************************
+ * struct bosquejosVentas
+ *****Descripción***********************************
+ * Conjunto de bosquejos mantenidos durante la
+ * importación en el modo aproximado.
+ *****Campos****************************************
+ * @filas: Ventas registradas.
+ * @ids_venta: Valores distintos de venta_id.
+ * @ids_producto: Valores distintos de producto_id.
+ * @ingresos_categoria: Ingreso por categoría (Count-Min).
+ * @top_categorias: Categorías con más ingreso (Space-Saving).
+ * @top_productos: Productos con más ingreso (Space-Saving).
+ * @precios: Distribución de precios unitarios positivos.
+ ***************************************************/
+typedef struct {
+    size_t filas;
+    hyperLogLog ids_venta;
+    hyperLogLog ids_producto;
+    conteoMinimo ingresos_categoria;
+    elementosFrecuentes top_categorias;
+    elementosFrecuentes top_productos;
+    tDigest precios;
+} bosquejosVentas;
+
+bosquejosVentas* crearBosquejosVentas() {
+    bosquejosVentas *bosquejos = (bosquejosVentas *)callocContado(1, sizeof(bosquejosVentas));
+    if (bosquejos == NULL) {
+        printf("Error al asignar memoria para los bosquejos.\n");
+    }
+    return bosquejos;
+}
+
+void liberarBosquejosVentas(bosquejosVentas *bosquejos) {
+    if (bosquejos != NULL) {
+        for (size_t i = 0; i < bosquejos->top_categorias.num; i++) {
+            free(bosquejos->top_categorias.etiquetas[i]);
+        }
+        for (size_t i = 0; i < bosquejos->top_productos.num; i++) {
+            free(bosquejos->top_productos.etiquetas[i]);
+        }
+        free(bosquejos);
+    }
+}
+
+/*****Nombre***************************************
+ * Función registrarVentaBosquejos
+ *****Descripción**********************************
+ * Actualiza todos los bosquejos con una venta.
+ *****Retorno**************************************
+ *
+ ****Entradas**************************************
+ * @param bosquejos: Un puntero al struct `bosquejosVentas`.
+ * @param venta_id: Identificador de la venta.
+ * @param producto_id: Identificador del producto.
+ * @param producto_nombre: Nombre del producto.
+ * @param categoria: Categoría del producto.
+ * @param precio_unitario: Precio unitario (se ignora si no es positivo).
+ * @param total: Importe de la venta.
+ **************************************************/
+void registrarVentaBosquejos(bosquejosVentas *bosquejos, int venta_id, int producto_id, const char *producto_nombre,
+                             const char *categoria, double precio_unitario, double total) {
+    uint64_t hash_producto = mezclar64((uint64_t)(uint32_t)producto_id);
+    uint64_t hash_categoria = hashCadena(categoria);
+
+    bosquejos->filas++;
+    agregarHyperLogLog(&bosquejos->ids_venta, mezclar64((uint64_t)(uint32_t)venta_id));
+    agregarHyperLogLog(&bosquejos->ids_producto, hash_producto);
+    agregarConteoMinimo(&bosquejos->ingresos_categoria, hash_categoria, total);
+    agregarElementosFrecuentes(&bosquejos->top_categorias, hash_categoria, categoria, total);
+    agregarElementosFrecuentes(&bosquejos->top_productos, hash_producto, producto_nombre, total);
+    if (precio_unitario > 0) {
+        agregarTDigest(&bosquejos->precios, precio_unitario);
+    }
+}
+
+/*****Nombre***************************************
+ * Función combinarBosquejosVentas
+ *****Descripción**********************************
+ * Une los bosquejos de otro conjunto de ventas, de modo
+ * que el resultado resume ambos conjuntos (por ejemplo,
+ * las particiones de un análisis en varios procesos).
+ *****Retorno**************************************
+ *
+ ****Entradas**************************************
+ * @param destino: Bosquejos que reciben la unión.
+ * @param origen: Bosquejos que se agregan.
+ **************************************************/
+void combinarBosquejosVentas(bosquejosVentas *destino, bosquejosVentas *origen) {
+    destino->filas += origen->filas;
+    combinarHyperLogLog(&destino->ids_venta, &origen->ids_venta);
+    combinarHyperLogLog(&destino->ids_producto, &origen->ids_producto);
+    combinarConteoMinimo(&destino->ingresos_categoria, &origen->ingresos_categoria);
+    combinarElementosFrecuentes(&destino->top_categorias, &origen->top_categorias);
+    combinarElementosFrecuentes(&destino->top_productos, &origen->top_productos);
+    combinarTDigest(&destino->precios, &origen->precios);
+}
+
+/*****Nombre***************************************
+ * Función mostrarReporteAproximado
+ *****Descripción**********************************
+ * Imprime las respuestas aproximadas de los bosquejos.
+ *****Retorno**************************************
+ *
+ ****Entradas**************************************
+ * @param bosquejos: Un puntero al struct `bosquejosVentas`.
+ **************************************************/
+void mostrarReporteAproximado(bosquejosVentas *bosquejos) {
+    if (bosquejos == NULL || bosquejos->filas == 0) {
+        printf("No hay datos aproximados disponibles. Ejecute con --aproximado e importe datos.\n");
+        return;
+    }
+
+    printf("Resumen aproximado de %zu ventas importadas:\n", bosquejos->filas);
+    printf("  Ventas distintas (venta_id):      ~%.0f\n", estimarHyperLogLog(&bosquejos->ids_venta));
+    printf("  Productos distintos (producto_id): ~%.0f\n", estimarHyperLogLog(&bosquejos->ids_producto));
+    printf("  Precio unitario p50: ~%.2f  p90: ~%.2f  p99: ~%.2f\n",
+           cuantilTDigest(&bosquejos->precios, 0.50), cuantilTDigest(&bosquejos->precios, 0.90),
+           cuantilTDigest(&bosquejos->precios, 0.99));
+
+    elementosFrecuentes *categorias = &bosquejos->top_categorias;
+    ordenarElementosFrecuentes(categorias);
+    printf("\nTop 5 de categorías con mayores ventas (aproximado):\n");
+    for (size_t i = 0; i < categorias->num && i < 5; i++) {
+        // El Count-Min da otra cota superior; se muestra la más ajustada
+        double estimacion = estimarConteoMinimo(&bosquejos->ingresos_categoria, categorias->claves[i]);
+        if (categorias->pesos[i] < estimacion) {
+            estimacion = categorias->pesos[i];
+        }
+        printf("%zu) %-30s - Total Ventas: ~%.2f (error máx. %.2f)\n", i + 1, categorias->etiquetas[i], estimacion, categorias->errores[i]);
+    }
+
+    elementosFrecuentes *productos = &bosquejos->top_productos;
+    ordenarElementosFrecuentes(productos);
+    printf("\nTop 10 de productos con mayores ventas (aproximado):\n");
+    for (size_t i = 0; i < productos->num && i < 10; i++) {
+        printf("%2zu) %-30s - Total Ventas: ~%.2f (error máx. %.2f)\n", i + 1, productos->etiquetas[i], productos->pesos[i], productos->errores[i]);
+    }
+}
+
+#endif // BOSQUEJOS_H
@@ -0,0 +1,335 @@
+#ifndef CACHE_CONSULTAS_H
+#define CACHE_CONSULTAS_H
+
+/*****Datos administrativos************************
+ * Nombre del archivo: cache consultas
+ * Tipo de archivo: C Encabezado
+ * Proyecto: Sistema de Análisis de Datos de Ventas
+ *****Descripción**********************************
+ * Caché de resultados de los análisis del menú. Cada
+ * resultado se guarda con la consulta, sus parámetros y
+ * la generación de la lista con la que se calculó; si la
+ * lista cambió desde entonces (importación, eliminación
+ * de duplicados o completado de datos), el resultado se
+ * descarta y se vuelve a calcular.
+ **************************************************/
+
+#include <stdlib.h>
+#include <string.h>
+#include "ventas.h"
+#include "productos.h"
+
+#define MAX_ENTRADAS_CACHE 32
+
+/*****Nombre****************************************
+ * enum TipoConsulta
+ *****Descripción***********************************
+ * Análisis cuyos resultados se guardan en la caché.
+ ***************************************************/
+typedef enum {
+    CONSULTA_TOTAL,
+    CONSULTA_MENSUAL,
+    CONSULTA_ANUAL,
+    CONSULTA_MES_MAYOR,
+    CONSULTA_DIA_ACTIVO,
+    CONSULTA_TASA_CRECIMIENTO
+} TipoConsulta;
+
+/*****Nombre****************************************
+ * struct EntradaCache
+ *****Descripción***********************************
+ * Resultado guardado de una consulta.
+ *****Campos****************************************
+ * @tipo: Consulta que produjo el resultado.
+ * @param1: Primer parámetro (trimestre), o 0.
+ * @param2: Segundo parámetro (año), o 0.
+ * @generacion: Generación de la lista al calcular el resultado.
+ * @uso: Marca del último acceso, para reemplazar la entrada más antigua.
+ * @importe: Resultado en dinero (total de ventas, o del trimestre pedido).
+ * @anterior: Total del trimestre anterior, para la tasa de crecimiento.
+ * @texto: Resultado de texto, o NULL.
+ * @etiquetas: Etiquetas de un resultado por grupos (meses o años), o NULL.
+ * @totales: Totales de cada grupo, o NULL.
+ * @num: Cantidad de grupos.
+ ***************************************************/
+typedef struct {
+    TipoConsulta tipo;
+    int param1;
+    int param2;
+    unsigned long generacion;
+    unsigned long uso;
+    dinero importe;
+    dinero anterior;
+    char *texto;
+    char **etiquetas;
+    dinero *totales;
+    size_t num;
+} EntradaCache;
+
+/*****Nombre****************************************
+ * struct cacheConsultas
+ *****Descripción***********************************
+ * Conjunto acotado de resultados guardados.
+ *****Campos****************************************
+ * @entradas: Resultados guardados.
+ * @num_entradas: Cantidad de entradas ocupadas.
+ * @reloj: Contador de accesos.
+ * @aciertos: Consultas respondidas desde la caché.
+ * @fallos: Consultas que tuvieron que recalcularse.
+ * @productos: Índice de productos, reconstruido cuando cambia la lista.
+ ***************************************************/
+typedef struct {
+    EntradaCache entradas[MAX_ENTRADAS_CACHE];
+    size_t num_entradas;
+    unsigned long reloj;
+    unsigned long aciertos;
+    unsigned long fallos;
+    indiceProductos *productos;
+} cacheConsultas;
+
+cacheConsultas* crearCacheConsultas() {
+    cacheConsultas *cache = (cacheConsultas *)callocContado(1, sizeof(cacheConsultas));
+    if (cache == NULL) {
+        printf("Error al asignar memoria para la caché de consultas.\n");
+    }
+    return cache;
+}
+
+void liberarEntradaCache(EntradaCache *entrada) {
+    free(entrada->texto);
+    for (size_t i = 0; i < entrada->num; i++) {
+        free(entrada->etiquetas[i]);
+    }
+    free(entrada->etiquetas);
+    free(entrada->totales);
+    memset(entrada, 0, sizeof(EntradaCache));
+}
+
+void liberarCacheConsultas(cacheConsultas *cache) {
+    if (cache != NULL) {
+        for (size_t i = 0; i < cache->num_entradas; i++) {
+            liberarEntradaCache(&cache->entradas[i]);
+        }
+        liberarIndiceProductos(cache->productos);
+        free(cache);
+    }
+}
+
+/*****Nombre***************************************
+ * Función buscarEntradaCache
+ *****Descripción**********************************
+ * Busca el resultado vigente de una consulta. Si no
+ * existe o quedó obsoleto, prepara una entrada vacía
+ * (reutilizando la obsoleta o reemplazando la de uso
+ * más antiguo) y la marca para ser llenada.
+ *****Retorno**************************************
+ * @return: La entrada de la consulta.
+ ****Entradas**************************************
+ * @param cache: Un puntero al struct `cacheConsultas`.
+ * @param lista: Lista sobre la que se hace la consulta.
+ * @param tipo: Consulta solicitada.
+ * @param param1: Primer parámetro de la consulta.
+ * @param param2: Segundo parámetro de la consulta.
+ * @param vigente: Recibe 1 si la entrada ya tiene el resultado.
+ **************************************************/
+EntradaCache* buscarEntradaCache(cacheConsultas *cache, listaVentas *lista, TipoConsulta tipo, int param1, int param2, int *vigente) {
+    EntradaCache *entrada = NULL;
+    cache->reloj++;
+
+    for (size_t i = 0; i < cache->num_entradas; i++) {
+        EntradaCache *actual = &cache->entradas[i];
+        if (actual->tipo == tipo && actual->param1 == param1 && actual->param2 == param2) {
+            entrada = actual;
+            break;
+        }
+    }
+
+    if (entrada != NULL && entrada->generacion == lista->generacion) {
+        entrada->uso = cache->reloj;
+        cache->aciertos++;
+        *vigente = 1;
+        return entrada;
+    }
+
+    if (entrada == NULL) {
+        if (cache->num_entradas < MAX_ENTRADAS_CACHE) {
+            entrada = &cache->entradas[cache->num_entradas++];
+        } else {
+            entrada = &cache->entradas[0];
+            for (size_t i = 1; i < cache->num_entradas; i++) {
+                if (cache->entradas[i].uso < entrada->uso) {
+                    entrada = &cache->entradas[i];
+                }
+            }
+        }
+    }
+
+    liberarEntradaCache(entrada);
+    entrada->tipo = tipo;
+    entrada->param1 = param1;
+    entrada->param2 = param2;
+    entrada->generacion = lista->generacion;
+    entrada->uso = cache->reloj;
+    cache->fallos++;
+    *vigente = 0;
+    return entrada;
+}
+
+/*****Nombre***************************************
+ * Función cacheTotalVentas
+ *****Descripción**********************************
+ * Versión con caché de `totalVentas`.
+ *****Retorno**************************************
+ * @return: El total de ventas.
+ ****Entradas**************************************
+ * @param cache: Un puntero al struct `cacheConsultas`.
+ * @param lista: Un puntero al struct `listaVentas`.
+ **************************************************/
+dinero cacheTotalVentas(cacheConsultas *cache, listaVentas *lista) {
+    int vigente;
+    EntradaCache *entrada = buscarEntradaCache(cache, lista, CONSULTA_TOTAL, 0, 0, &vigente);
+    if (!vigente) {
+        entrada->importe = totalVentas(lista);
+    }
+    return entrada->importe;
+}
+
+/*****Nombre***************************************
+ * Función cacheTotalVentasMensuales
+ *****Descripción**********************************
+ * Versión con caché de `totalVentasMensuales`. Los
+ * arreglos devueltos pertenecen a la caché: el llamador
+ * no debe liberarlos y dejan de ser válidos en la
+ * siguiente consulta a la caché.
+ *****Retorno**************************************
+ *
+ ****Entradas**************************************
+ * @param cache: Un puntero al struct `cacheConsultas`.
+ * @param lista: Un puntero al struct `listaVentas`.
+ * @param meses_totales: Recibe los nombres de los meses.
+ * @param totales_mensuales: Recibe los totales por mes.
+ * @param num_meses: Recibe la cantidad de meses.
+ **************************************************/
+void cacheTotalVentasMensuales(cacheConsultas *cache, listaVentas *lista, char ***meses_totales, dinero **totales_mensuales, size_t *num_meses) {
+    int vigente;
+    EntradaCache *entrada = buscarEntradaCache(cache, lista, CONSULTA_MENSUAL, 0, 0, &vigente);
+    if (!vigente) {
+        totalVentasMensuales(lista, &entrada->etiquetas, &entrada->totales, &entrada->num);
+    }
+    *meses_totales = entrada->etiquetas;
+    *totales_mensuales = entrada->totales;
+    *num_meses = entrada->num;
+}
+
+/*****Nombre***************************************
+ * Función cacheTotalVentasAnuales
+ *****Descripción**********************************
+ * Versión con caché de `totalVentasAnuales`. Los
+ * arreglos devueltos pertenecen a la caché.
+ *****Retorno**************************************
+ *
+ ****Entradas**************************************
+ * @param cache: Un puntero al struct `cacheConsultas`.
+ * @param lista: Un puntero al struct `listaVentas`.
+ * @param años_totales: Recibe los años.
+ * @param totales_anuales: Recibe los totales por año.
+ * @param num_años: Recibe la cantidad de años.
+ **************************************************/
+void cacheTotalVentasAnuales(cacheConsultas *cache, listaVentas *lista, char ***años_totales, dinero **totales_anuales, size_t *num_años) {
+    int vigente;
+    EntradaCache *entrada = buscarEntradaCache(cache, lista, CONSULTA_ANUAL, 0, 0, &vigente);
+    if (!vigente) {
+        totalVentasAnuales(lista, &entrada->etiquetas, &entrada->totales, &entrada->num);
+    }
+    *años_totales = entrada->etiquetas;
+    *totales_anuales = entrada->totales;
+    *num_años = entrada->num;
+}
+
+/*****Nombre***************************************
+ * Función cacheMesConMayorVenta
+ *****Descripción**********************************
+ * Versión con caché de `mesConMayorVenta`.
+ *****Retorno**************************************
+ * @return: Texto con el mes de mayor venta (propiedad de la caché).
+ ****Entradas**************************************
+ * @param cache: Un puntero al struct `cacheConsultas`.
+ * @param lista: Un puntero al struct `listaVentas`.
+ **************************************************/
+const char* cacheMesConMayorVenta(cacheConsultas *cache, listaVentas *lista) {
+    int vigente;
+    EntradaCache *entrada = buscarEntradaCache(cache, lista, CONSULTA_MES_MAYOR, 0, 0, &vigente);
+    if (!vigente) {
+        entrada->texto = strdupContado(mesConMayorVenta(lista));
+    }
+    return entrada->texto;
+}
+
+/*****Nombre***************************************
+ * Función cacheDiaMasActivo
+ *****Descripción**********************************
+ * Versión con caché de `diaMasActivo`.
+ *****Retorno**************************************
+ * @return: Texto con el día más activo (propiedad de la caché).
+ ****Entradas**************************************
+ * @param cache: Un puntero al struct `cacheConsultas`.
+ * @param lista: Un puntero al struct `listaVentas`.
+ **************************************************/
+const char* cacheDiaMasActivo(cacheConsultas *cache, listaVentas *lista) {
+    int vigente;
+    EntradaCache *entrada = buscarEntradaCache(cache, lista, CONSULTA_DIA_ACTIVO, 0, 0, &vigente);
+    if (!vigente) {
+        entrada->texto = strdupContado(diaMasActivo(lista));
+    }
+    return entrada->texto;
+}
+
+/*****Nombre***************************************
+ * Función cacheTasaCrecimientoTrimestral
+ *****Descripción**********************************
+ * Versión con caché de `tasaCrecimientoTrimestral`,
+ * con el trimestre y el año como parte de la clave.
+ *****Retorno**************************************
+ * @return: La tasa de crecimiento en porcentaje.
+ ****Entradas**************************************
+ * @param cache: Un puntero al struct `cacheConsultas`.
+ * @param lista: Un puntero al struct `listaVentas`.
+ * @param trimestre: Trimestre a analizar (1-4).
+ * @param anio: Año del trimestre.
+ **************************************************/
+float cacheTasaCrecimientoTrimestral(cacheConsultas *cache, listaVentas *lista, int trimestre, int anio) {
+    int vigente;
+    EntradaCache *entrada = buscarEntradaCache(cache, lista, CONSULTA_TASA_CRECIMIENTO, trimestre, anio, &vigente);
+    if (!vigente) {
+        sumarTrimestres(lista, trimestre, anio, &entrada->importe, &entrada->anterior);
+    }
+    // Se guardan los totales y no la tasa, para repetir los mismos mensajes en un acierto
+    return informarTasaCrecimiento(trimestre, anio, entrada->importe, entrada->anterior);
+}
+
+/*****Nombre***************************************
+ * Función cacheIndiceProductos
+ *****Descripción**********************************
+ * Devuelve el índice de productos de la lista, 
+ * reconstruyéndolo solo si la lista cambió desde la
+ * última construcción.
+ *****Retorno**************************************
+ * @return: El índice de productos (propiedad de la caché),
+ *          o `NULL` si no se pudo construir.
+ ****Entradas**************************************
+ * @param cache: Un puntero al struct `cacheConsultas`.
+ * @param lista: Un puntero al struct `listaVentas`.
+ **************************************************/
+indiceProductos* cacheIndiceProductos(cacheConsultas *cache, listaVentas *lista) {
+    if (cache->productos != NULL && cache->productos->generacion == lista->generacion) {
+        cache->aciertos++;
+        return cache->productos;
+    }
+
+    liberarIndiceProductos(cache->productos);
+    cache->productos = construirIndiceProductos(lista);
+    cache->fallos++;
+    return cache->productos;
+}
+
+#endif // CACHE_CONSULTAS_H
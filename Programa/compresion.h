@@ -0,0 +1,530 @@
+#ifndef COMPRESION_H
+#define COMPRESION_H
+
+/*****Datos administrativos************************
+ * Nombre del archivo: compresion
+ * Tipo de archivo: C Encabezado
+ * Proyecto: Sistema de Análisis de Datos de Ventas
+ *****Descripción**********************************
+ * Lectura y escritura de archivos con compresión
+ * transparente por flujo. Al abrir un archivo para
+ * lectura se detecta el formato por sus primeros bytes
+ * (gzip o zstd) y los datos se descomprimen bloque a
+ * bloque a medida que se piden, sin generar el archivo
+ * descomprimido completo ni en disco ni en memoria.
+ * La escritura puede comprimir con el mismo esquema.
+ *
+ * gzip usa zlib y se incluye por defecto (enlazar con
+ * -lz; se desactiva definiendo VENTAS_SIN_GZIP). zstd
+ * requiere definir VENTAS_ZSTD y enlazar con -lzstd.
+ **************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifndef VENTAS_SIN_GZIP
+#include <zlib.h>
+#endif
+#ifdef VENTAS_ZSTD
+#include <zstd.h>
+#endif
+#include "metricas.h"
+
+#define BLOQUE_COMPRESION (128 * 1024)
+
+/*****Nombre****************************************
+ * enum TipoCompresion
+ *****Descripción***********************************
+ * Formatos de compresión reconocidos.
+ ***************************************************/
+typedef enum {
+    COMPRESION_NINGUNA,
+    COMPRESION_GZIP,
+    COMPRESION_ZSTD
+} TipoCompresion;
+
+// Compresión elegida para los archivos que escribe el programa (ver configurarCompresionSalida)
+static TipoCompresion compresion_salida = COMPRESION_NINGUNA;
+
+/*****Nombre****************************************
+ * struct lectorArchivo
+ *****Descripción***********************************
+ * Archivo abierto para lectura, con o sin compresión.
+ *****Campos****************************************
+ * @archivo: Archivo subyacente.
+ * @tipo: Formato detectado.
+ * @entrada: Bloque de datos comprimidos leídos del archivo.
+ * @disponibles: Bytes de `entrada` aún sin descomprimir.
+ * @posicion: Primer byte pendiente en `entrada`.
+ * @fin_archivo: 1 cuando ya no quedan bytes por leer del archivo.
+ * @error: 1 si los datos comprimidos están dañados.
+ * @bytes_archivo: Bytes leídos del archivo (comprimidos).
+ * @fin_cuadro: 1 si el último flujo comprimido se cerró completo.
+ ***************************************************/
+typedef struct {
+    FILE *archivo;
+    TipoCompresion tipo;
+    unsigned char *entrada;
+    size_t disponibles;
+    size_t posicion;
+    int fin_archivo;
+    int error;
+    size_t bytes_archivo;
+    int fin_cuadro;
+#ifndef VENTAS_SIN_GZIP
+    z_stream gzip;
+#endif
+#ifdef VENTAS_ZSTD
+    ZSTD_DStream *zstd;
+#endif
+} lectorArchivo;
+
+/*****Nombre***************************************
+ * Función detectarCompresion
+ *****Descripción**********************************
+ * Reconoce el formato por los números mágicos:
+ * 1F 8B para gzip y 28 B5 2F FD para zstd.
+ *****Retorno**************************************
+ * @return: El formato detectado.
+ ****Entradas**************************************
+ * @param cabecera: Primeros bytes del archivo.
+ * @param largo: Cantidad de bytes disponibles.
+ **************************************************/
+TipoCompresion detectarCompresion(const unsigned char *cabecera, size_t largo) {
+    if (largo >= 2 && cabecera[0] == 0x1F && cabecera[1] == 0x8B) {
+        return COMPRESION_GZIP;
+    }
+    if (largo >= 4 && cabecera[0] == 0x28 && cabecera[1] == 0xB5 && cabecera[2] == 0x2F && cabecera[3] == 0xFD) {
+        return COMPRESION_ZSTD;
+    }
+    return COMPRESION_NINGUNA;
+}
+
+const char* nombreCompresion(TipoCompresion tipo) {
+    switch (tipo) {
+        case COMPRESION_GZIP: return "gzip";
+        case COMPRESION_ZSTD: return "zstd";
+        default: return "ninguna";
+    }
+}
+
+// Rellena el bloque de entrada si ya se consumió
+void recargarEntrada(lectorArchivo *lector) {
+    if (lector->disponibles == 0 && !lector->fin_archivo) {
+        lector->disponibles = fread(lector->entrada, 1, BLOQUE_COMPRESION, lector->archivo);
+        lector->posicion = 0;
+        lector->bytes_archivo += lector->disponibles;
+        if (lector->disponibles == 0) {
+            lector->fin_archivo = 1;
+        }
+    }
+}
+
+void cerrarLector(lectorArchivo *lector) {
+    if (lector == NULL) {
+        return;
+    }
+#ifndef VENTAS_SIN_GZIP
+    if (lector->tipo == COMPRESION_GZIP) {
+        inflateEnd(&lector->gzip);
+    }
+#endif
+#ifdef VENTAS_ZSTD
+    if (lector->zstd != NULL) {
+        ZSTD_freeDStream(lector->zstd);
+    }
+#endif
+    if (lector->archivo != NULL) {
+        fclose(lector->archivo);
+    }
+    free(lector->entrada);
+    free(lector);
+}
+
+/*****Nombre***************************************
+ * Función abrirLector
+ *****Descripción**********************************
+ * Abre un archivo para lectura y detecta si está
+ * comprimido.
+ *****Retorno**************************************
+ * @return: El lector, o NULL si el archivo no existe, falta
+ *          memoria o el formato no está soportado en esta
+ *          compilación (en ese caso se informa el motivo).
+ ****Entradas**************************************
+ * @param path: Ruta del archivo.
+ **************************************************/
+lectorArchivo* abrirLector(const char *path) {
+    FILE *archivo = fopen(path, "rb");
+    if (archivo == NULL) {
+        return NULL;
+    }
+
+    lectorArchivo *lector = (lectorArchivo *)callocContado(1, sizeof(lectorArchivo));
+    unsigned char *entrada = (unsigned char *)mallocContado(BLOQUE_COMPRESION);
+    if (lector == NULL || entrada == NULL) {
+        free(lector);
+        free(entrada);
+        fclose(archivo);
+        return NULL;
+    }
+    lector->archivo = archivo;
+    lector->entrada = entrada;
+
+    recargarEntrada(lector);
+    lector->tipo = detectarCompresion(lector->entrada, lector->disponibles);
+
+    if (lector->tipo == COMPRESION_GZIP) {
+#ifndef VENTAS_SIN_GZIP
+        // 15 + 32: ventana máxima y detección automática de cabecera gzip o zlib
+        if (inflateInit2(&lector->gzip, 15 + 32) != Z_OK) {
+            lector->tipo = COMPRESION_NINGUNA;
+            cerrarLector(lector);
+            return NULL;
+        }
+#else
+        printf("El archivo %s está comprimido con gzip, pero esta compilación no incluye soporte gzip.\n", path);
+        cerrarLector(lector);
+        return NULL;
+#endif
+    } else if (lector->tipo == COMPRESION_ZSTD) {
+#ifdef VENTAS_ZSTD
+        lector->zstd = ZSTD_createDStream();
+        if (lector->zstd == NULL) {
+            cerrarLector(lector);
+            return NULL;
+        }
+        ZSTD_initDStream(lector->zstd);
+#else
+        printf("El archivo %s está comprimido con zstd; compile con -DVENTAS_ZSTD -lzstd para leerlo.\n", path);
+        cerrarLector(lector);
+        return NULL;
+#endif
+    }
+    return lector;
+}
+
+/*****Nombre***************************************
+ * Función leerLector
+ *****Descripción**********************************
+ * Lee hasta `capacidad` bytes descomprimidos.
+ *****Retorno**************************************
+ * @return: Bytes copiados en `destino`; 0 al final del
+ *          archivo o ante un error (ver `lector->error`).
+ ****Entradas**************************************
+ * @param lector: Lector abierto.
+ * @param destino: Buffer de salida.
+ * @param capacidad: Tamaño del buffer de salida.
+ **************************************************/
+size_t leerLector(lectorArchivo *lector, void *destino, size_t capacidad) {
+    if (lector->error || capacidad == 0) {
+        return 0;
+    }
+
+    if (lector->tipo == COMPRESION_NINGUNA) {
+        // El primer bloque ya se leyó para detectar el formato
+        size_t copiados = 0;
+        if (lector->disponibles > 0) {
+            copiados = lector->disponibles < capacidad ? lector->disponibles : capacidad;
+            memcpy(destino, lector->entrada + lector->posicion, copiados);
+            lector->posicion += copiados;
+            lector->disponibles -= copiados;
+        }
+        if (copiados < capacidad && !lector->fin_archivo) {
+            size_t leidos = fread((char *)destino + copiados, 1, capacidad - copiados, lector->archivo);
+            lector->bytes_archivo += leidos;
+            copiados += leidos;
+            if (leidos == 0) {
+                lector->fin_archivo = 1;
+            }
+        }
+        return copiados;
+    }
+
+#ifndef VENTAS_SIN_GZIP
+    if (lector->tipo == COMPRESION_GZIP) {
+        z_stream *z = &lector->gzip;
+        z->next_out = (Bytef *)destino;
+        z->avail_out = (uInt)capacidad;
+        while (z->avail_out > 0) {
+            recargarEntrada(lector);
+            if (lector->fin_cuadro) {
+                // Un archivo gzip puede tener varios miembros concatenados
+                if (lector->disponibles == 0) {
+                    break;
+                }
+                inflateReset(z);
+                lector->fin_cuadro = 0;
+            }
+            if (lector->disponibles == 0) {
+                // El archivo terminó antes que el flujo comprimido
+                lector->error = 1;
+                break;
+            }
+            z->next_in = lector->entrada + lector->posicion;
+            z->avail_in = (uInt)lector->disponibles;
+            int resultado = inflate(z, Z_NO_FLUSH);
+            size_t consumidos = lector->disponibles - z->avail_in;
+            lector->posicion += consumidos;
+            lector->disponibles -= consumidos;
+            if (resultado == Z_STREAM_END) {
+                lector->fin_cuadro = 1;
+            } else if (resultado != Z_OK && resultado != Z_BUF_ERROR) {
+                lector->error = 1;
+                break;
+            }
+        }
+        return capacidad - z->avail_out;
+    }
+#endif
+
+#ifdef VENTAS_ZSTD
+    if (lector->tipo == COMPRESION_ZSTD) {
+        ZSTD_outBuffer salida = { destino, capacidad, 0 };
+        while (salida.pos < salida.size) {
+            recargarEntrada(lector);
+            if (lector->disponibles == 0) {
+                // Un cuadro incompleto al final del archivo es un error
+                lector->error = !lector->fin_cuadro;
+                break;
+            }
+            ZSTD_inBuffer entrada = { lector->entrada + lector->posicion, lector->disponibles, 0 };
+            size_t pendiente = ZSTD_decompressStream(lector->zstd, &salida, &entrada);
+            lector->posicion += entrada.pos;
+            lector->disponibles -= entrada.pos;
+            if (ZSTD_isError(pendiente)) {
+                lector->error = 1;
+                break;
+            }
+            lector->fin_cuadro = (pendiente == 0);
+        }
+        return salida.pos;
+    }
+#endif
+
+    return 0;
+}
+
+/*****Nombre****************************************
+ * struct escritorArchivo
+ *****Descripción***********************************
+ * Archivo abierto para escritura, con o sin compresión.
+ *****Campos****************************************
+ * @archivo: Archivo subyacente.
+ * @tipo: Formato de salida.
+ * @salida: Bloque de datos comprimidos pendiente de escribir.
+ * @error: 1 si falló la compresión o la escritura.
+ * @bytes_escritos: Bytes escritos en el archivo.
+ ***************************************************/
+typedef struct {
+    FILE *archivo;
+    TipoCompresion tipo;
+    unsigned char *salida;
+    int error;
+    size_t bytes_escritos;
+#ifndef VENTAS_SIN_GZIP
+    z_stream gzip;
+#endif
+#ifdef VENTAS_ZSTD
+    ZSTD_CStream *zstd;
+#endif
+} escritorArchivo;
+
+/*****Nombre***************************************
+ * Función configurarCompresionSalida
+ *****Descripción**********************************
+ * Elige la compresión de los archivos que escribe el
+ * programa a partir de su nombre: "gzip", "zstd" o
+ * "ninguna".
+ *****Retorno**************************************
+ * @return: 1 si el formato es válido y está disponible, 0 si no.
+ ****Entradas**************************************
+ * @param nombre: Nombre del formato.
+ **************************************************/
+int configurarCompresionSalida(const char *nombre) {
+    if (strcmp(nombre, "ninguna") == 0) {
+        compresion_salida = COMPRESION_NINGUNA;
+    } else if (strcmp(nombre, "gzip") == 0) {
+#ifdef VENTAS_SIN_GZIP
+        fprintf(stderr, "Esta compilación no incluye soporte gzip.\n");
+        return 0;
+#endif
+        compresion_salida = COMPRESION_GZIP;
+    } else if (strcmp(nombre, "zstd") == 0) {
+#ifndef VENTAS_ZSTD
+        fprintf(stderr, "Esta compilación no incluye soporte zstd (compile con -DVENTAS_ZSTD -lzstd).\n");
+        return 0;
+#endif
+        compresion_salida = COMPRESION_ZSTD;
+    } else {
+        fprintf(stderr, "Compresión desconocida: %s.\n", nombre);
+        return 0;
+    }
+    return 1;
+}
+
+/*****Nombre***************************************
+ * Función abrirEscritor
+ *****Descripción**********************************
+ * Abre un archivo para escritura con la compresión dada.
+ *****Retorno**************************************
+ * @return: El escritor, o NULL si no se pudo abrir.
+ ****Entradas**************************************
+ * @param path: Ruta del archivo.
+ * @param tipo: Formato de salida.
+ **************************************************/
+escritorArchivo* abrirEscritor(const char *path, TipoCompresion tipo) {
+    escritorArchivo *escritor = (escritorArchivo *)callocContado(1, sizeof(escritorArchivo));
+    if (escritor == NULL) {
+        return NULL;
+    }
+    escritor->tipo = tipo;
+    if (tipo != COMPRESION_NINGUNA) {
+        escritor->salida = (unsigned char *)mallocContado(BLOQUE_COMPRESION);
+        if (escritor->salida == NULL) {
+            free(escritor);
+            return NULL;
+        }
+    }
+
+    int iniciado = (tipo == COMPRESION_NINGUNA);
+#ifndef VENTAS_SIN_GZIP
+    // 15 + 16: ventana máxima con cabecera gzip
+    if (tipo == COMPRESION_GZIP) {
+        iniciado = deflateInit2(&escritor->gzip, Z_DEFAULT_COMPRESSION, Z_DEFLATED, 15 + 16, 8, Z_DEFAULT_STRATEGY) == Z_OK;
+    }
+#endif
+#ifdef VENTAS_ZSTD
+    if (tipo == COMPRESION_ZSTD) {
+        escritor->zstd = ZSTD_createCStream();
+        iniciado = escritor->zstd != NULL && !ZSTD_isError(ZSTD_initCStream(escritor->zstd, 3));
+    }
+#endif
+    if (iniciado) {
+        escritor->archivo = fopen(path, "wb");
+    }
+    if (!iniciado || escritor->archivo == NULL) {
+#ifndef VENTAS_SIN_GZIP
+        if (iniciado && tipo == COMPRESION_GZIP) {
+            deflateEnd(&escritor->gzip);
+        }
+#endif
+#ifdef VENTAS_ZSTD
+        if (escritor->zstd != NULL) {
+            ZSTD_freeCStream(escritor->zstd);
+        }
+#endif
+        free(escritor->salida);
+        free(escritor);
+        return NULL;
+    }
+    return escritor;
+}
+
+// Escribe un bloque ya comprimido en el archivo
+void volcarSalidaEscritor(escritorArchivo *escritor, size_t largo) {
+    if (largo > 0 && fwrite(escritor->salida, 1, largo, escritor->archivo) != largo) {
+        escritor->error = 1;
+    }
+    escritor->bytes_escritos += largo;
+}
+
+// Comprime (o copia) `largo` bytes; con `terminar` cierra el flujo comprimido
+void procesarEscritor(escritorArchivo *escritor, const void *datos, size_t largo, int terminar) {
+    if (escritor->error) {
+        return;
+    }
+    if (escritor->tipo == COMPRESION_NINGUNA) {
+        if (largo > 0 && fwrite(datos, 1, largo, escritor->archivo) != largo) {
+            escritor->error = 1;
+        }
+        escritor->bytes_escritos += largo;
+        return;
+    }
+
+#ifndef VENTAS_SIN_GZIP
+    if (escritor->tipo == COMPRESION_GZIP) {
+        z_stream *z = &escritor->gzip;
+        z->next_in = (Bytef *)datos;
+        z->avail_in = (uInt)largo;
+        int resultado;
+        do {
+            z->next_out = escritor->salida;
+            z->avail_out = BLOQUE_COMPRESION;
+            resultado = deflate(z, terminar ? Z_FINISH : Z_NO_FLUSH);
+            if (resultado == Z_STREAM_ERROR) {
+                escritor->error = 1;
+                return;
+            }
+            volcarSalidaEscritor(escritor, BLOQUE_COMPRESION - z->avail_out);
+        } while (z->avail_out == 0 || (terminar && resultado != Z_STREAM_END));
+        return;
+    }
+#endif
+
+#ifdef VENTAS_ZSTD
+    if (escritor->tipo == COMPRESION_ZSTD) {
+        ZSTD_inBuffer entrada = { datos, largo, 0 };
+        size_t pendiente;
+        do {
+            ZSTD_outBuffer salida = { escritor->salida, BLOQUE_COMPRESION, 0 };
+            pendiente = terminar ? ZSTD_endStream(escritor->zstd, &salida)
+                                 : ZSTD_compressStream(escritor->zstd, &salida, &entrada);
+            if (ZSTD_isError(pendiente)) {
+                escritor->error = 1;
+                return;
+            }
+            volcarSalidaEscritor(escritor, salida.pos);
+        } while (terminar ? pendiente > 0 : entrada.pos < entrada.size);
+    }
+#endif
+}
+
+void escribirEscritor(escritorArchivo *escritor, const void *datos, size_t largo) {
+    procesarEscritor(escritor, datos, largo, 0);
+}
+
+void escribirCadenaEscritor(escritorArchivo *escritor, const char *cadena) {
+    procesarEscritor(escritor, cadena, strlen(cadena), 0);
+}
+
+/*****Nombre***************************************
+ * Función cerrarEscritor
+ *****Descripción**********************************
+ * Termina el flujo comprimido y cierra el archivo.
+ *****Retorno**************************************
+ * @return: 1 si todo se escribió correctamente, 0 si no.
+ ****Entradas**************************************
+ * @param escritor: Escritor abierto.
+ * @param bytes_escritos: Recibe los bytes escritos en el archivo (puede ser NULL).
+ **************************************************/
+int cerrarEscritor(escritorArchivo *escritor, size_t *bytes_escritos) {
+    if (escritor == NULL) {
+        return 0;
+    }
+    if (escritor->tipo != COMPRESION_NINGUNA) {
+        procesarEscritor(escritor, NULL, 0, 1);
+    }
+#ifndef VENTAS_SIN_GZIP
+    if (escritor->tipo == COMPRESION_GZIP) {
+        deflateEnd(&escritor->gzip);
+    }
+#endif
+#ifdef VENTAS_ZSTD
+    if (escritor->zstd != NULL) {
+        ZSTD_freeCStream(escritor->zstd);
+    }
+#endif
+    if (bytes_escritos != NULL) {
+        *bytes_escritos = escritor->bytes_escritos;
+    }
+    int correcto = !escritor->error;
+    if (fclose(escritor->archivo) != 0) {
+        correcto = 0;
+    }
+    free(escritor->salida);
+    free(escritor);
+    return correcto;
+}
+
+#endif // COMPRESION_H
@@ -0,0 +1,634 @@
+#ifndef CONSULTAS_H
+#define CONSULTAS_H
+
+/*****Datos administrativos************************
+ * Nombre del archivo: consultas
+ * Tipo de archivo: C Encabezado
+ * Proyecto: Sistema de Análisis de Datos de Ventas
+ *****Descripción**********************************
+ * Consultas filtradas con agrupación. Una consulta se
+ * escribe como pares clave=valor separados por ';',
+ * por ejemplo:
+ *   categoria=Categoría 2;anio=2023;agrupar=mes
+ * Claves: desde, hasta (AAAA, AAAA-MM o AAAA-MM-DD),
+ * anio, categoria, producto (id o nombre), precio_min,
+ * precio_max, cantidad_min, cantidad_max y agrupar
+ * (ninguno, categoria, producto, mes o anio).
+ * La ejecución salta los bloques cuyo mapa de zonas
+ * (ventas.h) no puede cumplir el filtro y, dentro de cada bloque,
+ * evalúa cada predicado sobre todas las filas en un
+ * ciclo propio que actualiza una máscara de selección.
+ * Si la tabla de grupos no cabe en el presupuesto de
+ * memoria (externo.h), los grupos parciales se vuelcan
+ * a particiones en disco y se combinan al final.
+ **************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include <ctype.h>
+#include "ventas.h"
+
+// Filas evaluadas por cada máscara de selección
+#define BLOQUE_MASCARA 1024
+
+typedef enum {
+    AGRUPAR_NINGUNO,
+    AGRUPAR_CATEGORIA,
+    AGRUPAR_PRODUCTO,
+    AGRUPAR_MES,
+    AGRUPAR_ANIO
+} AgrupacionConsulta;
+
+/*****Nombre****************************************
+ * struct Consulta
+ *****Descripción***********************************
+ * Filtro y agrupación de una consulta. Los límites
+ * son inclusivos.
+ *****Campos****************************************
+ * @fecha_desde: Fecha mínima AAAAMMDD (0 sin límite).
+ * @fecha_hasta: Fecha máxima AAAAMMDD (INT_MAX sin límite).
+ * @filtra_categoria: 1 si se filtra por categoría.
+ * @categoria: Código de la categoría.
+ * @filtra_producto: 1 si se filtra por id de producto.
+ * @producto_id: Id del producto.
+ * @filtra_nombre: 1 si se filtra por nombre de producto.
+ * @producto_nombre: Código del nombre del producto.
+ * @precio_min: Precio unitario mínimo.
+ * @precio_max: Precio unitario máximo.
+ * @cantidad_min: Cantidad mínima.
+ * @cantidad_max: Cantidad máxima.
+ * @agrupar: Criterio de agrupación.
+ * @sin_resultados: 1 si el filtro nombra una categoría o
+ *                  producto que no existe en la lista.
+ ***************************************************/
+typedef struct {
+    int fecha_desde;
+    int fecha_hasta;
+    int filtra_categoria;
+    codigoCadena categoria;
+    int filtra_producto;
+    int producto_id;
+    int filtra_nombre;
+    codigoCadena producto_nombre;
+    dinero precio_min;
+    dinero precio_max;
+    int cantidad_min;
+    int cantidad_max;
+    AgrupacionConsulta agrupar;
+    int sin_resultados;
+} Consulta;
+
+/*****Nombre****************************************
+ * struct GrupoConsulta
+ *****Descripción***********************************
+ * Agregados de un grupo del resultado.
+ *****Campos****************************************
+ * @clave: Valor del criterio de agrupación.
+ * @ventas: Cantidad de ventas.
+ * @unidades: Unidades vendidas.
+ * @importe: Importe total.
+ * @ejemplo: Posición de una venta del grupo (para su nombre).
+ ***************************************************/
+typedef struct {
+    long long clave;
+    size_t ventas;
+    long unidades;
+    dinero importe;
+    size_t ejemplo;
+} GrupoConsulta;
+
+/*****Nombre****************************************
+ * struct ResultadoConsulta
+ *****Descripción***********************************
+ * Grupos de una consulta, con una tabla hash de
+ * direccionamiento abierto por clave.
+ *****Campos****************************************
+ * @grupos: Grupos encontrados.
+ * @num_grupos: Cantidad de grupos.
+ * @capacidad: Capacidad de `grupos`.
+ * @tabla: Índice + 1 de cada casilla, o 0 si está libre.
+ * @capacidad_tabla: Casillas de la tabla (potencia de 2).
+ * @num_zonas: Bloques del mapa de zonas.
+ * @zonas_saltadas: Bloques descartados por el mapa de zonas.
+ * @filas_revisadas: Filas evaluadas con la máscara.
+ ***************************************************/
+typedef struct {
+    GrupoConsulta *grupos;
+    size_t num_grupos;
+    size_t capacidad;
+    size_t *tabla;
+    size_t capacidad_tabla;
+    size_t num_zonas;
+    size_t zonas_saltadas;
+    size_t filas_revisadas;
+} ResultadoConsulta;
+
+void iniciarConsulta(Consulta *consulta) {
+    memset(consulta, 0, sizeof(Consulta));
+    consulta->fecha_hasta = INT_MAX;
+    consulta->precio_min = INT64_MIN;
+    consulta->precio_max = INT64_MAX;
+    consulta->cantidad_min = INT_MIN;
+    consulta->cantidad_max = INT_MAX;
+}
+
+void liberarResultadoConsulta(ResultadoConsulta *resultado) {
+    free(resultado->grupos);
+    free(resultado->tabla);
+    memset(resultado, 0, sizeof(ResultadoConsulta));
+}
+
+// Lee una fecha AAAA, AAAA-MM o AAAA-MM-DD; los componentes ausentes se completan
+// al inicio (`al_final` = 0) o al final (`al_final` = 1) del período. Devuelve 0 si no es válida
+int fechaDeConsulta(const char *texto, int al_final) {
+    int anio, mes = al_final ? 12 : 1, dia = al_final ? 31 : 1;
+    int leidos = 0;
+    int campos = sscanf(texto, "%4d%n-%2d%n-%2d%n", &anio, &leidos, &mes, &leidos, &dia, &leidos);
+    if (campos < 1 || texto[leidos] != '\0' || mes < 1 || mes > 12 || dia < 1 || dia > 31) {
+        return 0;
+    }
+    return anio * 10000 + mes * 100 + dia;
+}
+
+// Lee un entero sin texto sobrante; devuelve 0 si no es válido
+int enteroDeConsulta(const char *texto, long *valor) {
+    char *fin;
+    *valor = strtol(texto, &fin, 10);
+    return fin != texto && *fin == '\0';
+}
+
+/*****Nombre***************************************
+ * Función analizarConsulta
+ *****Descripción**********************************
+ * Interpreta el texto de una consulta. Las categorías
+ * y los nombres de producto se buscan en los
+ * diccionarios de la lista.
+ *****Retorno**************************************
+ * @return: 1 si la consulta es válida, 0 si no (se
+ *          imprime el motivo).
+ ****Entradas**************************************
+ * @param lista: Un puntero al struct `listaVentas`.
+ * @param texto: Texto de la consulta.
+ * @param consulta: Recibe la consulta interpretada.
+ **************************************************/
+int analizarConsulta(listaVentas *lista, const char *texto, Consulta *consulta) {
+    iniciarConsulta(consulta);
+    char *copia = strdupContado(texto);
+    if (copia == NULL) {
+        printf("Error al asignar memoria para la consulta.\n");
+        return 0;
+    }
+
+    int valida = 1;
+    char *resto = copia;
+    char *par;
+    while (valida && (par = strsep(&resto, ";")) != NULL) {
+        while (isspace((unsigned char)*par)) par++;
+        if (*par == '\0') {
+            continue;
+        }
+        char *valor = strchr(par, '=');
+        if (valor == NULL) {
+            printf("Consulta inválida: falta '=' en \"%s\".\n", par);
+            valida = 0;
+            break;
+        }
+        *valor++ = '\0';
+        char *fin_clave = valor - 2;
+        while (fin_clave >= par && isspace((unsigned char)*fin_clave)) *fin_clave-- = '\0';
+        while (isspace((unsigned char)*valor)) valor++;
+        char *fin_valor = valor + strlen(valor);
+        while (fin_valor > valor && isspace((unsigned char)fin_valor[-1])) *--fin_valor = '\0';
+
+        long numero;
+        if (strcmp(par, "desde") == 0 || strcmp(par, "hasta") == 0 || strcmp(par, "anio") == 0) {
+            int es_anio = (strcmp(par, "anio") == 0);
+            if (es_anio && strlen(valor) != 4) {
+                valida = 0;
+            }
+            int desde = fechaDeConsulta(valor, 0);
+            int hasta = fechaDeConsulta(valor, 1);
+            if (!valida || desde == 0) {
+                printf("Consulta inválida: fecha \"%s\" en %s.\n", valor, par);
+                valida = 0;
+                break;
+            }
+            if (par[0] != 'h') consulta->fecha_desde = desde;
+            if (par[0] != 'd') consulta->fecha_hasta = hasta;
+        } else if (strcmp(par, "categoria") == 0) {
+            consulta->filtra_categoria = 1;
+            consulta->categoria = buscarCadena(&lista->categorias, valor);
+            consulta->sin_resultados |= (consulta->categoria == CODIGO_INVALIDO);
+        } else if (strcmp(par, "producto") == 0) {
+            if (enteroDeConsulta(valor, &numero)) {
+                consulta->filtra_producto = 1;
+                consulta->producto_id = (int)numero;
+            } else {
+                consulta->filtra_nombre = 1;
+                consulta->producto_nombre = buscarCadena(&lista->productos, valor);
+                consulta->sin_resultados |= (consulta->producto_nombre == CODIGO_INVALIDO);
+            }
+        } else if (strcmp(par, "precio_min") == 0 || strcmp(par, "precio_max") == 0) {
+            char *fin;
+            double precio = strtod(valor, &fin);
+            if (fin == valor || *fin != '\0') {
+                printf("Consulta inválida: precio \"%s\".\n", valor);
+                valida = 0;
+                break;
+            }
+            if (par[7] == 'm' && par[8] == 'i') consulta->precio_min = dineroDesdeDouble(precio);
+            else consulta->precio_max = dineroDesdeDouble(precio);
+        } else if (strcmp(par, "cantidad_min") == 0 || strcmp(par, "cantidad_max") == 0) {
+            if (!enteroDeConsulta(valor, &numero)) {
+                printf("Consulta inválida: cantidad \"%s\".\n", valor);
+                valida = 0;
+                break;
+            }
+            if (par[10] == 'i') consulta->cantidad_min = (int)numero;
+            else consulta->cantidad_max = (int)numero;
+        } else if (strcmp(par, "agrupar") == 0) {
+            if (strcmp(valor, "ninguno") == 0) consulta->agrupar = AGRUPAR_NINGUNO;
+            else if (strcmp(valor, "categoria") == 0) consulta->agrupar = AGRUPAR_CATEGORIA;
+            else if (strcmp(valor, "producto") == 0) consulta->agrupar = AGRUPAR_PRODUCTO;
+            else if (strcmp(valor, "mes") == 0) consulta->agrupar = AGRUPAR_MES;
+            else if (strcmp(valor, "anio") == 0) consulta->agrupar = AGRUPAR_ANIO;
+            else {
+                printf("Consulta inválida: agrupación \"%s\".\n", valor);
+                valida = 0;
+            }
+        } else {
+            printf("Consulta inválida: clave desconocida \"%s\".\n", par);
+            valida = 0;
+        }
+    }
+
+    free(copia);
+    return valida;
+}
+
+// 1 si alguna venta de la zona podría cumplir los filtros de rango de la consulta
+int zonaPuedeCumplir(const zonaVentas *zona, const Consulta *consulta) {
+    return zona->fecha_max >= consulta->fecha_desde && zona->fecha_min <= consulta->fecha_hasta &&
+           zona->precio_max >= consulta->precio_min && zona->precio_min <= consulta->precio_max &&
+           zona->cantidad_max >= consulta->cantidad_min && zona->cantidad_min <= consulta->cantidad_max &&
+           (!consulta->filtra_categoria || (zona->categorias & BIT_CATEGORIA(consulta->categoria)));
+}
+
+// Marca en `mascara` las ventas de [0, n) que cumplen el filtro; cada predicado activo es un ciclo aparte
+void evaluarMascara(const Venta *ventas, size_t n, const Consulta *consulta, unsigned char *mascara) {
+    memset(mascara, 1, n);
+    if (consulta->fecha_desde > 0) {
+        for (size_t j = 0; j < n; j++) mascara[j] &= (ventas[j].fecha >= consulta->fecha_desde);
+    }
+    if (consulta->fecha_hasta < INT_MAX) {
+        for (size_t j = 0; j < n; j++) mascara[j] &= (ventas[j].fecha <= consulta->fecha_hasta);
+    }
+    if (consulta->filtra_categoria) {
+        for (size_t j = 0; j < n; j++) mascara[j] &= (ventas[j].codigo_categoria == consulta->categoria);
+    }
+    if (consulta->filtra_producto) {
+        for (size_t j = 0; j < n; j++) mascara[j] &= (ventas[j].producto_id == consulta->producto_id);
+    }
+    if (consulta->filtra_nombre) {
+        for (size_t j = 0; j < n; j++) mascara[j] &= (ventas[j].codigo_producto == consulta->producto_nombre);
+    }
+    if (consulta->precio_min > INT64_MIN) {
+        for (size_t j = 0; j < n; j++) mascara[j] &= (ventas[j].precio_unitario >= consulta->precio_min);
+    }
+    if (consulta->precio_max < INT64_MAX) {
+        for (size_t j = 0; j < n; j++) mascara[j] &= (ventas[j].precio_unitario <= consulta->precio_max);
+    }
+    if (consulta->cantidad_min > INT_MIN) {
+        for (size_t j = 0; j < n; j++) mascara[j] &= (ventas[j].cantidad >= consulta->cantidad_min);
+    }
+    if (consulta->cantidad_max < INT_MAX) {
+        for (size_t j = 0; j < n; j++) mascara[j] &= (ventas[j].cantidad <= consulta->cantidad_max);
+    }
+}
+
+long long claveDeGrupo(const Venta *venta, AgrupacionConsulta agrupar) {
+    switch (agrupar) {
+        case AGRUPAR_CATEGORIA: return venta->codigo_categoria;
+        case AGRUPAR_PRODUCTO: return venta->producto_id;
+        case AGRUPAR_MES: return venta->fecha / 100;
+        case AGRUPAR_ANIO: return venta->fecha / 10000;
+        default: return 0;
+    }
+}
+
+// Devuelve el grupo de la clave, creándolo si no existe; NULL si falla la asignación
+GrupoConsulta* grupoDeClave(ResultadoConsulta *resultado, long long clave, size_t ejemplo) {
+    if ((resultado->num_grupos + 1) * 2 > resultado->capacidad_tabla) {
+        size_t nueva_capacidad = resultado->capacidad_tabla ? resultado->capacidad_tabla * 2 : 64;
+        size_t *tabla = (size_t *)callocContado(nueva_capacidad, sizeof(size_t));
+        if (tabla == NULL) {
+            return NULL;
+        }
+        for (size_t g = 0; g < resultado->num_grupos; g++) {
+            size_t casilla = mezclar64((uint64_t)resultado->grupos[g].clave) & (nueva_capacidad - 1);
+            while (tabla[casilla] != 0) casilla = (casilla + 1) & (nueva_capacidad - 1);
+            tabla[casilla] = g + 1;
+        }
+        free(resultado->tabla);
+        resultado->tabla = tabla;
+        resultado->capacidad_tabla = nueva_capacidad;
+    }
+
+    size_t mascara = resultado->capacidad_tabla - 1;
+    size_t casilla = mezclar64((uint64_t)clave) & mascara;
+    while (resultado->tabla[casilla] != 0) {
+        GrupoConsulta *grupo = &resultado->grupos[resultado->tabla[casilla] - 1];
+        if (grupo->clave == clave) {
+            return grupo;
+        }
+        casilla = (casilla + 1) & mascara;
+    }
+
+    if (resultado->num_grupos == resultado->capacidad) {
+        size_t nueva_capacidad = resultado->capacidad ? resultado->capacidad * 2 : 16;
+        GrupoConsulta *temp = (GrupoConsulta *)reallocContado(resultado->grupos, sizeof(GrupoConsulta) * nueva_capacidad);
+        if (temp == NULL) {
+            return NULL;
+        }
+        resultado->grupos = temp;
+        resultado->capacidad = nueva_capacidad;
+    }
+    GrupoConsulta *grupo = &resultado->grupos[resultado->num_grupos];
+    memset(grupo, 0, sizeof(GrupoConsulta));
+    grupo->clave = clave;
+    grupo->ejemplo = ejemplo;
+    resultado->tabla[casilla] = ++resultado->num_grupos;
+    return grupo;
+}
+
+// Grupos que puede tener la tabla dentro del presupuesto de memoria (0 sin límite). Se cuenta
+// el peor caso: arreglo de grupos al doble de lo usado y tabla hash al cuádruple.
+size_t limiteGruposConsulta() {
+    if (presupuesto_memoria == 0) {
+        return 0;
+    }
+    size_t limite = presupuesto_memoria / (2 * sizeof(GrupoConsulta) + 4 * sizeof(size_t));
+    return limite > 16 ? limite : 16;
+}
+
+// Vuelca los grupos de la tabla a su partición (bits altos del hash de la clave) y vacía la tabla
+int volcarGruposConsulta(ResultadoConsulta *resultado, particionesExternas *particiones) {
+    for (size_t g = 0; g < resultado->num_grupos; g++) {
+        size_t p = mezclar64((uint64_t)resultado->grupos[g].clave) >> 58;
+        if (!escribirEnParticion(particiones, p, &resultado->grupos[g])) {
+            return 0;
+        }
+    }
+    resultado->num_grupos = 0;
+    memset(resultado->tabla, 0, sizeof(size_t) * resultado->capacidad_tabla);
+    return 1;
+}
+
+/*****Nombre***************************************
+ * Función combinarGruposVolcados
+ *****Descripción**********************************
+ * Vuelca los grupos que quedan en la tabla y combina
+ * cada partición por separado: sus grupos parciales se
+ * suman en una tabla propia y se agregan al resultado,
+ * que queda sin tabla hash.
+ *****Retorno**************************************
+ * @return: 1 si se combinaron, 0 si falló la memoria
+ *          o un archivo temporal.
+ ****Entradas**************************************
+ * @param resultado: Resultado con los grupos en curso.
+ * @param particiones: Grupos volcados durante la consulta.
+ **************************************************/
+int combinarGruposVolcados(ResultadoConsulta *resultado, particionesExternas *particiones) {
+    if (!volcarGruposConsulta(resultado, particiones)) {
+        return 0;
+    }
+    free(resultado->tabla);
+    resultado->tabla = NULL;
+    resultado->capacidad_tabla = 0;
+
+    for (size_t p = 0; p < PARTICIONES_EXTERNAS; p++) {
+        GrupoConsulta *volcados = (GrupoConsulta *)leerParticionExterna(particiones, p);
+        if (volcados == NULL) {
+            if (particiones->error) {
+                return 0;
+            }
+            continue;
+        }
+        ResultadoConsulta parcial;
+        memset(&parcial, 0, sizeof(ResultadoConsulta));
+        int error = 0;
+        for (size_t v = 0; v < particiones->conteo[p] && !error; v++) {
+            GrupoConsulta *grupo = grupoDeClave(&parcial, volcados[v].clave, volcados[v].ejemplo);
+            if (grupo == NULL) {
+                error = 1;
+                break;
+            }
+            grupo->ventas += volcados[v].ventas;
+            grupo->unidades += volcados[v].unidades;
+            grupo->importe += volcados[v].importe;
+            if (volcados[v].ejemplo < grupo->ejemplo) {
+                grupo->ejemplo = volcados[v].ejemplo;
+            }
+        }
+        free(volcados);
+
+        if (!error && resultado->num_grupos + parcial.num_grupos > resultado->capacidad) {
+            size_t nueva_capacidad = resultado->num_grupos + parcial.num_grupos;
+            GrupoConsulta *temp = (GrupoConsulta *)reallocContado(resultado->grupos, sizeof(GrupoConsulta) * nueva_capacidad);
+            if (temp == NULL) {
+                error = 1;
+            } else {
+                resultado->grupos = temp;
+                resultado->capacidad = nueva_capacidad;
+            }
+        }
+        if (!error) {
+            memcpy(&resultado->grupos[resultado->num_grupos], parcial.grupos, sizeof(GrupoConsulta) * parcial.num_grupos);
+            resultado->num_grupos += parcial.num_grupos;
+        }
+        liberarResultadoConsulta(&parcial);
+        if (error) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+/*****Nombre***************************************
+ * Función ejecutarConsulta
+ *****Descripción**********************************
+ * Recorre la lista por zonas, salta las que el mapa de
+ * zonas descarta y agrega las ventas seleccionadas por
+ * la máscara en sus grupos. Cuando la tabla llega al
+ * límite del presupuesto de memoria, sus grupos se
+ * vuelcan a disco y se combinan al terminar.
+ *****Retorno**************************************
+ * @return: 1 si se completó, 0 si falló la asignación
+ *          de memoria.
+ ****Entradas**************************************
+ * @param lista: Un puntero al struct `listaVentas`.
+ * @param consulta: Consulta a ejecutar.
+ * @param resultado: Recibe los grupos (se libera con
+ *                   liberarResultadoConsulta).
+ **************************************************/
+int ejecutarConsulta(listaVentas *lista, const Consulta *consulta, ResultadoConsulta *resultado) {
+    memset(resultado, 0, sizeof(ResultadoConsulta));
+    if (consulta->sin_resultados) {
+        return 1;
+    }
+    if (!actualizarMapaZonas(lista)) {
+        return 0;
+    }
+
+    inicioMetrica inicio = metricaInicio();
+    unsigned char mascara[BLOQUE_MASCARA];
+    resultado->num_zonas = lista->zonas.num_zonas;
+    size_t limite_grupos = limiteGruposConsulta();
+    particionesExternas particiones;
+    iniciarParticionesExternas(&particiones, sizeof(GrupoConsulta));
+
+    for (size_t z = 0; z < lista->zonas.num_zonas; z++) {
+        if (!zonaPuedeCumplir(&lista->zonas.zonas[z], consulta)) {
+            resultado->zonas_saltadas++;
+            continue;
+        }
+        size_t fin_zona = (z + 1) * FILAS_POR_ZONA < lista->size ? (z + 1) * FILAS_POR_ZONA : lista->size;
+        for (size_t desde = z * FILAS_POR_ZONA; desde < fin_zona; desde += BLOQUE_MASCARA) {
+            size_t n = desde + BLOQUE_MASCARA < fin_zona ? BLOQUE_MASCARA : fin_zona - desde;
+            const Venta *ventas = &lista->ventas[desde];
+            evaluarMascara(ventas, n, consulta, mascara);
+            resultado->filas_revisadas += n;
+
+            for (size_t j = 0; j < n; j++) {
+                if (!mascara[j]) {
+                    continue;
+                }
+                GrupoConsulta *grupo = grupoDeClave(resultado, claveDeGrupo(&ventas[j], consulta->agrupar), desde + j);
+                if (grupo == NULL) {
+                    printf("Error al asignar memoria para el resultado de la consulta.\n");
+                    liberarParticionesExternas(&particiones);
+                    liberarResultadoConsulta(resultado);
+                    return 0;
+                }
+                grupo->ventas++;
+                grupo->unidades += ventas[j].cantidad;
+                grupo->importe += importeVenta(&ventas[j]);
+                if (limite_grupos > 0 && resultado->num_grupos >= limite_grupos && !volcarGruposConsulta(resultado, &particiones)) {
+                    liberarParticionesExternas(&particiones);
+                    liberarResultadoConsulta(resultado);
+                    return 0;
+                }
+            }
+        }
+    }
+
+    if (particiones.bytes_escritos > 0) {
+        size_t bytes_volcados = particiones.bytes_escritos;
+        int combinado = combinarGruposVolcados(resultado, &particiones);
+        liberarParticionesExternas(&particiones);
+        if (!combinado) {
+            printf("Error al combinar los grupos de la consulta volcados a disco.\n");
+            liberarResultadoConsulta(resultado);
+            return 0;
+        }
+        metricaBytesEscritos(ETAPA_CONSULTA, bytes_volcados);
+        metricaBytesLeidos(ETAPA_CONSULTA, bytes_volcados);
+    }
+
+    metricaFin(ETAPA_CONSULTA, inicio, resultado->filas_revisadas);
+    return 1;
+}
+
+int compararGruposPorClave(const void *a, const void *b) {
+    const GrupoConsulta *x = (const GrupoConsulta *)a;
+    const GrupoConsulta *y = (const GrupoConsulta *)b;
+    return (x->clave > y->clave) - (x->clave < y->clave);
+}
+
+int compararGruposPorImporte(const void *a, const void *b) {
+    const GrupoConsulta *x = (const GrupoConsulta *)a;
+    const GrupoConsulta *y = (const GrupoConsulta *)b;
+    if (x->importe != y->importe) {
+        return (x->importe < y->importe) - (x->importe > y->importe);
+    }
+    // Los empates se ordenan por clave para que el orden no dependa de cómo se armaron los grupos
+    return compararGruposPorClave(a, b);
+}
+
+// Ordena los grupos: cronológicamente los meses y años, por importe descendente los demás
+void ordenarResultadoConsulta(const Consulta *consulta, ResultadoConsulta *resultado) {
+    int cronologico = (consulta->agrupar == AGRUPAR_MES || consulta->agrupar == AGRUPAR_ANIO);
+    qsort(resultado->grupos, resultado->num_grupos, sizeof(GrupoConsulta),
+          cronologico ? compararGruposPorClave : compararGruposPorImporte);
+}
+
+// Escribe en `etiqueta` el nombre del grupo (categoría, producto, AAAA-MM o AAAA)
+void etiquetaGrupoConsulta(listaVentas *lista, const Consulta *consulta, const GrupoConsulta *grupo, char *etiqueta, size_t largo) {
+    const Venta *ejemplo = &lista->ventas[grupo->ejemplo];
+    switch (consulta->agrupar) {
+        case AGRUPAR_CATEGORIA:
+            snprintf(etiqueta, largo, "%s", nombreCategoria(lista, ejemplo));
+            break;
+        case AGRUPAR_PRODUCTO:
+            snprintf(etiqueta, largo, "%d %s", ejemplo->producto_id, nombreProducto(lista, ejemplo));
+            break;
+        case AGRUPAR_MES:
+            snprintf(etiqueta, largo, "%04lld-%02lld", grupo->clave / 100, grupo->clave % 100);
+            break;
+        case AGRUPAR_ANIO:
+            snprintf(etiqueta, largo, "%04lld", grupo->clave);
+            break;
+        default:
+            snprintf(etiqueta, largo, "Total");
+            break;
+    }
+}
+
+/*****Nombre***************************************
+ * Función mostrarResultadoConsulta
+ *****Descripción**********************************
+ * Imprime los grupos del resultado con sus ventas,
+ * unidades, importe e importe promedio por venta.
+ *****Retorno**************************************
+ *
+ ****Entradas**************************************
+ * @param lista: Un puntero al struct `listaVentas`.
+ * @param consulta: Consulta ejecutada.
+ * @param resultado: Resultado de ejecutarConsulta.
+ **************************************************/
+void mostrarResultadoConsulta(listaVentas *lista, const Consulta *consulta, ResultadoConsulta *resultado) {
+    if (resultado->num_grupos == 0) {
+        printf("Ninguna venta cumple la consulta.\n");
+        return;
+    }
+
+    ordenarResultadoConsulta(consulta, resultado);
+
+    printf("  %-36s %8s %10s %14s %12s\n", "Grupo", "Ventas", "Unidades", "Importe", "Promedio");
+    for (size_t g = 0; g < resultado->num_grupos; g++) {
+        GrupoConsulta *grupo = &resultado->grupos[g];
+        char etiqueta[64];
+        etiquetaGrupoConsulta(lista, consulta, grupo, etiqueta, sizeof(etiqueta));
+        printf("  %-36s %8zu %10ld %14.2f %12.2f\n", etiqueta, grupo->ventas, grupo->unidades,
+               dineroADouble(grupo->importe), dineroADouble(dividirDinero(grupo->importe, (int64_t)grupo->ventas)));
+    }
+    printf("\nBloques revisados: %zu de %zu (%zu filas evaluadas).\n",
+           resultado->num_zonas - resultado->zonas_saltadas, resultado->num_zonas, resultado->filas_revisadas);
+}
+
+// Interpreta, ejecuta y muestra una consulta escrita como texto
+void consultarVentas(listaVentas *lista, const char *texto) {
+    Consulta consulta;
+    if (!analizarConsulta(lista, texto, &consulta)) {
+        return;
+    }
+    ResultadoConsulta resultado;
+    if (ejecutarConsulta(lista, &consulta, &resultado)) {
+        mostrarResultadoConsulta(lista, &consulta, &resultado);
+        liberarResultadoConsulta(&resultado);
+    }
+}
+
+#endif // CONSULTAS_H
@@ -0,0 +1,227 @@
+#ifndef DIAGNOSTICOS_H
+#define DIAGNOSTICOS_H
+
+/*****Datos administrativos************************
+ * Nombre del archivo: diagnosticos
+ * Tipo de archivo: C Encabezado
+ * Proyecto: Sistema de Análisis de Datos de Ventas
+ *****Descripción**********************************
+ * Destino de diagnósticos por registro para las etapas
+ * de importación y limpieza. Cada evento se cuenta; el
+ * detalle por registro se acumula en un buffer y se
+ * escribe en bloque, opcionalmente limitado a una
+ * cantidad máxima de líneas por tipo, y puede copiarse
+ * completo a un archivo de errores. En modo silencioso
+ * solo se imprime un resumen por etapa.
+ **************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+
+#define TAMANO_BUFFER_DIAGNOSTICOS (64 * 1024)
+#define TAMANO_LINEA_DIAGNOSTICO 512
+#define DETALLE_ILIMITADO ((size_t)-1)
+
+/*****Nombre****************************************
+ * enum TipoDiagnostico
+ *****Descripción***********************************
+ * Eventos por registro reportados por las etapas.
+ ***************************************************/
+typedef enum {
+    DIAG_ATRIBUTOS_FALTANTES,
+    DIAG_ATRIBUTOS_INVALIDOS,
+    DIAG_DUPLICADO,
+    DIAG_CANTIDAD_IMPUTADA,
+    DIAG_PRECIO_IMPUTADO,
+    NUM_TIPOS_DIAGNOSTICO
+} TipoDiagnostico;
+
+/*****Nombre****************************************
+ * struct DestinoDiagnosticos
+ *****Descripción***********************************
+ * Estado del destino de diagnósticos.
+ *****Campos****************************************
+ * @silencioso: 1 si solo se imprimen resúmenes.
+ * @limite_detalle: Máximo de líneas por tipo en la salida estándar.
+ * @archivo_errores: Archivo que recibe todas las líneas, o NULL.
+ * @conteo: Eventos registrados por tipo desde el último resumen.
+ * @emitidos: Líneas impresas por tipo desde el último resumen.
+ * @buffer: Detalle pendiente de escribir en la salida estándar.
+ * @usado: Bytes ocupados en `buffer`.
+ ***************************************************/
+typedef struct {
+    int silencioso;
+    size_t limite_detalle;
+    FILE *archivo_errores;
+    size_t conteo[NUM_TIPOS_DIAGNOSTICO];
+    size_t emitidos[NUM_TIPOS_DIAGNOSTICO];
+    char buffer[TAMANO_BUFFER_DIAGNOSTICOS];
+    size_t usado;
+} DestinoDiagnosticos;
+
+static DestinoDiagnosticos diagnosticos = { .limite_detalle = DETALLE_ILIMITADO };
+
+static const char *descripcion_diagnosticos[NUM_TIPOS_DIAGNOSTICO] = {
+    [DIAG_ATRIBUTOS_FALTANTES] = "registros no importados por atributos faltantes",
+    [DIAG_ATRIBUTOS_INVALIDOS] = "registros no importados por atributos inválidos",
+    [DIAG_DUPLICADO] = "registros duplicados eliminados",
+    [DIAG_CANTIDAD_IMPUTADA] = "cantidades imputadas",
+    [DIAG_PRECIO_IMPUTADO] = "precios unitarios imputados"
+};
+
+/*****Nombre***************************************
+ * Función vaciarDiagnosticos
+ *****Descripción**********************************
+ * Escribe en la salida estándar el detalle acumulado
+ * y vacía el archivo de errores.
+ *****Retorno**************************************
+ *
+ ****Entradas**************************************
+ *
+ **************************************************/
+void vaciarDiagnosticos() {
+    if (diagnosticos.usado > 0) {
+        fwrite(diagnosticos.buffer, 1, diagnosticos.usado, stdout);
+        diagnosticos.usado = 0;
+    }
+    fflush(stdout);
+    if (diagnosticos.archivo_errores != NULL) {
+        fflush(diagnosticos.archivo_errores);
+    }
+}
+
+void cerrarDiagnosticos() {
+    vaciarDiagnosticos();
+    if (diagnosticos.archivo_errores != NULL) {
+        fclose(diagnosticos.archivo_errores);
+        diagnosticos.archivo_errores = NULL;
+    }
+}
+
+/*****Nombre***************************************
+ * Función configurarDiagnosticos
+ *****Descripción**********************************
+ * Configura el modo del destino de diagnósticos.
+ *****Retorno**************************************
+ * @return: 1 si la configuración se aplicó, 0 si no se
+ *          pudo abrir el archivo de errores.
+ ****Entradas**************************************
+ * @param silencioso: 1 para imprimir solo resúmenes.
+ * @param limite_detalle: Máximo de líneas por tipo y etapa en
+ *                        la salida estándar (DETALLE_ILIMITADO
+ *                        para no limitar).
+ * @param archivo_errores: Ruta del archivo que recibe todo el
+ *                         detalle, o NULL.
+ **************************************************/
+int configurarDiagnosticos(int silencioso, size_t limite_detalle, const char *archivo_errores) {
+    cerrarDiagnosticos();
+    diagnosticos.silencioso = silencioso;
+    diagnosticos.limite_detalle = limite_detalle;
+
+    if (archivo_errores != NULL) {
+        diagnosticos.archivo_errores = fopen(archivo_errores, "w");
+        if (diagnosticos.archivo_errores == NULL) {
+            fprintf(stderr, "Error al abrir el archivo de errores %s.\n", archivo_errores);
+            return 0;
+        }
+        setvbuf(diagnosticos.archivo_errores, NULL, _IOFBF, TAMANO_BUFFER_DIAGNOSTICOS);
+
+        static int cierre_registrado = 0;
+        if (!cierre_registrado) {
+            atexit(cerrarDiagnosticos);
+            cierre_registrado = 1;
+        }
+    }
+    return 1;
+}
+
+int diagnosticosSilenciosos() {
+    return diagnosticos.silencioso;
+}
+
+// Indica si un evento del tipo dado necesita formatear su línea de detalle
+int diagnosticoRequiereDetalle(TipoDiagnostico tipo) {
+    return diagnosticos.archivo_errores != NULL || diagnosticos.emitidos[tipo] < diagnosticos.limite_detalle;
+}
+
+/*****Nombre***************************************
+ * Función registrarDiagnostico
+ *****Descripción**********************************
+ * Cuenta un evento y, si corresponde, formatea su
+ * línea de detalle hacia el buffer de la salida
+ * estándar y/o el archivo de errores. Si el detalle
+ * no se necesita, el costo es solo el incremento del
+ * contador.
+ *****Retorno**************************************
+ *
+ ****Entradas**************************************
+ * @param tipo: Tipo de evento.
+ * @param formato: Formato printf de la línea (sin salto final).
+ **************************************************/
+void registrarDiagnostico(TipoDiagnostico tipo, const char *formato, ...) {
+    diagnosticos.conteo[tipo]++;
+    if (!diagnosticoRequiereDetalle(tipo)) {
+        return;
+    }
+
+    char linea[TAMANO_LINEA_DIAGNOSTICO];
+    va_list args;
+    va_start(args, formato);
+    int largo = vsnprintf(linea, sizeof(linea) - 1, formato, args);
+    va_end(args);
+    if (largo < 0) {
+        return;
+    }
+    if ((size_t)largo > sizeof(linea) - 2) {
+        largo = sizeof(linea) - 2;
+    }
+    linea[largo++] = '\n';
+
+    if (diagnosticos.archivo_errores != NULL) {
+        fwrite(linea, 1, largo, diagnosticos.archivo_errores);
+    }
+
+    if (diagnosticos.emitidos[tipo] < diagnosticos.limite_detalle) {
+        diagnosticos.emitidos[tipo]++;
+        if (diagnosticos.usado + largo > sizeof(diagnosticos.buffer)) {
+            vaciarDiagnosticos();
+        }
+        memcpy(diagnosticos.buffer + diagnosticos.usado, linea, largo);
+        diagnosticos.usado += largo;
+    }
+}
+
+// Suma eventos ya contados por otra vía, cuando no se necesita su detalle
+void contarDiagnosticos(TipoDiagnostico tipo, size_t cantidad) {
+    diagnosticos.conteo[tipo] += cantidad;
+}
+
+/*****Nombre***************************************
+ * Función resumirDiagnosticos
+ *****Descripción**********************************
+ * Vacía el detalle pendiente y, en modo silencioso o
+ * si hubo líneas omitidas, imprime los contadores de
+ * la etapa. Luego reinicia los contadores.
+ *****Retorno**************************************
+ *
+ ****Entradas**************************************
+ *
+ **************************************************/
+void resumirDiagnosticos() {
+    vaciarDiagnosticos();
+    for (int t = 0; t < NUM_TIPOS_DIAGNOSTICO; t++) {
+        if (diagnosticos.conteo[t] > 0 && (diagnosticos.silencioso || diagnosticos.emitidos[t] < diagnosticos.conteo[t])) {
+            printf("Resumen: %zu %s", diagnosticos.conteo[t], descripcion_diagnosticos[t]);
+            if (diagnosticos.emitidos[t] > 0) {
+                printf(" (%zu mostrados)", diagnosticos.emitidos[t]);
+            }
+            printf(".\n");
+        }
+        diagnosticos.conteo[t] = 0;
+        diagnosticos.emitidos[t] = 0;
+    }
+}
+
+#endif // DIAGNOSTICOS_H
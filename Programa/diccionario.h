@@ -0,0 +1,268 @@
+#ifndef DICCIONARIO_H
+#define DICCIONARIO_H
+
+/*****Datos administrativos************************
+ * Nombre del archivo: diccionario
+ * Tipo de archivo: C Encabezado
+ * Proyecto: Sistema de Análisis de Datos de Ventas
+ *****Descripción**********************************
+ * Diccionario de cadenas: asigna a cada cadena distinta
+ * un código entero consecutivo y guarda una sola copia
+ * de ella. Las ventas guardan el código de su producto
+ * y su categoría, de modo que los agrupamientos
+ * acumulan en un arreglo indexado por código en lugar
+ * de comparar cadenas.
+ **************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include "metricas.h"
+#include "bosquejos.h"
+
+typedef uint32_t codigoCadena;
+
+// Código que se asigna si no se pudo guardar la cadena; se muestra como cadena vacía
+#define CODIGO_INVALIDO UINT32_MAX
+
+/*****Nombre****************************************
+ * struct diccionarioCadenas
+ *****Descripción***********************************
+ * Cadenas distintas indexadas por código, con una
+ * tabla hash de direccionamiento abierto para buscar
+ * el código de una cadena.
+ *****Campos****************************************
+ * @cadenas: Copia de cada cadena, en orden de código.
+ * @hashes: Hash de cada cadena, para crecer la tabla sin recalcularlo.
+ * @num: Cantidad de cadenas.
+ * @capacidad: Capacidad de `cadenas` y `hashes`.
+ * @tabla: Código + 1 de cada casilla, o 0 si está libre.
+ * @capacidad_tabla: Casillas de la tabla (potencia de 2).
+ ***************************************************/
+typedef struct {
+    char **cadenas;
+    uint64_t *hashes;
+    size_t num;
+    size_t capacidad;
+    uint32_t *tabla;
+    size_t capacidad_tabla;
+} diccionarioCadenas;
+
+void inicializarDiccionario(diccionarioCadenas *diccionario) {
+    memset(diccionario, 0, sizeof(diccionarioCadenas));
+}
+
+void liberarDiccionario(diccionarioCadenas *diccionario) {
+    for (size_t i = 0; i < diccionario->num; i++) {
+        free(diccionario->cadenas[i]);
+    }
+    free(diccionario->cadenas);
+    free(diccionario->hashes);
+    free(diccionario->tabla);
+    inicializarDiccionario(diccionario);
+}
+
+// Duplica la tabla y reubica los códigos existentes; devuelve 0 si falla la asignación
+int crecerTablaDiccionario(diccionarioCadenas *diccionario) {
+    size_t nueva_capacidad = diccionario->capacidad_tabla ? diccionario->capacidad_tabla * 2 : 64;
+    uint32_t *tabla = (uint32_t *)callocContado(nueva_capacidad, sizeof(uint32_t));
+    if (tabla == NULL) {
+        return 0;
+    }
+    for (size_t c = 0; c < diccionario->num; c++) {
+        size_t casilla = diccionario->hashes[c] & (nueva_capacidad - 1);
+        while (tabla[casilla] != 0) casilla = (casilla + 1) & (nueva_capacidad - 1);
+        tabla[casilla] = (uint32_t)c + 1;
+    }
+    free(diccionario->tabla);
+    diccionario->tabla = tabla;
+    diccionario->capacidad_tabla = nueva_capacidad;
+    return 1;
+}
+
+// Partes de un diccionario que ampliarDiccionarioCompartido puede reemplazar
+#define PARTE_CADENAS 0x1 // Arreglos `cadenas` y `hashes`
+#define PARTE_TABLA 0x2
+
+/*****Nombre***************************************
+ * Función ampliarDiccionarioCompartido
+ *****Descripción**********************************
+ * Prepara una copia superficial de un diccionario, que
+ * comparte sus arreglos con otras copias, para agregar
+ * hasta `adicionales` cadenas sin modificar nada que
+ * esas copias lean. Las otras copias solo usan códigos
+ * menores que su `num`, así que los arreglos de cadenas
+ * se comparten mientras tengan capacidad y se copian
+ * (solo los punteros) si no; la tabla hash siempre se
+ * rehace, porque las otras copias la recorren. Después
+ * de llamarla, internarCadena no reasigna nada para las
+ * `adicionales` cadenas siguientes.
+ *****Retorno**************************************
+ * @return: 1 si se preparó, 0 si falla la asignación de
+ *          memoria (el diccionario queda sin cambios).
+ ****Entradas**************************************
+ * @param diccionario: Copia superficial a ampliar.
+ * @param adicionales: Cadenas que se van a agregar.
+ * @param reemplazadas: Recibe las partes (PARTE_*) que la
+ *                      copia dejó de compartir.
+ **************************************************/
+int ampliarDiccionarioCompartido(diccionarioCadenas *diccionario, size_t adicionales, unsigned int *reemplazadas) {
+    size_t necesarias = diccionario->num + adicionales;
+    size_t capacidad = diccionario->capacidad;
+    char **cadenas = diccionario->cadenas;
+    uint64_t *hashes = diccionario->hashes;
+    *reemplazadas = 0;
+    if (necesarias > capacidad) {
+        capacidad = capacidad ? capacidad * 2 : 32;
+        while (capacidad < necesarias) capacidad *= 2;
+        cadenas = (char **)mallocContado(sizeof(char *) * capacidad);
+        hashes = (uint64_t *)mallocContado(sizeof(uint64_t) * capacidad);
+        *reemplazadas |= PARTE_CADENAS;
+    }
+
+    // Tabla a lo sumo medio llena con todas las cadenas agregadas
+    size_t capacidad_tabla = 64;
+    while (capacidad_tabla < necesarias * 2) capacidad_tabla *= 2;
+    uint32_t *tabla = (uint32_t *)callocContado(capacidad_tabla, sizeof(uint32_t));
+    if (cadenas == NULL || hashes == NULL || tabla == NULL) {
+        if (*reemplazadas & PARTE_CADENAS) {
+            free(cadenas);
+            free(hashes);
+        }
+        free(tabla);
+        *reemplazadas = 0;
+        return 0;
+    }
+    *reemplazadas |= PARTE_TABLA;
+
+    if (cadenas != diccionario->cadenas && diccionario->num > 0) {
+        memcpy(cadenas, diccionario->cadenas, sizeof(char *) * diccionario->num);
+        memcpy(hashes, diccionario->hashes, sizeof(uint64_t) * diccionario->num);
+    }
+    for (size_t c = 0; c < diccionario->num; c++) {
+        size_t casilla = hashes[c] & (capacidad_tabla - 1);
+        while (tabla[casilla] != 0) casilla = (casilla + 1) & (capacidad_tabla - 1);
+        tabla[casilla] = (uint32_t)c + 1;
+    }
+    diccionario->cadenas = cadenas;
+    diccionario->hashes = hashes;
+    diccionario->capacidad = capacidad;
+    diccionario->tabla = tabla;
+    diccionario->capacidad_tabla = capacidad_tabla;
+    return 1;
+}
+
+// Libera las partes de una copia que otra copia reemplazó; las cadenas siguen siendo de las copias nuevas
+void liberarPartesDiccionario(diccionarioCadenas *diccionario, unsigned int partes) {
+    if (partes & PARTE_CADENAS) {
+        free(diccionario->cadenas);
+        free(diccionario->hashes);
+    }
+    if (partes & PARTE_TABLA) {
+        free(diccionario->tabla);
+    }
+}
+
+// Descarta los códigos desde `num` en adelante (por ejemplo, los de una importación
+// fallida) y vuelve a llenar la tabla con los que quedan
+void truncarDiccionario(diccionarioCadenas *diccionario, size_t num) {
+    if (num >= diccionario->num) {
+        return;
+    }
+    for (size_t c = num; c < diccionario->num; c++) {
+        free(diccionario->cadenas[c]);
+    }
+    diccionario->num = num;
+    memset(diccionario->tabla, 0, sizeof(uint32_t) * diccionario->capacidad_tabla);
+    size_t mascara = diccionario->capacidad_tabla - 1;
+    for (size_t c = 0; c < num; c++) {
+        size_t casilla = diccionario->hashes[c] & mascara;
+        while (diccionario->tabla[casilla] != 0) casilla = (casilla + 1) & mascara;
+        diccionario->tabla[casilla] = (uint32_t)c + 1;
+    }
+}
+
+/*****Nombre***************************************
+ * Función internarCadena
+ *****Descripción**********************************
+ * Devuelve el código de la cadena, agregándola al
+ * diccionario si es la primera vez que aparece. La
+ * cadena se copia; el llamador conserva la suya.
+ *****Retorno**************************************
+ * @return: El código de la cadena, o CODIGO_INVALIDO
+ *          si falla la asignación de memoria.
+ ****Entradas**************************************
+ * @param diccionario: Un puntero al `diccionarioCadenas`.
+ * @param cadena: Cadena a codificar.
+ **************************************************/
+codigoCadena internarCadena(diccionarioCadenas *diccionario, const char *cadena) {
+    uint64_t hash = hashCadena(cadena);
+
+    // Mantener la tabla a lo sumo medio llena
+    if ((diccionario->num + 1) * 2 > diccionario->capacidad_tabla && !crecerTablaDiccionario(diccionario)) {
+        printf("Error al asignar memoria para el diccionario de cadenas.\n");
+        return CODIGO_INVALIDO;
+    }
+
+    size_t mascara = diccionario->capacidad_tabla - 1;
+    size_t casilla = hash & mascara;
+    while (diccionario->tabla[casilla] != 0) {
+        uint32_t codigo = diccionario->tabla[casilla] - 1;
+        if (diccionario->hashes[codigo] == hash && strcmp(diccionario->cadenas[codigo], cadena) == 0) {
+            return codigo;
+        }
+        casilla = (casilla + 1) & mascara;
+    }
+
+    if (diccionario->num == diccionario->capacidad) {
+        size_t nueva_capacidad = diccionario->capacidad ? diccionario->capacidad * 2 : 32;
+        char **cadenas = (char **)reallocContado(diccionario->cadenas, sizeof(char *) * nueva_capacidad);
+        if (cadenas != NULL) {
+            diccionario->cadenas = cadenas;
+        }
+        uint64_t *hashes = (uint64_t *)reallocContado(diccionario->hashes, sizeof(uint64_t) * nueva_capacidad);
+        if (hashes != NULL) {
+            diccionario->hashes = hashes;
+        }
+        if (cadenas == NULL || hashes == NULL) {
+            printf("Error al asignar memoria para el diccionario de cadenas.\n");
+            return CODIGO_INVALIDO;
+        }
+        diccionario->capacidad = nueva_capacidad;
+    }
+
+    char *copia = strdupContado(cadena);
+    if (copia == NULL) {
+        printf("Error al asignar memoria para el diccionario de cadenas.\n");
+        return CODIGO_INVALIDO;
+    }
+    codigoCadena codigo = (codigoCadena)diccionario->num++;
+    diccionario->cadenas[codigo] = copia;
+    diccionario->hashes[codigo] = hash;
+    diccionario->tabla[casilla] = codigo + 1;
+    return codigo;
+}
+
+// Código de una cadena ya guardada, sin agregarla; CODIGO_INVALIDO si no está
+codigoCadena buscarCadena(const diccionarioCadenas *diccionario, const char *cadena) {
+    if (diccionario->num == 0) {
+        return CODIGO_INVALIDO;
+    }
+    uint64_t hash = hashCadena(cadena);
+    size_t mascara = diccionario->capacidad_tabla - 1;
+    for (size_t casilla = hash & mascara; diccionario->tabla[casilla] != 0; casilla = (casilla + 1) & mascara) {
+        uint32_t codigo = diccionario->tabla[casilla] - 1;
+        if (diccionario->hashes[codigo] == hash && strcmp(diccionario->cadenas[codigo], cadena) == 0) {
+            return codigo;
+        }
+    }
+    return CODIGO_INVALIDO;
+}
+
+// Cadena de un código; los códigos inválidos se muestran como cadena vacía
+const char* cadenaDeCodigo(const diccionarioCadenas *diccionario, codigoCadena codigo) {
+    return (codigo < diccionario->num) ? diccionario->cadenas[codigo] : "";
+}
+
+#endif // DICCIONARIO_H
@@ -0,0 +1,57 @@
+#ifndef DINERO_H
+#define DINERO_H
+
+/*****Datos administrativos************************
+ * Nombre del archivo: dinero
+ * Tipo de archivo: C Encabezado
+ * Proyecto: Sistema de Análisis de Datos de Ventas
+ *****Descripción**********************************
+ * Representación de montos en punto fijo: un entero de
+ * 64 bits con la cantidad de fracciones de la moneda
+ * (centavos por defecto). Las sumas de montos son
+ * exactas y no dependen del orden, a diferencia de
+ * acumular en `float`. La cantidad de decimales se
+ * puede cambiar al compilar con -DDINERO_DECIMALES=N.
+ **************************************************/
+
+#include <stdint.h>
+#include <math.h>
+
+typedef int64_t dinero;
+
+#ifndef DINERO_DECIMALES
+#define DINERO_DECIMALES 2
+#endif
+
+#if DINERO_DECIMALES == 0
+#define DINERO_ESCALA 1LL
+#elif DINERO_DECIMALES == 1
+#define DINERO_ESCALA 10LL
+#elif DINERO_DECIMALES == 2
+#define DINERO_ESCALA 100LL
+#elif DINERO_DECIMALES == 3
+#define DINERO_ESCALA 1000LL
+#elif DINERO_DECIMALES == 4
+#define DINERO_ESCALA 10000LL
+#else
+#error "DINERO_DECIMALES debe estar entre 0 y 4"
+#endif
+
+// Convierte un número leído (JSON, cuantiles) al monto más cercano
+dinero dineroDesdeDouble(double valor) {
+    return (dinero)llround(valor * DINERO_ESCALA);
+}
+
+// Convierte un monto a número, para mostrarlo o escribirlo en JSON
+double dineroADouble(dinero monto) {
+    return (double)monto / DINERO_ESCALA;
+}
+
+// Divide un monto redondeando al más cercano (por ejemplo, para una media)
+dinero dividirDinero(dinero monto, int64_t divisor) {
+    if (divisor == 0) return 0;
+    dinero mitad = divisor / 2;
+    return (monto >= 0) ? (monto + mitad) / divisor : (monto - mitad) / divisor;
+}
+
+#endif // DINERO_H
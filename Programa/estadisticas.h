@@ -0,0 +1,285 @@
+#ifndef ESTADISTICAS_H
+#define ESTADISTICAS_H
+
+/*****Datos administrativos************************
+ * Nombre del archivo: estadisticas
+ * Tipo de archivo: C Encabezado
+ * Proyecto: Sistema de Análisis de Datos de Ventas
+ *****Descripción**********************************
+ * Reporte estadístico de precio unitario, cantidad e
+ * importe: mínimo, máximo, media, varianza, percentiles
+ * p50/p90/p99, histograma y desglose por categoría.
+ * Cada columna se copia a un arreglo contiguo y se
+ * recorre una vez para los momentos y el histograma;
+ * los percentiles se obtienen por selección (o con el
+ * t-digest en modo aproximado) en lugar de ordenar.
+ **************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "ventas.h"
+
+#define CLASES_HISTOGRAMA 10
+#define ANCHO_BARRA_HISTOGRAMA 40
+
+/*****Nombre****************************************
+ * struct EstadisticasColumna
+ *****Descripción***********************************
+ * Resumen estadístico de una columna numérica, ya
+ * convertido a unidades (dividido por la escala).
+ *****Campos****************************************
+ * @n: Cantidad de valores.
+ * @minimo: Menor valor.
+ * @maximo: Mayor valor.
+ * @media: Media aritmética.
+ * @varianza: Varianza poblacional.
+ * @p50: Percentil 50 (mediana).
+ * @p90: Percentil 90.
+ * @p99: Percentil 99.
+ * @histograma: Cantidad de valores por clase, con clases de
+ *              igual ancho entre el mínimo y el máximo.
+ ***************************************************/
+typedef struct {
+    size_t n;
+    double minimo;
+    double maximo;
+    double media;
+    double varianza;
+    double p50;
+    double p90;
+    double p99;
+    size_t histograma[CLASES_HISTOGRAMA];
+} EstadisticasColumna;
+
+/*****Nombre****************************************
+ * struct EstadisticasCategoria
+ *****Descripción***********************************
+ * Desglose de una categoría.
+ *****Campos****************************************
+ * @categoria: Nombre de la categoría.
+ * @ventas: Cantidad de ventas.
+ * @unidades: Unidades vendidas.
+ * @importe: Importe total.
+ * @precio_minimo: Menor precio unitario.
+ * @precio_maximo: Mayor precio unitario.
+ ***************************************************/
+typedef struct {
+    const char *categoria;
+    size_t ventas;
+    long unidades;
+    dinero importe;
+    dinero precio_minimo;
+    dinero precio_maximo;
+} EstadisticasCategoria;
+
+// Posición del percentil p (0-100) en un arreglo ordenado de n valores
+size_t posicionPercentil(size_t n, double p) {
+    size_t k = (size_t)(p / 100.0 * (n - 1) + 0.5);
+    return k < n ? k : n - 1;
+}
+
+/*****Nombre***************************************
+ * Función calcularEstadisticasColumna
+ *****Descripción**********************************
+ * Calcula el resumen de una columna. Los momentos se
+ * acumulan en una pasada respecto del primer valor
+ * (para no perder precisión en la varianza) y los
+ * percentiles se seleccionan sobre rangos cada vez
+ * menores: p90 y p99 se buscan solo a la derecha de p50.
+ * La columna es de enteros en punto fijo (montos o
+ * cantidades), así que los extremos y percentiles son
+ * exactos hasta la conversión final.
+ *****Retorno**************************************
+ *
+ ****Entradas**************************************
+ * @param valores: Arreglo de la columna (se reordena).
+ * @param n: Cantidad de valores.
+ * @param escala: Fracciones por unidad (DINERO_ESCALA
+ *                para montos, 1 para cantidades).
+ * @param resultado: Recibe el resumen.
+ **************************************************/
+void calcularEstadisticasColumna(int64_t *valores, size_t n, int64_t escala, EstadisticasColumna *resultado) {
+    memset(resultado, 0, sizeof(EstadisticasColumna));
+    resultado->n = n;
+    if (n == 0) {
+        return;
+    }
+
+    int64_t minimo = valores[0];
+    int64_t maximo = valores[0];
+    int64_t referencia = valores[0];
+    double suma = 0.0;
+    double suma_cuadrados = 0.0;
+    for (size_t i = 0; i < n; i++) {
+        double d = (double)(valores[i] - referencia);
+        suma += d;
+        suma_cuadrados += d * d;
+        minimo = valores[i] < minimo ? valores[i] : minimo;
+        maximo = valores[i] > maximo ? valores[i] : maximo;
+    }
+    resultado->minimo = (double)minimo / escala;
+    resultado->maximo = (double)maximo / escala;
+    resultado->media = ((double)referencia + suma / n) / escala;
+    resultado->varianza = (suma_cuadrados - suma * suma / n) / n / ((double)escala * escala);
+    if (resultado->varianza < 0.0) {
+        resultado->varianza = 0.0;
+    }
+
+    // El histograma necesita el mínimo y el máximo, por eso va en una segunda pasada sin ramas
+    double ancho = (double)(maximo - minimo) / CLASES_HISTOGRAMA;
+    for (size_t i = 0; i < n; i++) {
+        size_t clase = ancho > 0 ? (size_t)((double)(valores[i] - minimo) / ancho) : 0;
+        resultado->histograma[clase < CLASES_HISTOGRAMA ? clase : CLASES_HISTOGRAMA - 1]++;
+    }
+
+    size_t k50 = posicionPercentil(n, 50);
+    size_t k90 = posicionPercentil(n, 90);
+    size_t k99 = posicionPercentil(n, 99);
+    int64_t p50 = seleccionarKesimo(valores, n, k50);
+    int64_t p90 = k90 > k50 ? seleccionarKesimo(valores + k50, n - k50, k90 - k50) : p50;
+    int64_t p99 = k99 > k90 ? seleccionarKesimo(valores + k90, n - k90, k99 - k90) : p90;
+    resultado->p50 = (double)p50 / escala;
+    resultado->p90 = (double)p90 / escala;
+    resultado->p99 = (double)p99 / escala;
+}
+
+void mostrarEstadisticasColumna(const char *nombre, const EstadisticasColumna *columna) {
+    printf("\n%s (%zu valores)\n", nombre, columna->n);
+    if (columna->n == 0) {
+        return;
+    }
+    printf("  Mínimo: %.2f   Máximo: %.2f   Media: %.2f\n", columna->minimo, columna->maximo, columna->media);
+    printf("  Varianza: %.2f   Desviación estándar: %.2f\n", columna->varianza, sqrt(columna->varianza));
+    printf("  p50: %.2f   p90: %.2f   p99: %.2f\n", columna->p50, columna->p90, columna->p99);
+
+    size_t mayor = 1;
+    for (int c = 0; c < CLASES_HISTOGRAMA; c++) {
+        if (columna->histograma[c] > mayor) mayor = columna->histograma[c];
+    }
+    double ancho = (columna->maximo - columna->minimo) / CLASES_HISTOGRAMA;
+    for (int c = 0; c < CLASES_HISTOGRAMA; c++) {
+        int barra = (int)(columna->histograma[c] * ANCHO_BARRA_HISTOGRAMA / mayor);
+        printf("  [%10.2f, %10.2f%c %8zu |", columna->minimo + c * ancho, columna->minimo + (c + 1) * ancho,
+               c == CLASES_HISTOGRAMA - 1 ? ']' : ')', columna->histograma[c]);
+        for (int b = 0; b < barra; b++) putchar('#');
+        putchar('\n');
+    }
+}
+
+/*****Nombre***************************************
+ * Función desglosarCategorias
+ *****Descripción**********************************
+ * Agrupa las ventas por categoría en una pasada,
+ * acumulando en un arreglo indexado por el código de
+ * la categoría. Las categorías quedan en el orden en
+ * que aparecieron por primera vez al importar.
+ *****Retorno**************************************
+ * @return: Arreglo de categorías (el llamador lo libera),
+ *          o NULL si falla la asignación de memoria.
+ ****Entradas**************************************
+ * @param lista: Un puntero al struct `listaVentas`.
+ * @param num_categorias: Recibe la cantidad de categorías.
+ **************************************************/
+EstadisticasCategoria* desglosarCategorias(listaVentas *lista, size_t *num_categorias) {
+    // Una posición por código más una para las ventas con código inválido
+    size_t num_codigos = lista->categorias.num;
+    EstadisticasCategoria *categorias = (EstadisticasCategoria *)callocContado(num_codigos + 1, sizeof(EstadisticasCategoria));
+    *num_categorias = 0;
+    if (categorias == NULL) {
+        printf("Error al asignar memoria para el desglose por categoría.\n");
+        return NULL;
+    }
+
+    for (size_t i = 0; i < lista->size; i++) {
+        Venta *venta = &lista->ventas[i];
+        EstadisticasCategoria *categoria = &categorias[venta->codigo_categoria < num_codigos ? venta->codigo_categoria : num_codigos];
+        if (categoria->ventas == 0) {
+            categoria->precio_minimo = venta->precio_unitario;
+            categoria->precio_maximo = venta->precio_unitario;
+        }
+        categoria->ventas++;
+        categoria->unidades += venta->cantidad;
+        categoria->importe += importeVenta(venta);
+        if (venta->precio_unitario < categoria->precio_minimo) categoria->precio_minimo = venta->precio_unitario;
+        if (venta->precio_unitario > categoria->precio_maximo) categoria->precio_maximo = venta->precio_unitario;
+    }
+
+    // Compactar dejando solo las categorías con ventas
+    for (size_t c = 0; c <= num_codigos; c++) {
+        if (categorias[c].ventas > 0) {
+            categorias[*num_categorias] = categorias[c];
+            categorias[*num_categorias].categoria = cadenaDeCodigo(&lista->categorias, c < num_codigos ? (codigoCadena)c : CODIGO_INVALIDO);
+            (*num_categorias)++;
+        }
+    }
+    return categorias;
+}
+
+/*****Nombre***************************************
+ * Función mostrarReporteEstadistico
+ *****Descripción**********************************
+ * Calcula e imprime el reporte estadístico completo.
+ *****Retorno**************************************
+ *
+ ****Entradas**************************************
+ * @param lista: Un puntero al struct `listaVentas`.
+ **************************************************/
+void mostrarReporteEstadistico(listaVentas *lista) {
+    if (lista == NULL || lista->size == 0) {
+        printf("No hay datos de ventas disponibles.\n");
+        return;
+    }
+
+    inicioMetrica inicio = metricaInicio();
+    size_t n = lista->size;
+    int64_t *columna = (int64_t *)mallocContado(sizeof(int64_t) * n);
+    if (columna == NULL) {
+        printf("Error al asignar memoria para el reporte estadístico.\n");
+        return;
+    }
+
+    EstadisticasColumna estadisticas;
+    printf("Reporte estadístico de %zu ventas\n", n);
+
+    for (size_t i = 0; i < n; i++) columna[i] = lista->ventas[i].precio_unitario;
+    calcularEstadisticasColumna(columna, n, DINERO_ESCALA, &estadisticas);
+    if (lista->bosquejos != NULL) {
+        // En modo aproximado los percentiles de precio salen del t-digest
+        estadisticas.p50 = cuantilTDigest(&lista->bosquejos->precios, 0.50);
+        estadisticas.p90 = cuantilTDigest(&lista->bosquejos->precios, 0.90);
+        estadisticas.p99 = cuantilTDigest(&lista->bosquejos->precios, 0.99);
+    }
+    mostrarEstadisticasColumna("Precio unitario", &estadisticas);
+
+    for (size_t i = 0; i < n; i++) columna[i] = lista->ventas[i].cantidad;
+    calcularEstadisticasColumna(columna, n, 1, &estadisticas);
+    mostrarEstadisticasColumna("Cantidad", &estadisticas);
+
+    for (size_t i = 0; i < n; i++) {
+        Venta *venta = &lista->ventas[i];
+        columna[i] = importeVenta(venta);
+    }
+    calcularEstadisticasColumna(columna, n, DINERO_ESCALA, &estadisticas);
+    mostrarEstadisticasColumna("Importe por venta", &estadisticas);
+    free(columna);
+
+    size_t num_categorias;
+    EstadisticasCategoria *categorias = desglosarCategorias(lista, &num_categorias);
+    if (categorias != NULL) {
+        printf("\nDesglose por categoría:\n");
+        printf("  %-24s %8s %10s %14s %12s %10s %10s\n", "Categoría", "Ventas", "Unidades", "Importe", "Precio medio", "Mínimo", "Máximo");
+        for (size_t c = 0; c < num_categorias; c++) {
+            EstadisticasCategoria *cat = &categorias[c];
+            printf("  %-24s %8zu %10ld %14.2f %12.2f %10.2f %10.2f\n", cat->categoria, cat->ventas, cat->unidades,
+                   dineroADouble(cat->importe), cat->unidades > 0 ? dineroADouble(cat->importe) / cat->unidades : 0.0,
+                   dineroADouble(cat->precio_minimo), dineroADouble(cat->precio_maximo));
+        }
+        free(categorias);
+    }
+
+    metricaFin(ETAPA_ESTADISTICAS, inicio, n);
+}
+
+#endif // ESTADISTICAS_H
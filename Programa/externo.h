@@ -0,0 +1,384 @@
+#ifndef EXTERNO_H
+#define EXTERNO_H
+
+/*****Datos administrativos************************
+ * Nombre del archivo: externo
+ * Tipo de archivo: C Encabezado
+ * Proyecto: Sistema de Análisis de Datos de Ventas
+ *****Descripción**********************************
+ * Ejecución con presupuesto de memoria. Cuando una
+ * estructura auxiliar (el conjunto de ids al eliminar
+ * duplicados o la tabla de grupos de una consulta) no
+ * cabe en el presupuesto configurado, se vuelca a
+ * archivos temporales:
+ *   - Corridas ordenadas: los registros se acumulan en
+ *     un buffer del tamaño del presupuesto que, al
+ *     llenarse, se ordena y se escribe como corrida; al
+ *     final se mezclan todas leyendo un bloque de cada
+ *     una.
+ *   - Particiones: los registros se reparten por hash
+ *     en archivos que después se procesan de a uno.
+ * Los archivos se crean con tmpfile y se borran solos
+ * al cerrarse. Las ventas siguen en memoria: el
+ * presupuesto acota las estructuras auxiliares.
+ **************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "metricas.h"
+
+// Registros mínimos por bloque de lectura de cada corrida durante la mezcla
+#define MIN_REGISTROS_BLOQUE_EXTERNO 256
+// Particiones en que se reparten los grupos volcados a disco
+#define PARTICIONES_EXTERNAS 64
+
+// Presupuesto en bytes para las estructuras auxiliares (0 sin límite)
+static size_t presupuesto_memoria = 0;
+
+void configurarPresupuestoMemoria(size_t bytes) {
+    presupuesto_memoria = bytes;
+}
+
+// 1 si una estructura de `bytes` cabe en el presupuesto configurado
+int cabeEnPresupuesto(size_t bytes) {
+    return presupuesto_memoria == 0 || bytes <= presupuesto_memoria;
+}
+
+typedef int (*comparadorRegistros)(const void *a, const void *b);
+
+/*****Nombre****************************************
+ * struct corridasOrdenadas
+ *****Descripción***********************************
+ * Ordenamiento externo de registros de tamaño fijo.
+ *****Campos****************************************
+ * @tam_registro: Bytes de cada registro.
+ * @comparar: Orden de los registros (como qsort).
+ * @buffer: Registros aún no volcados.
+ * @capacidad: Registros que caben en `buffer`.
+ * @usados: Registros en `buffer`.
+ * @corridas: Archivo temporal de cada corrida.
+ * @largos: Registros de cada corrida.
+ * @num_corridas: Corridas escritas.
+ * @capacidad_corridas: Capacidad de `corridas` y `largos`.
+ * @bytes_escritos: Bytes volcados a disco.
+ * @error: 1 si falló la memoria o un archivo temporal.
+ ***************************************************/
+typedef struct {
+    size_t tam_registro;
+    comparadorRegistros comparar;
+    char *buffer;
+    size_t capacidad;
+    size_t usados;
+    FILE **corridas;
+    size_t *largos;
+    size_t num_corridas;
+    size_t capacidad_corridas;
+    size_t bytes_escritos;
+    int error;
+} corridasOrdenadas;
+
+/*****Nombre***************************************
+ * Función iniciarCorridas
+ *****Descripción**********************************
+ * Prepara un ordenamiento externo cuyo buffer ocupa
+ * como mucho `presupuesto` bytes.
+ *****Retorno**************************************
+ * @return: 1 si se inició, 0 si falló la memoria.
+ ****Entradas**************************************
+ * @param corridas: Estado a iniciar.
+ * @param tam_registro: Bytes de cada registro.
+ * @param comparar: Orden de los registros.
+ * @param presupuesto: Bytes del buffer.
+ **************************************************/
+int iniciarCorridas(corridasOrdenadas *corridas, size_t tam_registro, comparadorRegistros comparar, size_t presupuesto) {
+    memset(corridas, 0, sizeof(corridasOrdenadas));
+    corridas->tam_registro = tam_registro;
+    corridas->comparar = comparar;
+    corridas->capacidad = presupuesto / tam_registro;
+    if (corridas->capacidad < MIN_REGISTROS_BLOQUE_EXTERNO) {
+        corridas->capacidad = MIN_REGISTROS_BLOQUE_EXTERNO;
+    }
+    corridas->buffer = (char *)mallocContado(corridas->capacidad * tam_registro);
+    return corridas->buffer != NULL;
+}
+
+// Ordena el buffer y lo escribe como una corrida nueva
+int volcarCorrida(corridasOrdenadas *corridas) {
+    if (corridas->num_corridas == corridas->capacidad_corridas) {
+        size_t nueva_capacidad = corridas->capacidad_corridas ? corridas->capacidad_corridas * 2 : 8;
+        FILE **archivos = (FILE **)reallocContado(corridas->corridas, sizeof(FILE *) * nueva_capacidad);
+        if (archivos == NULL) {
+            return 0;
+        }
+        corridas->corridas = archivos;
+        size_t *largos = (size_t *)reallocContado(corridas->largos, sizeof(size_t) * nueva_capacidad);
+        if (largos == NULL) {
+            return 0;
+        }
+        corridas->largos = largos;
+        corridas->capacidad_corridas = nueva_capacidad;
+    }
+
+    FILE *archivo = tmpfile();
+    if (archivo == NULL) {
+        printf("Error al crear un archivo temporal para el ordenamiento externo.\n");
+        return 0;
+    }
+    qsort(corridas->buffer, corridas->usados, corridas->tam_registro, corridas->comparar);
+    if (fwrite(corridas->buffer, corridas->tam_registro, corridas->usados, archivo) != corridas->usados || fflush(archivo) != 0) {
+        printf("Error al escribir un archivo temporal del ordenamiento externo.\n");
+        fclose(archivo);
+        return 0;
+    }
+    rewind(archivo);
+    corridas->corridas[corridas->num_corridas] = archivo;
+    corridas->largos[corridas->num_corridas++] = corridas->usados;
+    corridas->bytes_escritos += corridas->usados * corridas->tam_registro;
+    corridas->usados = 0;
+    return 1;
+}
+
+// Agrega un registro; si el buffer está lleno, primero lo vuelca como corrida
+int agregarACorridas(corridasOrdenadas *corridas, const void *registro) {
+    if (corridas->error) {
+        return 0;
+    }
+    if (corridas->usados == corridas->capacidad && !volcarCorrida(corridas)) {
+        corridas->error = 1;
+        return 0;
+    }
+    memcpy(corridas->buffer + corridas->usados * corridas->tam_registro, registro, corridas->tam_registro);
+    corridas->usados++;
+    return 1;
+}
+
+/*****Nombre****************************************
+ * struct lectorCorrida
+ *****Descripción***********************************
+ * Bloque en memoria de una corrida durante la mezcla.
+ *****Campos****************************************
+ * @bloque: Registros leídos de la corrida.
+ * @cantidad: Registros en `bloque`.
+ * @posicion: Siguiente registro de `bloque`.
+ * @restantes: Registros de la corrida aún sin leer.
+ ***************************************************/
+typedef struct {
+    char *bloque;
+    size_t cantidad;
+    size_t posicion;
+    size_t restantes;
+} lectorCorrida;
+
+// Lee el siguiente bloque de la corrida `c`; 0 si ya no quedan registros o falló la lectura
+int leerBloqueCorrida(corridasOrdenadas *corridas, lectorCorrida *lector, size_t c, size_t registros_bloque) {
+    size_t cantidad = lector->restantes < registros_bloque ? lector->restantes : registros_bloque;
+    if (cantidad == 0) {
+        return 0;
+    }
+    if (fread(lector->bloque, corridas->tam_registro, cantidad, corridas->corridas[c]) != cantidad) {
+        printf("Error al leer un archivo temporal del ordenamiento externo.\n");
+        corridas->error = 1;
+        return 0;
+    }
+    lector->cantidad = cantidad;
+    lector->posicion = 0;
+    lector->restantes -= cantidad;
+    return 1;
+}
+
+// Registro actual de la corrida en la mezcla
+const void* registroActual(const corridasOrdenadas *corridas, const lectorCorrida *lector) {
+    return lector->bloque + lector->posicion * corridas->tam_registro;
+}
+
+// Baja el elemento `i` del montículo de corridas (mínimo en la raíz)
+void hundirCorrida(corridasOrdenadas *corridas, lectorCorrida *lectores, size_t *monticulo, size_t num, size_t i) {
+    for (;;) {
+        size_t menor = i;
+        size_t izquierdo = 2 * i + 1;
+        size_t derecho = izquierdo + 1;
+        if (izquierdo < num && corridas->comparar(registroActual(corridas, &lectores[monticulo[izquierdo]]),
+                                                  registroActual(corridas, &lectores[monticulo[menor]])) < 0) {
+            menor = izquierdo;
+        }
+        if (derecho < num && corridas->comparar(registroActual(corridas, &lectores[monticulo[derecho]]),
+                                                registroActual(corridas, &lectores[monticulo[menor]])) < 0) {
+            menor = derecho;
+        }
+        if (menor == i) {
+            return;
+        }
+        size_t temp = monticulo[i];
+        monticulo[i] = monticulo[menor];
+        monticulo[menor] = temp;
+        i = menor;
+    }
+}
+
+/*****Nombre***************************************
+ * Función mezclarCorridas
+ *****Descripción**********************************
+ * Entrega todos los registros agregados, en orden, a
+ * `visitar`. Si nunca se llenó el buffer, se ordena en
+ * memoria; si no, el resto se vuelca como última
+ * corrida y se mezclan todas con un montículo, leyendo
+ * cada corrida por bloques que se reparten el buffer.
+ *****Retorno**************************************
+ * @return: 1 si se recorrieron todos, 0 si hubo un error.
+ ****Entradas**************************************
+ * @param corridas: Ordenamiento externo.
+ * @param visitar: Función llamada con cada registro.
+ * @param contexto: Primer argumento de `visitar`.
+ **************************************************/
+int mezclarCorridas(corridasOrdenadas *corridas, void (*visitar)(void *contexto, const void *registro), void *contexto) {
+    if (corridas->error) {
+        return 0;
+    }
+    if (corridas->num_corridas == 0) {
+        qsort(corridas->buffer, corridas->usados, corridas->tam_registro, corridas->comparar);
+        for (size_t i = 0; i < corridas->usados; i++) {
+            visitar(contexto, corridas->buffer + i * corridas->tam_registro);
+        }
+        return 1;
+    }
+    if (corridas->usados > 0 && !volcarCorrida(corridas)) {
+        corridas->error = 1;
+        return 0;
+    }
+
+    // El buffer se reparte entre las corridas; con muchas corridas, cada bloque tiene un mínimo
+    size_t num = corridas->num_corridas;
+    size_t registros_bloque = corridas->capacidad / num;
+    if (registros_bloque < MIN_REGISTROS_BLOQUE_EXTERNO) {
+        registros_bloque = MIN_REGISTROS_BLOQUE_EXTERNO;
+        char *buffer = (char *)reallocContado(corridas->buffer, num * registros_bloque * corridas->tam_registro);
+        if (buffer == NULL) {
+            corridas->error = 1;
+            return 0;
+        }
+        corridas->buffer = buffer;
+        corridas->capacidad = num * registros_bloque;
+    }
+    lectorCorrida *lectores = (lectorCorrida *)callocContado(num, sizeof(lectorCorrida));
+    size_t *monticulo = (size_t *)mallocContado(sizeof(size_t) * num);
+    if (lectores == NULL || monticulo == NULL) {
+        free(lectores);
+        free(monticulo);
+        corridas->error = 1;
+        return 0;
+    }
+
+    size_t activos = 0;
+    for (size_t c = 0; c < num; c++) {
+        lectores[c].bloque = corridas->buffer + c * registros_bloque * corridas->tam_registro;
+        lectores[c].restantes = corridas->largos[c];
+        if (leerBloqueCorrida(corridas, &lectores[c], c, registros_bloque)) {
+            monticulo[activos++] = c;
+        }
+    }
+    for (size_t i = activos / 2; i-- > 0;) {
+        hundirCorrida(corridas, lectores, monticulo, activos, i);
+    }
+
+    while (activos > 0 && !corridas->error) {
+        size_t c = monticulo[0];
+        visitar(contexto, registroActual(corridas, &lectores[c]));
+        if (++lectores[c].posicion == lectores[c].cantidad && !leerBloqueCorrida(corridas, &lectores[c], c, registros_bloque)) {
+            monticulo[0] = monticulo[--activos];
+        }
+        hundirCorrida(corridas, lectores, monticulo, activos, 0);
+    }
+
+    free(lectores);
+    free(monticulo);
+    return !corridas->error;
+}
+
+void liberarCorridas(corridasOrdenadas *corridas) {
+    for (size_t c = 0; c < corridas->num_corridas; c++) {
+        fclose(corridas->corridas[c]);
+    }
+    free(corridas->corridas);
+    free(corridas->largos);
+    free(corridas->buffer);
+    memset(corridas, 0, sizeof(corridasOrdenadas));
+}
+
+/*****Nombre****************************************
+ * struct particionesExternas
+ *****Descripción***********************************
+ * Registros de tamaño fijo repartidos en archivos
+ * temporales, uno por partición.
+ *****Campos****************************************
+ * @tam_registro: Bytes de cada registro.
+ * @archivos: Archivo de cada partición (NULL si vacía).
+ * @conteo: Registros de cada partición.
+ * @bytes_escritos: Bytes volcados a disco.
+ * @error: 1 si falló un archivo temporal.
+ ***************************************************/
+typedef struct {
+    size_t tam_registro;
+    FILE *archivos[PARTICIONES_EXTERNAS];
+    size_t conteo[PARTICIONES_EXTERNAS];
+    size_t bytes_escritos;
+    int error;
+} particionesExternas;
+
+void iniciarParticionesExternas(particionesExternas *particiones, size_t tam_registro) {
+    memset(particiones, 0, sizeof(particionesExternas));
+    particiones->tam_registro = tam_registro;
+}
+
+// Agrega un registro al final de la partición `p`
+int escribirEnParticion(particionesExternas *particiones, size_t p, const void *registro) {
+    if (particiones->error) {
+        return 0;
+    }
+    if (particiones->archivos[p] == NULL && (particiones->archivos[p] = tmpfile()) == NULL) {
+        printf("Error al crear un archivo temporal para las particiones externas.\n");
+        particiones->error = 1;
+        return 0;
+    }
+    if (fwrite(registro, particiones->tam_registro, 1, particiones->archivos[p]) != 1) {
+        printf("Error al escribir un archivo temporal de las particiones externas.\n");
+        particiones->error = 1;
+        return 0;
+    }
+    particiones->conteo[p]++;
+    particiones->bytes_escritos += particiones->tam_registro;
+    return 1;
+}
+
+// Lee la partición `p` completa en un arreglo nuevo (NULL si está vacía o si falla)
+void* leerParticionExterna(particionesExternas *particiones, size_t p) {
+    size_t cantidad = particiones->conteo[p];
+    if (cantidad == 0 || particiones->error) {
+        return NULL;
+    }
+    char *registros = (char *)mallocContado(cantidad * particiones->tam_registro);
+    if (registros == NULL || fflush(particiones->archivos[p]) != 0) {
+        free(registros);
+        particiones->error = 1;
+        return NULL;
+    }
+    rewind(particiones->archivos[p]);
+    if (fread(registros, particiones->tam_registro, cantidad, particiones->archivos[p]) != cantidad) {
+        printf("Error al leer un archivo temporal de las particiones externas.\n");
+        free(registros);
+        particiones->error = 1;
+        return NULL;
+    }
+    return registros;
+}
+
+void liberarParticionesExternas(particionesExternas *particiones) {
+    for (size_t p = 0; p < PARTICIONES_EXTERNAS; p++) {
+        if (particiones->archivos[p] != NULL) {
+            fclose(particiones->archivos[p]);
+        }
+    }
+    memset(particiones, 0, sizeof(particionesExternas));
+}
+
+#endif // EXTERNO_H
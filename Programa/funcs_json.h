@@ -18,6 +18,8 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <cjson/cJSON.h>
+#include "metricas.h"
+#include "compresion.h"
 
 /*****Nombre***************************************
  * Función leerArchivo
@@ -25,7 +27,8 @@
  * Lee el contenido de un archivo de texto y lo devuelve 
  * como una cadena de caracteres. La memoria para la cadena 
  * se asigna dinámicamente y debe ser liberada por el 
- * llamador de la función.
+ * llamador de la función. Si el archivo está comprimido
+ * con gzip o zstd se devuelve el contenido descomprimido.
  *****Retorno**************************************
  * @return: Un puntero a una cadena de caracteres que 
  *          contiene el contenido del archivo, o NULL 
@@ -34,23 +37,42 @@
  * @param path: Ruta del archivo que se desea leer.
  **************************************************/
 char* leerArchivo(const char *path) {
-    FILE *archivo = fopen(path, "r");
+    lectorArchivo *lector = abrirLector(path);
     
-    if (archivo == NULL) {
+    if (lector == NULL) {
         return NULL;
     }
 
-    fseek(archivo, 0, SEEK_END);
-    long len = ftell(archivo);
-    fseek(archivo, 0, SEEK_SET);
+    size_t capacidad = BLOQUE_COMPRESION;
+    size_t largo = 0;
+    char *contenido = (char *)mallocContado(capacidad + 1);
+    while (contenido != NULL) {
+        size_t leidos = leerLector(lector, contenido + largo, capacidad - largo);
+        largo += leidos;
+        if (leidos == 0) {
+            break;
+        }
+        if (largo == capacidad) {
+            capacidad *= 2;
+            char *temp = (char *)reallocContado(contenido, capacidad + 1);
+            if (temp == NULL) {
+                free(contenido);
+            }
+            contenido = temp;
+        }
+    }
 
-    char *contenido = (char *)malloc(len + 1);
-    if (contenido) {
-        fread(contenido, 1, len, archivo);
-        contenido[len] = '\0';
+    if (contenido != NULL) {
+        if (lector->error) {
+            printf("Error al descomprimir el archivo %s: los datos están dañados o incompletos.\n", path);
+            free(contenido);
+            contenido = NULL;
+        } else {
+            contenido[largo] = '\0';
+        }
     }
 
-    fclose(archivo);
+    cerrarLector(lector);
 
     return contenido;
 }
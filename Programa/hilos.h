@@ -0,0 +1,231 @@
+#ifndef HILOS_H
+#define HILOS_H
+
+/*****Datos administrativos************************
+ * Nombre del archivo: hilos
+ * Tipo de archivo: C Encabezado
+ * Proyecto: Sistema de Análisis de Datos de Ventas
+ *****Descripción**********************************
+ * Utilidades de concurrencia compartidas por las etapas
+ * paralelas: un grupo de hilos que reparte tareas
+ * independientes y una cola acotada sin bloqueos para
+ * comunicar etapas productor/consumidor.
+ **************************************************/
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdatomic.h>
+#include <pthread.h>
+#include <sched.h>
+#include <time.h>
+#include <unistd.h>
+#include "metricas.h"
+
+#define MAX_HILOS 64
+
+/*****Nombre****************************************
+ * struct grupoTareas
+ *****Descripción***********************************
+ * Grupo de hilos de una etapa: cada hilo toma la
+ * siguiente tarea libre hasta agotarlas.
+ *****Campos****************************************
+ * @tarea: Función que procesa una tarea.
+ * @contexto: Datos compartidos de la etapa.
+ * @num_tareas: Cantidad de tareas.
+ * @siguiente: Próxima tarea libre (acceso atómico).
+ ***************************************************/
+typedef struct {
+    void (*tarea)(void *contexto, size_t indice);
+    void *contexto;
+    size_t num_tareas;
+    size_t siguiente;
+} grupoTareas;
+
+void* trabajadorTareas(void *argumento) {
+    grupoTareas *grupo = (grupoTareas *)argumento;
+    size_t indice;
+    while ((indice = __atomic_fetch_add(&grupo->siguiente, 1, __ATOMIC_RELAXED)) < grupo->num_tareas) {
+        grupo->tarea(grupo->contexto, indice);
+    }
+    return NULL;
+}
+
+/*****Nombre***************************************
+ * Función ejecutarTareas
+ *****Descripción**********************************
+ * Ejecuta `num_tareas` tareas con hasta `hilos` hilos;
+ * el hilo que llama también trabaja. Si no se puede
+ * crear un hilo, las tareas las termina el resto.
+ *****Retorno**************************************
+ *
+ ****Entradas**************************************
+ * @param hilos: Cantidad de hilos a usar.
+ * @param tarea: Función que procesa una tarea.
+ * @param contexto: Datos compartidos.
+ * @param num_tareas: Cantidad de tareas.
+ **************************************************/
+void ejecutarTareas(int hilos, void (*tarea)(void *, size_t), void *contexto, size_t num_tareas) {
+    grupoTareas grupo = { tarea, contexto, num_tareas, 0 };
+    pthread_t ids[MAX_HILOS];
+    int lanzados = 0;
+
+    for (int h = 1; h < hilos && h < MAX_HILOS && (size_t)h < num_tareas; h++) {
+        if (pthread_create(&ids[lanzados], NULL, trabajadorTareas, &grupo) == 0) {
+            lanzados++;
+        }
+    }
+    trabajadorTareas(&grupo);
+    for (int h = 0; h < lanzados; h++) {
+        pthread_join(ids[h], NULL);
+    }
+}
+
+// Hilos por defecto: la variable de entorno VENTAS_HILOS o los núcleos disponibles
+int hilosPorDefecto() {
+    const char *valor = getenv("VENTAS_HILOS");
+    long hilos = (valor != NULL) ? strtol(valor, NULL, 10) : sysconf(_SC_NPROCESSORS_ONLN);
+    if (hilos < 1) hilos = 1;
+    if (hilos > MAX_HILOS) hilos = MAX_HILOS;
+    return (int)hilos;
+}
+
+/*****Nombre****************************************
+ * struct colaAcotada
+ *****Descripción***********************************
+ * Cola circular de punteros con capacidad fija, para
+ * varios productores y varios consumidores, sin
+ * bloqueos: cada celda lleva un número de secuencia
+ * que indica si está libre para escribir o lista para
+ * leer en la vuelta actual. Admite encolar NULL.
+ *****Campos****************************************
+ * @celdas: Arreglo circular de celdas.
+ * @mascara: Capacidad - 1 (la capacidad es potencia de 2).
+ * @entrada: Próxima posición de escritura.
+ * @salida: Próxima posición de lectura.
+ ***************************************************/
+typedef struct {
+    _Atomic size_t secuencia;
+    void *dato;
+} celdaCola;
+
+typedef struct {
+    celdaCola *celdas;
+    size_t mascara;
+    _Alignas(64) _Atomic size_t entrada;
+    _Alignas(64) _Atomic size_t salida;
+} colaAcotada;
+
+/*****Nombre***************************************
+ * Función crearColaAcotada
+ *****Descripción**********************************
+ * Crea una cola con al menos `capacidad` celdas.
+ *****Retorno**************************************
+ * @return: La cola, o NULL si falla la asignación.
+ ****Entradas**************************************
+ * @param capacidad: Capacidad mínima.
+ **************************************************/
+colaAcotada* crearColaAcotada(size_t capacidad) {
+    size_t tamano = 2;
+    while (tamano < capacidad) tamano *= 2;
+
+    colaAcotada *cola = (colaAcotada *)aligned_alloc(64, sizeof(colaAcotada));
+    if (cola == NULL) {
+        return NULL;
+    }
+    cola->celdas = (celdaCola *)mallocContado(sizeof(celdaCola) * tamano);
+    if (cola->celdas == NULL) {
+        free(cola);
+        return NULL;
+    }
+    for (size_t i = 0; i < tamano; i++) {
+        atomic_init(&cola->celdas[i].secuencia, i);
+    }
+    cola->mascara = tamano - 1;
+    atomic_init(&cola->entrada, 0);
+    atomic_init(&cola->salida, 0);
+    return cola;
+}
+
+void liberarColaAcotada(colaAcotada *cola) {
+    if (cola != NULL) {
+        free(cola->celdas);
+        free(cola);
+    }
+}
+
+// Intenta encolar sin esperar; devuelve 0 si la cola está llena
+int intentarEncolar(colaAcotada *cola, void *dato) {
+    size_t pos = atomic_load_explicit(&cola->entrada, memory_order_relaxed);
+    celdaCola *celda;
+    for (;;) {
+        celda = &cola->celdas[pos & cola->mascara];
+        size_t secuencia = atomic_load_explicit(&celda->secuencia, memory_order_acquire);
+        intptr_t diferencia = (intptr_t)secuencia - (intptr_t)pos;
+        if (diferencia == 0) {
+            if (atomic_compare_exchange_weak_explicit(&cola->entrada, &pos, pos + 1, memory_order_relaxed, memory_order_relaxed)) {
+                break;
+            }
+        } else if (diferencia < 0) {
+            return 0;
+        } else {
+            pos = atomic_load_explicit(&cola->entrada, memory_order_relaxed);
+        }
+    }
+    celda->dato = dato;
+    atomic_store_explicit(&celda->secuencia, pos + 1, memory_order_release);
+    return 1;
+}
+
+// Intenta desencolar sin esperar; devuelve 0 si la cola está vacía
+int intentarDesencolar(colaAcotada *cola, void **dato) {
+    size_t pos = atomic_load_explicit(&cola->salida, memory_order_relaxed);
+    celdaCola *celda;
+    for (;;) {
+        celda = &cola->celdas[pos & cola->mascara];
+        size_t secuencia = atomic_load_explicit(&celda->secuencia, memory_order_acquire);
+        intptr_t diferencia = (intptr_t)secuencia - (intptr_t)(pos + 1);
+        if (diferencia == 0) {
+            if (atomic_compare_exchange_weak_explicit(&cola->salida, &pos, pos + 1, memory_order_relaxed, memory_order_relaxed)) {
+                break;
+            }
+        } else if (diferencia < 0) {
+            return 0;
+        } else {
+            pos = atomic_load_explicit(&cola->salida, memory_order_relaxed);
+        }
+    }
+    *dato = celda->dato;
+    atomic_store_explicit(&celda->secuencia, pos + cola->mascara + 1, memory_order_release);
+    return 1;
+}
+
+// Espera escalonada: primero reintenta, luego cede el procesador y por último duerme
+void esperarCola(unsigned *intentos) {
+    if (*intentos < 64) {
+        (*intentos)++;
+    } else if (*intentos < 128) {
+        (*intentos)++;
+        sched_yield();
+    } else {
+        struct timespec pausa = { 0, 50000 };
+        nanosleep(&pausa, NULL);
+    }
+}
+
+void encolar(colaAcotada *cola, void *dato) {
+    unsigned intentos = 0;
+    while (!intentarEncolar(cola, dato)) {
+        esperarCola(&intentos);
+    }
+}
+
+void* desencolar(colaAcotada *cola) {
+    void *dato;
+    unsigned intentos = 0;
+    while (!intentarDesencolar(cola, &dato)) {
+        esperarCola(&intentos);
+    }
+    return dato;
+}
+
+#endif // HILOS_H
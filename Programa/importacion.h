@@ -0,0 +1,704 @@
+#ifndef IMPORTACION_H
+#define IMPORTACION_H
+
+/*****Datos administrativos************************
+ * Nombre del archivo: importacion
+ * Tipo de archivo: C Encabezado
+ * Proyecto: Sistema de Análisis de Datos de Ventas
+ *****Descripción**********************************
+ * Importación en canal: la lectura del archivo, el
+ * análisis del JSON y la incorporación a la lista se
+ * solapan en lugar de ejecutarse una tras otra.
+ *   - Un hilo lector lee el archivo por bloques (ya
+ *     descomprimidos si el archivo es gzip o zstd) y lo
+ *     corta en lotes de elementos completos del arreglo
+ *     principal. En los datos procesados, que son un
+ *     objeto, el arreglo principal es "ventas" y el resto
+ *     del objeto (el mapa de zonas) se guarda aparte.
+ *     Mientras lo corta, el lector acumula la suma de
+ *     control del texto de "ventas" y cuenta sus
+ *     elementos, que al final se comparan con la suma
+ *     guardada después del arreglo y con las filas de
+ *     la cabecera.
+ *   - Varios hilos analizadores parsean cada lote con
+ *     cJSON y lo convierten en ventas.
+ *   - El hilo que llama incorpora los lotes en el orden
+ *     del archivo, codifica nombres y categorías con los
+ *     diccionarios de la lista, actualiza los bosquejos y
+ *     emite los diagnósticos.
+ * Las etapas se comunican con colas acotadas sin
+ * bloqueos (hilos.h), que limitan la memoria en vuelo.
+ **************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <sys/stat.h>
+#include "ventas.h"
+#include "hilos.h"
+
+#define BLOQUE_LECTURA_IMPORTACION (1 << 20)
+#define ELEMENTOS_POR_LOTE 1024
+#define CAPACIDAD_COLAS_IMPORTACION 32
+// Relación típica entre el JSON de ventas y su versión comprimida, para pre-dimensionar la lista
+#define FACTOR_COMPRESION_ESTIMADO 8
+
+/*****Nombre****************************************
+ * struct loteTexto
+ *****Descripción***********************************
+ * Lote de elementos del arreglo principal, copiado
+ * como un arreglo JSON propio: "[e1,e2,...]".
+ *****Campos****************************************
+ * @secuencia: Posición del lote en el archivo.
+ * @primera_linea: Número del primer elemento del lote.
+ * @num_elementos: Cantidad de elementos.
+ * @texto: Texto JSON del lote.
+ * @largo: Bytes usados en `texto`.
+ * @capacidad: Bytes reservados en `texto`.
+ ***************************************************/
+typedef struct {
+    size_t secuencia;
+    int primera_linea;
+    size_t num_elementos;
+    char *texto;
+    size_t largo;
+    size_t capacidad;
+} loteTexto;
+
+/*****Nombre****************************************
+ * struct loteVentas
+ *****Descripción***********************************
+ * Resultado del análisis de un lote.
+ *****Campos****************************************
+ * @secuencia: Posición del lote en el archivo.
+ * @num_elementos: Elementos del lote.
+ * @arreglo: Arreglo JSON del lote; se conserva hasta la
+ *           incorporación para codificar sus cadenas.
+ * @ventas: Ventas convertidas, aún sin codificar.
+ * @items: Objeto JSON de cada venta convertida.
+ * @num_ventas: Cantidad de ventas convertidas.
+ * @lineas_faltantes: Número de cada elemento descartado.
+ * @mascaras_faltantes: Motivo de cada descarte, según validarVenta.
+ * @num_faltantes: Cantidad de elementos descartados.
+ * @error: 1 si el lote no se pudo parsear.
+ ***************************************************/
+typedef struct {
+    size_t secuencia;
+    size_t num_elementos;
+    cJSON *arreglo;
+    Venta *ventas;
+    cJSON **items;
+    size_t num_ventas;
+    int *lineas_faltantes;
+    unsigned int *mascaras_faltantes;
+    size_t num_faltantes;
+    int error;
+} loteVentas;
+
+/*****Nombre****************************************
+ * struct canalImportacion
+ *****Descripción***********************************
+ * Estado compartido por las etapas de la importación.
+ *****Campos****************************************
+ * @archivo: Lector del archivo de entrada.
+ * @textos: Cola del lector hacia los analizadores.
+ * @lotes: Cola de los analizadores hacia la incorporación.
+ * @num_analizadores: Cantidad de hilos analizadores.
+ * @cancelado: Se activa ante un error para abandonar el trabajo pendiente.
+ * @error_lectura: 1 si el archivo no tiene la forma de un arreglo JSON.
+ * @bytes_leidos: Bytes de JSON leídos (descomprimidos).
+ * @cabecera: Objeto principal con "ventas" vacío, si el archivo
+ *            es un objeto; NULL si es un arreglo.
+ * @suma_cuerpo: Suma de control del texto del arreglo "ventas"
+ *               de un objeto (acumularSumaCuerpo).
+ * @filas_leidas: Elementos del arreglo principal.
+ * @cola: Comienzo del texto que sigue al arreglo "ventas".
+ * @largo_cola: Bytes usados en `cola`.
+ ***************************************************/
+typedef struct {
+    lectorArchivo *archivo;
+    colaAcotada *textos;
+    colaAcotada *lotes;
+    int num_analizadores;
+    atomic_int cancelado;
+    int error_lectura;
+    size_t bytes_leidos;
+    loteTexto *cabecera;
+    uint64_t suma_cuerpo;
+    size_t filas_leidas;
+    char cola[256];
+    size_t largo_cola;
+} canalImportacion;
+
+// Agrega `largo` bytes al texto del lote, ampliándolo si hace falta
+int agregarTextoLote(loteTexto *lote, const char *texto, size_t largo) {
+    if (lote->largo + largo + 2 > lote->capacidad) {
+        size_t nueva_capacidad = lote->capacidad * 2;
+        while (lote->largo + largo + 2 > nueva_capacidad) nueva_capacidad *= 2;
+        char *temp = (char *)reallocContado(lote->texto, nueva_capacidad);
+        if (temp == NULL) {
+            return 0;
+        }
+        lote->texto = temp;
+        lote->capacidad = nueva_capacidad;
+    }
+    memcpy(lote->texto + lote->largo, texto, largo);
+    lote->largo += largo;
+    return 1;
+}
+
+loteTexto* crearLoteTexto(size_t secuencia, int primera_linea) {
+    loteTexto *lote = (loteTexto *)mallocContado(sizeof(loteTexto));
+    if (lote == NULL) {
+        return NULL;
+    }
+    lote->secuencia = secuencia;
+    lote->primera_linea = primera_linea;
+    lote->num_elementos = 0;
+    lote->largo = 1;
+    lote->capacidad = 64 * 1024;
+    lote->texto = (char *)mallocContado(lote->capacidad);
+    if (lote->texto == NULL) {
+        free(lote);
+        return NULL;
+    }
+    lote->texto[0] = '[';
+    return lote;
+}
+
+// 1 si el texto termina con la clave "ventas" seguida de ':' (inicio del arreglo de ventas)
+int terminaConClaveVentas(const char *texto, size_t largo) {
+    while (largo > 0 && isspace((unsigned char)texto[largo - 1])) largo--;
+    if (largo == 0 || texto[--largo] != ':') {
+        return 0;
+    }
+    while (largo > 0 && isspace((unsigned char)texto[largo - 1])) largo--;
+    return largo >= 8 && memcmp(texto + largo - 8, "\"ventas\"", 8) == 0;
+}
+
+// Guarda el texto que sigue al arreglo "ventas" mientras quepa en la cola del canal
+void guardarColaDatos(canalImportacion *canal, const char *texto, size_t largo) {
+    size_t libres = sizeof(canal->cola) - 1 - canal->largo_cola;
+    if (largo > libres) {
+        largo = libres;
+    }
+    memcpy(canal->cola + canal->largo_cola, texto, largo);
+    canal->largo_cola += largo;
+    canal->cola[canal->largo_cola] = '\0';
+}
+
+void liberarLoteVentas(loteVentas *lote) {
+    if (lote == NULL) {
+        return;
+    }
+    cJSON_Delete(lote->arreglo);
+    free(lote->ventas);
+    free(lote->items);
+    free(lote->lineas_faltantes);
+    free(lote->mascaras_faltantes);
+    free(lote);
+}
+
+/*****Nombre***************************************
+ * Función leerLotes
+ *****Descripción**********************************
+ * Hilo lector. Recorre el archivo por bloques con una
+ * máquina de estados que sigue la profundidad y las
+ * cadenas para encontrar dónde empieza y termina cada
+ * elemento del arreglo principal, y encola lotes de
+ * hasta ELEMENTOS_POR_LOTE elementos. Si el archivo es
+ * un objeto, copia su texto en la cabecera del canal
+ * hasta encontrar el arreglo "ventas", acumula la suma
+ * de control del texto del arreglo y sigue leyendo
+ * hasta el final para guardar lo que viene después
+ * (la suma guardada). Al terminar encola un NULL por
+ * analizador.
+ *****Retorno**************************************
+ * @return: NULL.
+ ****Entradas**************************************
+ * @param argumento: Un puntero al `canalImportacion`.
+ **************************************************/
+void* leerLotes(void *argumento) {
+    enum { ANTES_DEL_ARREGLO, EN_CABECERA, ENTRE_ELEMENTOS, EN_ELEMENTO, DESPUES_DEL_ARREGLO };
+    canalImportacion *canal = (canalImportacion *)argumento;
+    char *bloque = (char *)mallocContado(BLOQUE_LECTURA_IMPORTACION);
+    int estado = ANTES_DEL_ARREGLO;
+    int profundidad = 0, en_cadena = 0, escape = 0, escalar = 0;
+    size_t secuencia = 0;
+    int linea = 1;
+    loteTexto *lote = NULL;
+    int error = (bloque == NULL);
+    int en_cuerpo = 0;
+    size_t leidos;
+
+    canal->suma_cuerpo = SUMA_CUERPO_INICIAL;
+    // En un objeto se sigue leyendo después del arreglo para llegar a su suma de control
+    while (!error && (estado != DESPUES_DEL_ARREGLO || canal->cabecera != NULL) && !atomic_load(&canal->cancelado) &&
+           (leidos = leerLector(canal->archivo, bloque, BLOQUE_LECTURA_IMPORTACION)) > 0) {
+        canal->bytes_leidos += leidos;
+        if (estado == DESPUES_DEL_ARREGLO) {
+            guardarColaDatos(canal, bloque, leidos);
+            continue;
+        }
+        size_t inicio = 0;
+        size_t inicio_cuerpo = 0;
+        size_t i;
+
+        for (i = 0; i < leidos && !error && estado != DESPUES_DEL_ARREGLO; i++) {
+            char c = bloque[i];
+            if (estado == ANTES_DEL_ARREGLO) {
+                if (c == '[') {
+                    estado = ENTRE_ELEMENTOS;
+                } else if (c == '{' && (canal->cabecera = crearLoteTexto(0, 0)) != NULL) {
+                    canal->cabecera->texto[0] = '{';
+                    estado = EN_CABECERA;
+                    profundidad = 1;
+                } else if (!isspace((unsigned char)c)) {
+                    error = 1;
+                }
+                continue;
+            }
+
+            if (estado == EN_CABECERA) {
+                loteTexto *cabecera = canal->cabecera;
+                if (!en_cadena && profundidad == 1 && c == '[' && terminaConClaveVentas(cabecera->texto, cabecera->largo)) {
+                    // La cabecera queda como un objeto válido, con "ventas" vacío
+                    if (!agregarTextoLote(cabecera, "[]}", 3)) {
+                        error = 1;
+                    }
+                    cabecera->texto[cabecera->largo] = '\0';
+                    estado = ENTRE_ELEMENTOS;
+                    // La suma de control se acumula desde el '[' del arreglo
+                    en_cuerpo = 1;
+                    inicio_cuerpo = i;
+                    continue;
+                }
+                if (en_cadena) {
+                    if (escape) escape = 0;
+                    else if (c == '\\') escape = 1;
+                    else if (c == '"') en_cadena = 0;
+                } else if (c == '"') {
+                    en_cadena = 1;
+                } else if (c == '{' || c == '[') {
+                    profundidad++;
+                } else if ((c == '}' || c == ']') && --profundidad == 0) {
+                    // El objeto terminó sin un arreglo "ventas"
+                    error = 1;
+                }
+                if (!agregarTextoLote(cabecera, &c, 1)) {
+                    error = 1;
+                }
+                continue;
+            }
+
+            if (estado == ENTRE_ELEMENTOS) {
+                if (isspace((unsigned char)c) || c == ',') {
+                    continue;
+                }
+                if (c == ']') {
+                    estado = DESPUES_DEL_ARREGLO;
+                    continue;
+                }
+                if (lote == NULL && (lote = crearLoteTexto(secuencia, linea)) == NULL) {
+                    error = 1;
+                    break;
+                }
+                if (lote->num_elementos > 0) {
+                    lote->texto[lote->largo++] = ',';
+                }
+                estado = EN_ELEMENTO;
+                inicio = i;
+                profundidad = 0;
+                en_cadena = 0;
+                escape = 0;
+                escalar = (c != '{' && c != '[' && c != '"');
+            }
+
+            // Dentro de un elemento: buscar su final
+            size_t fin = 0;
+            int termina = 0;
+            if (en_cadena) {
+                if (escape) {
+                    escape = 0;
+                } else if (c == '\\') {
+                    escape = 1;
+                } else if (c == '"') {
+                    en_cadena = 0;
+                    if (profundidad == 0) {
+                        termina = 1;
+                        fin = i + 1;
+                    }
+                }
+            } else if (escalar) {
+                if (c == ',' || c == ']' || isspace((unsigned char)c)) {
+                    termina = 1;
+                    fin = i;
+                    if (c == ']') {
+                        estado = DESPUES_DEL_ARREGLO;
+                    }
+                }
+            } else if (c == '"') {
+                en_cadena = 1;
+            } else if (c == '{' || c == '[') {
+                profundidad++;
+            } else if (c == '}' || c == ']') {
+                if (--profundidad == 0) {
+                    termina = 1;
+                    fin = i + 1;
+                }
+            }
+
+            if (termina) {
+                if (!agregarTextoLote(lote, bloque + inicio, fin - inicio)) {
+                    error = 1;
+                    break;
+                }
+                lote->num_elementos++;
+                linea++;
+                if (estado == EN_ELEMENTO) {
+                    estado = ENTRE_ELEMENTOS;
+                }
+                if (lote->num_elementos == ELEMENTOS_POR_LOTE) {
+                    lote->texto[lote->largo++] = ']';
+                    lote->texto[lote->largo] = '\0';
+                    encolar(canal->textos, lote);
+                    lote = NULL;
+                    secuencia++;
+                }
+            }
+        }
+
+        // El elemento en curso continúa en el bloque siguiente
+        if (!error && estado == EN_ELEMENTO && !agregarTextoLote(lote, bloque + inicio, leidos - inicio)) {
+            error = 1;
+        }
+        // Al terminar el arreglo, `i` queda justo después de su ']'
+        if (!error && en_cuerpo) {
+            size_t fin_cuerpo = estado == DESPUES_DEL_ARREGLO ? i : leidos;
+            canal->suma_cuerpo = acumularSumaCuerpo(canal->suma_cuerpo, bloque + inicio_cuerpo, fin_cuerpo - inicio_cuerpo);
+            if (estado == DESPUES_DEL_ARREGLO) {
+                en_cuerpo = 0;
+                guardarColaDatos(canal, bloque + fin_cuerpo, leidos - fin_cuerpo);
+            }
+        }
+    }
+    canal->filas_leidas = (size_t)(linea - 1);
+
+    if (estado != DESPUES_DEL_ARREGLO) {
+        error = 1;
+    }
+    if (error) {
+        canal->error_lectura = 1;
+        atomic_store(&canal->cancelado, 1);
+    }
+    if (lote != NULL) {
+        lote->texto[lote->largo++] = ']';
+        lote->texto[lote->largo] = '\0';
+        encolar(canal->textos, lote);
+    }
+    for (int a = 0; a < canal->num_analizadores; a++) {
+        encolar(canal->textos, NULL);
+    }
+    free(bloque);
+    return NULL;
+}
+
+/*****Nombre***************************************
+ * Función analizarLotes
+ *****Descripción**********************************
+ * Hilo analizador. Parsea cada lote de texto y lo
+ * convierte en ventas, anotando los elementos sin
+ * atributos obligatorios. Al recibir NULL encola un
+ * NULL hacia la incorporación y termina.
+ *****Retorno**************************************
+ * @return: NULL.
+ ****Entradas**************************************
+ * @param argumento: Un puntero al `canalImportacion`.
+ **************************************************/
+void* analizarLotes(void *argumento) {
+    canalImportacion *canal = (canalImportacion *)argumento;
+    loteTexto *texto;
+
+    while ((texto = (loteTexto *)desencolar(canal->textos)) != NULL) {
+        loteVentas *lote = (loteVentas *)callocContado(1, sizeof(loteVentas));
+        if (lote == NULL) {
+            atomic_store(&canal->cancelado, 1);
+            free(texto->texto);
+            free(texto);
+            continue;
+        }
+        lote->secuencia = texto->secuencia;
+        lote->num_elementos = texto->num_elementos;
+
+        cJSON *arreglo = atomic_load(&canal->cancelado) ? NULL : cJSON_Parse(texto->texto);
+        lote->arreglo = arreglo;
+        lote->ventas = (Venta *)mallocContado(sizeof(Venta) * texto->num_elementos);
+        lote->items = (cJSON **)mallocContado(sizeof(cJSON *) * texto->num_elementos);
+        lote->lineas_faltantes = (int *)mallocContado(sizeof(int) * texto->num_elementos);
+        lote->mascaras_faltantes = (unsigned int *)mallocContado(sizeof(unsigned int) * texto->num_elementos);
+        if (arreglo == NULL || lote->ventas == NULL || lote->items == NULL || lote->lineas_faltantes == NULL || lote->mascaras_faltantes == NULL) {
+            lote->error = 1;
+        } else {
+            int linea = texto->primera_linea;
+            cJSON *item = NULL;
+            cJSON_ArrayForEach(item, arreglo) {
+                unsigned int rechazo = validarVenta(item);
+                if (rechazo != 0) {
+                    lote->lineas_faltantes[lote->num_faltantes] = linea;
+                    lote->mascaras_faltantes[lote->num_faltantes++] = rechazo;
+                } else if (ventaEnParticion(item)) {
+                    lote->items[lote->num_ventas] = item;
+                    lote->ventas[lote->num_ventas++] = convertirVenta(item);
+                }
+                linea++;
+            }
+        }
+        free(texto->texto);
+        free(texto);
+        encolar(canal->lotes, lote);
+    }
+
+    encolar(canal->lotes, NULL);
+    return NULL;
+}
+
+/*****Nombre***************************************
+ * Función comprobarCuerpoImportado
+ *****Descripción**********************************
+ * Compara la suma de control y los elementos del
+ * arreglo "ventas" que acumuló el lector con la suma
+ * guardada después del arreglo ("suma_ventas") y con
+ * las filas declaradas en la cabecera.
+ *****Retorno**************************************
+ * @return: 1 si coinciden o la cabecera no declara
+ *          filas (formatos anteriores), 0 si no
+ *          coinciden o falta la suma.
+ ****Entradas**************************************
+ * @param canal: El canal de la importación terminada.
+ * @param cabecera: Objeto principal del archivo.
+ **************************************************/
+int comprobarCuerpoImportado(const canalImportacion *canal, const cJSON *cabecera) {
+    cJSON *filas = cJSON_GetObjectItem(cabecera, "filas");
+    if (!cJSON_IsNumber(filas)) {
+        return 1;
+    }
+
+    char calculada[17];
+    formatearSumaCuerpo(canal->suma_cuerpo, calculada);
+    const char *guardada = strstr(canal->cola, "\"suma_ventas\"");
+    if (guardada != NULL) {
+        guardada = strchr(guardada + 13, '"');
+    }
+    return canal->filas_leidas == (size_t)filas->valuedouble && guardada != NULL &&
+           strncmp(guardada + 1, calculada, 16) == 0 && guardada[17] == '"';
+}
+
+/*****Nombre***************************************
+ * Función importarDatosEnParalelo
+ *****Descripción**********************************
+ * Importa un archivo JSON igual que importarDatos, pero
+ * solapando lectura, análisis e incorporación. En los
+ * datos procesados comprueba además que las ventas
+ * coincidan con su suma de control y con las filas
+ * declaradas (comprobarCuerpoImportado). Si el archivo
+ * no se puede parsear o no coincide, la lista queda
+ * como estaba antes de la importación, con sus
+ * diccionarios y bosquejos.
+ *****Retorno**************************************
+ * @return: 1 si el archivo se importó (o estaba vacío),
+ *          0 si no se pudo leer, parsear o descomprimir,
+ *          o si sus ventas no coinciden con la suma.
+ ****Entradas**************************************
+ * @param lista: Un puntero al struct `listaVentas`.
+ * @param path: Ruta del archivo JSON.
+ * @param hilos: Hilos analizadores, o 0 para el valor por defecto.
+ **************************************************/
+int importarDatosEnParalelo(listaVentas *lista, const char *path, int hilos) {
+    inicioMetrica inicio = metricaInicio();
+    lectorArchivo *archivo = abrirLector(path);
+    if (archivo == NULL) {
+        printf("Error al leer el archivo JSON.\n");
+        return 0;
+    }
+    if (archivo->tipo == COMPRESION_NINGUNA && archivo->disponibles == 0) {
+        printf("El archivo JSON está vacío, no hay datos para importar.\n");
+        cerrarLector(archivo);
+        return 1;
+    }
+
+    // Pre-dimensionar la lista con una estimación a partir del tamaño del archivo
+    struct stat estado_archivo;
+    if (fstat(fileno(archivo->archivo), &estado_archivo) == 0) {
+        long tamano = (long)estado_archivo.st_size;
+        if (archivo->tipo != COMPRESION_NINGUNA) {
+            tamano *= FACTOR_COMPRESION_ESTIMADO;
+        }
+        reservarListaVentas(lista, lista->size + estimarVentasPorTamano(tamano));
+    }
+
+    if (hilos <= 0) {
+        hilos = hilosPorDefecto();
+    }
+    canalImportacion canal;
+    memset(&canal, 0, sizeof(canal));
+    canal.archivo = archivo;
+    canal.num_analizadores = hilos > 1 ? hilos - 1 : 1;
+    if (canal.num_analizadores > MAX_HILOS) {
+        canal.num_analizadores = MAX_HILOS;
+    }
+    atomic_init(&canal.cancelado, 0);
+    canal.textos = crearColaAcotada(CAPACIDAD_COLAS_IMPORTACION);
+    canal.lotes = crearColaAcotada(CAPACIDAD_COLAS_IMPORTACION);
+
+    size_t capacidad_pendientes = 64;
+    loteVentas **pendientes = (loteVentas **)callocContado(capacidad_pendientes, sizeof(loteVentas *));
+    pthread_t lector;
+    pthread_t analizadores[MAX_HILOS];
+    int lanzados = 0;
+    int error = (canal.textos == NULL || canal.lotes == NULL || pendientes == NULL);
+    for (int a = 0; !error && a < canal.num_analizadores; a++) {
+        if (pthread_create(&analizadores[lanzados], NULL, analizarLotes, &canal) == 0) {
+            lanzados++;
+        }
+    }
+    // El lector encola un NULL por cada analizador que realmente se lanzó
+    canal.num_analizadores = lanzados;
+    if (lanzados == 0) {
+        printf("Error al iniciar la importación.\n");
+        liberarColaAcotada(canal.textos);
+        liberarColaAcotada(canal.lotes);
+        free(pendientes);
+        cerrarLector(archivo);
+        return 0;
+    }
+    int lector_activo = (pthread_create(&lector, NULL, leerLotes, &canal) == 0);
+    if (!lector_activo) {
+        printf("Error al iniciar la importación.\n");
+        canal.error_lectura = 1;
+        for (int a = 0; a < lanzados; a++) {
+            encolar(canal.textos, NULL);
+        }
+    }
+
+    // Incorporación: los lotes llegan en cualquier orden y se aplican en el del archivo.
+    // Se recuerda el tamaño de la lista y de los diccionarios para deshacerla si falla
+    size_t size_inicial = lista->size;
+    size_t productos_iniciales = lista->productos.num;
+    size_t categorias_iniciales = lista->categorias.num;
+    size_t siguiente = 0;
+    size_t elementos = 0;
+    int terminados = 0;
+    int sin_memoria = 0;
+    while (terminados < lanzados) {
+        loteVentas *lote = (loteVentas *)desencolar(canal.lotes);
+        if (lote == NULL) {
+            terminados++;
+            continue;
+        }
+        if (error || lote->error) {
+            error = 1;
+            atomic_store(&canal.cancelado, 1);
+            liberarLoteVentas(lote);
+            continue;
+        }
+
+        if (lote->secuencia >= capacidad_pendientes) {
+            size_t nueva_capacidad = capacidad_pendientes;
+            while (lote->secuencia >= nueva_capacidad) nueva_capacidad *= 2;
+            loteVentas **temp = (loteVentas **)reallocContado(pendientes, sizeof(loteVentas *) * nueva_capacidad);
+            if (temp == NULL) {
+                error = 1;
+                atomic_store(&canal.cancelado, 1);
+                liberarLoteVentas(lote);
+                continue;
+            }
+            memset(temp + capacidad_pendientes, 0, sizeof(loteVentas *) * (nueva_capacidad - capacidad_pendientes));
+            pendientes = temp;
+            capacidad_pendientes = nueva_capacidad;
+        }
+        pendientes[lote->secuencia] = lote;
+
+        while (!error && siguiente < capacidad_pendientes && pendientes[siguiente] != NULL) {
+            lote = pendientes[siguiente];
+            pendientes[siguiente++] = NULL;
+            for (size_t f = 0; f < lote->num_faltantes; f++) {
+                reportarVentaRechazada(lote->mascaras_faltantes[f], lote->lineas_faltantes[f]);
+            }
+            for (size_t v = 0; v < lote->num_ventas; v++) {
+                codificarVenta(lista, &lote->ventas[v], lote->items[v]);
+            }
+            if (!agregarVentas(lista, lote->ventas, lote->num_ventas)) {
+                error = 1;
+                sin_memoria = 1;
+                atomic_store(&canal.cancelado, 1);
+            }
+            elementos += lote->num_elementos;
+            liberarLoteVentas(lote);
+        }
+    }
+
+    if (lector_activo) {
+        pthread_join(lector, NULL);
+    }
+    for (int a = 0; a < lanzados; a++) {
+        pthread_join(analizadores[a], NULL);
+    }
+    for (size_t s = siguiente; s < capacidad_pendientes; s++) {
+        liberarLoteVentas(pendientes[s]);
+    }
+    free(pendientes);
+    liberarColaAcotada(canal.textos);
+    liberarColaAcotada(canal.lotes);
+    int error_descompresion = archivo->error;
+    cerrarLector(archivo);
+
+    // Suma de control de las ventas y mapa de zonas guardados con los datos procesados
+    int cuerpo_danado = 0;
+    if (canal.cabecera != NULL) {
+        if (!error && !canal.error_lectura) {
+            cJSON *cabecera = cJSON_Parse(canal.cabecera->texto);
+            if (cabecera != NULL && !comprobarCuerpoImportado(&canal, cabecera)) {
+                cuerpo_danado = 1;
+            } else if (cabecera != NULL) {
+                cargarMapaZonas(lista, cabecera, size_inicial);
+            }
+            cJSON_Delete(cabecera);
+        }
+        free(canal.cabecera->texto);
+        free(canal.cabecera);
+    }
+
+    if (error || canal.error_lectura || cuerpo_danado) {
+        // Deshacer lo incorporado para dejar la lista como estaba, con las cadenas nuevas
+        lista->size = size_inicial;
+        truncarDiccionario(&lista->productos, productos_iniciales);
+        truncarDiccionario(&lista->categorias, categorias_iniciales);
+        lista->generacion++;
+        resumirDiagnosticos();
+        if (sin_memoria) {
+            printf("Error al asignar memoria para las ventas importadas.\n");
+        } else if (cuerpo_danado) {
+            printf("Error: las ventas de %s no coinciden con su suma de control o con las filas declaradas.\n", path);
+        } else if (error_descompresion) {
+            printf("Error al descomprimir el archivo %s: los datos están dañados o incompletos.\n", path);
+        } else {
+            printf("Error al parsear el archivo JSON.\n");
+        }
+        return 0;
+    }
+
+    // Los bosquejos solo se actualizan cuando el archivo se importó completo, porque no se pueden deshacer
+    for (size_t i = size_inicial; i < lista->size; i++) {
+        registrarVentaImportada(lista, &lista->ventas[i]);
+    }
+
+    resumirDiagnosticos();
+    metricaBytesLeidos(ETAPA_IMPORTAR, canal.bytes_leidos);
+    metricaFin(ETAPA_IMPORTAR, inicio, elementos);
+
+    printf("\nDatos importados correctamente.\n");
+    return 1;
+}
+
+#endif // IMPORTACION_H
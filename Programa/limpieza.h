@@ -0,0 +1,586 @@
+#ifndef LIMPIEZA_H
+#define LIMPIEZA_H
+
+/*****Datos administrativos************************
+ * Nombre del archivo: limpieza
+ * Tipo de archivo: C Encabezado
+ * Proyecto: Sistema de Análisis de Datos de Ventas
+ *****Descripción**********************************
+ * Canal de limpieza paralelo. Une la validación, la
+ * eliminación de duplicados, la imputación de cantidad
+ * y precio y el cálculo del total en pocas pasadas
+ * sobre bloques y particiones, repartidas entre hilos:
+ *   1. Por bloque: marca los campos faltantes y asigna
+ *      cada registro a una partición según el hash de
+ *      su venta_id.
+ *   2. Por bloque: distribuye los índices en las
+ *      particiones conservando el orden original.
+ *   3. Por partición: elimina duplicados con una tabla
+ *      hash propia y reúne las estadísticas que necesita
+ *      la imputación (moda, media y precios válidos).
+ *   4. Por bloque: copia los registros conservados ya
+ *      imputados y con su total calculado.
+ * El resultado es el mismo que eliminarDatosDuplicados
+ * seguido de completarDatosConMetodo: se conserva la
+ * primera aparición de cada venta_id y el orden.
+ **************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include "ventas.h"
+#include "hilos.h"
+
+#define BLOQUES_POR_HILO 4
+// Por debajo de esta cantidad de registros no conviene lanzar hilos
+#define UMBRAL_LIMPIEZA_PARALELA 8192
+
+#define ESTADO_FALTA_CANTIDAD 0x01
+#define ESTADO_FALTA_PRECIO 0x02
+#define ESTADO_DUPLICADO 0x04
+#define ESTADO_USAR_MEDIANA 0x08
+
+/*****Nombre****************************************
+ * struct conteoCantidad
+ *****Descripción***********************************
+ * Entrada de la tabla de frecuencias de cantidades
+ * usada para la moda.
+ *****Campos****************************************
+ * @valor: Cantidad.
+ * @conteo: Veces que aparece.
+ * @primero: Índice de su primera aparición, para
+ *           desempatar igual que calcularModa.
+ * @usado: 1 si la entrada está ocupada.
+ ***************************************************/
+typedef struct {
+    int valor;
+    size_t conteo;
+    size_t primero;
+    int usado;
+} conteoCantidad;
+
+typedef struct {
+    conteoCantidad *entradas;
+    size_t capacidad;
+    size_t num_valores;
+} tablaCantidades;
+
+int iniciarTablaCantidades(tablaCantidades *tabla) {
+    tabla->capacidad = 16;
+    tabla->num_valores = 0;
+    tabla->entradas = (conteoCantidad *)callocContado(tabla->capacidad, sizeof(conteoCantidad));
+    return tabla->entradas != NULL;
+}
+
+/*****Nombre***************************************
+ * Función sumarCantidad
+ *****Descripción**********************************
+ * Suma `conteo` apariciones de `valor` vistas por
+ * primera vez en `primero`.
+ *****Retorno**************************************
+ * @return: 1 si se registró, 0 si falló la memoria.
+ ****Entradas**************************************
+ * @param tabla: Tabla de frecuencias.
+ * @param valor: Cantidad.
+ * @param conteo: Apariciones a sumar.
+ * @param primero: Índice de la primera aparición.
+ **************************************************/
+int sumarCantidad(tablaCantidades *tabla, int valor, size_t conteo, size_t primero) {
+    if ((tabla->num_valores + 1) * 2 > tabla->capacidad) {
+        size_t nueva_capacidad = tabla->capacidad * 2;
+        conteoCantidad *nuevas = (conteoCantidad *)callocContado(nueva_capacidad, sizeof(conteoCantidad));
+        if (nuevas == NULL) {
+            return 0;
+        }
+        for (size_t i = 0; i < tabla->capacidad; i++) {
+            if (tabla->entradas[i].usado) {
+                size_t pos = mezclar64((uint32_t)tabla->entradas[i].valor) & (nueva_capacidad - 1);
+                while (nuevas[pos].usado) pos = (pos + 1) & (nueva_capacidad - 1);
+                nuevas[pos] = tabla->entradas[i];
+            }
+        }
+        free(tabla->entradas);
+        tabla->entradas = nuevas;
+        tabla->capacidad = nueva_capacidad;
+    }
+
+    size_t mascara = tabla->capacidad - 1;
+    size_t pos = mezclar64((uint32_t)valor) & mascara;
+    while (tabla->entradas[pos].usado && tabla->entradas[pos].valor != valor) {
+        pos = (pos + 1) & mascara;
+    }
+    conteoCantidad *entrada = &tabla->entradas[pos];
+    if (!entrada->usado) {
+        entrada->usado = 1;
+        entrada->valor = valor;
+        entrada->conteo = 0;
+        entrada->primero = primero;
+        tabla->num_valores++;
+    }
+    entrada->conteo += conteo;
+    if (primero < entrada->primero) entrada->primero = primero;
+    return 1;
+}
+
+/*****Nombre****************************************
+ * struct particionLimpieza
+ *****Descripción***********************************
+ * Resultado de la eliminación de duplicados de una
+ * partición de identificadores.
+ *****Campos****************************************
+ * @duplicados: Registros marcados como duplicados.
+ * @sondeos: Comparaciones hechas en la tabla hash.
+ * @faltan_cantidad: Registros conservados sin cantidad.
+ * @faltan_precio: Registros conservados sin precio.
+ * @cantidades: Frecuencias de cantidades válidas.
+ * @precios: Precios válidos de los registros conservados.
+ * @num_precios: Cantidad de precios válidos.
+ * @suma_precios: Suma de los precios válidos.
+ * @error: 1 si falló una asignación de memoria.
+ ***************************************************/
+typedef struct {
+    size_t duplicados;
+    size_t sondeos;
+    size_t faltan_cantidad;
+    size_t faltan_precio;
+    tablaCantidades cantidades;
+    dinero *precios;
+    size_t num_precios;
+    dinero suma_precios;
+    int error;
+} particionLimpieza;
+
+/*****Nombre****************************************
+ * struct contextoLimpieza
+ *****Descripción***********************************
+ * Estado compartido por las etapas del canal.
+ *****Campos****************************************
+ * @ventas: Registros de entrada.
+ * @size: Cantidad de registros.
+ * @estado: Marcas ESTADO_* por registro.
+ * @particion: Partición de cada registro.
+ * @bits_particion: log2 de la cantidad de particiones.
+ * @num_particiones: Cantidad de particiones.
+ * @tam_bloque: Registros por bloque.
+ * @num_bloques: Cantidad de bloques.
+ * @posiciones: Posición de escritura de cada par
+ *              (bloque, partición) en `indices`.
+ * @inicio_particion: Primer índice de cada partición.
+ * @indices: Índices de registros agrupados por partición.
+ * @particiones: Resultado por partición.
+ * @salida_bloque: Primera posición de salida de cada bloque.
+ * @destino: Arreglo de registros limpios.
+ * @moda: Cantidad usada para imputar.
+ * @media: Precio medio usado para imputar.
+ * @mediana: Precio mediano usado para imputar.
+ ***************************************************/
+typedef struct {
+    Venta *ventas;
+    size_t size;
+    unsigned char *estado;
+    uint16_t *particion;
+    int bits_particion;
+    size_t num_particiones;
+    size_t tam_bloque;
+    size_t num_bloques;
+    size_t *posiciones;
+    size_t *inicio_particion;
+    size_t *indices;
+    particionLimpieza *particiones;
+    size_t *salida_bloque;
+    Venta *destino;
+    int moda;
+    dinero media;
+    dinero mediana;
+} contextoLimpieza;
+
+// Etapa 1: marca faltantes y cuenta registros por (bloque, partición)
+void marcarBloque(void *argumento, size_t bloque) {
+    contextoLimpieza *ctx = (contextoLimpieza *)argumento;
+    size_t desde = bloque * ctx->tam_bloque;
+    size_t hasta = desde + ctx->tam_bloque < ctx->size ? desde + ctx->tam_bloque : ctx->size;
+    size_t *conteo = &ctx->posiciones[bloque * ctx->num_particiones];
+    int desplazamiento = 64 - ctx->bits_particion;
+
+    for (size_t i = desde; i < hasta; i++) {
+        Venta *venta = &ctx->ventas[i];
+        ctx->estado[i] = (unsigned char)((venta->cantidad <= 0) * ESTADO_FALTA_CANTIDAD |
+                                         (venta->precio_unitario <= 0) * ESTADO_FALTA_PRECIO);
+        uint16_t p = (uint16_t)(mezclar64((uint32_t)venta->venta_id) >> desplazamiento);
+        ctx->particion[i] = p;
+        conteo[p]++;
+    }
+}
+
+// Etapa 2: distribuye los índices del bloque en sus particiones
+void distribuirBloque(void *argumento, size_t bloque) {
+    contextoLimpieza *ctx = (contextoLimpieza *)argumento;
+    size_t desde = bloque * ctx->tam_bloque;
+    size_t hasta = desde + ctx->tam_bloque < ctx->size ? desde + ctx->tam_bloque : ctx->size;
+    size_t *posicion = &ctx->posiciones[bloque * ctx->num_particiones];
+
+    for (size_t i = desde; i < hasta; i++) {
+        ctx->indices[posicion[ctx->particion[i]]++] = i;
+    }
+}
+
+// Etapa 3: elimina duplicados de la partición y reúne las estadísticas de imputación
+void depurarParticion(void *argumento, size_t p) {
+    contextoLimpieza *ctx = (contextoLimpieza *)argumento;
+    particionLimpieza *resultado = &ctx->particiones[p];
+    size_t desde = ctx->inicio_particion[p];
+    size_t cantidad = ctx->inicio_particion[p + 1] - desde;
+    if (cantidad == 0) {
+        return;
+    }
+
+    size_t capacidad = 16;
+    while (capacidad < cantidad * 2) capacidad *= 2;
+    size_t mascara = capacidad - 1;
+    size_t *tabla = (size_t *)callocContado(capacidad, sizeof(size_t));
+    resultado->precios = (dinero *)mallocContado(sizeof(dinero) * cantidad);
+    if (tabla == NULL || resultado->precios == NULL || !iniciarTablaCantidades(&resultado->cantidades)) {
+        free(tabla);
+        resultado->error = 1;
+        return;
+    }
+
+    for (size_t k = desde; k < desde + cantidad; k++) {
+        size_t i = ctx->indices[k];
+        Venta *venta = &ctx->ventas[i];
+        size_t pos = mezclar64((uint32_t)venta->venta_id) & mascara;
+        while (tabla[pos] != 0) {
+            resultado->sondeos++;
+            if (ctx->ventas[tabla[pos] - 1].venta_id == venta->venta_id) {
+                break;
+            }
+            pos = (pos + 1) & mascara;
+        }
+
+        if (tabla[pos] != 0) {
+            ctx->estado[i] |= ESTADO_DUPLICADO;
+            resultado->duplicados++;
+            continue;
+        }
+        tabla[pos] = i + 1;
+
+        unsigned char estado = ctx->estado[i];
+        if (estado & ESTADO_FALTA_CANTIDAD) {
+            resultado->faltan_cantidad++;
+        } else if (!sumarCantidad(&resultado->cantidades, venta->cantidad, 1, i)) {
+            resultado->error = 1;
+        }
+        resultado->faltan_precio += (estado & ESTADO_FALTA_PRECIO) != 0;
+        resultado->precios[resultado->num_precios] = venta->precio_unitario;
+        resultado->num_precios += (estado & ESTADO_FALTA_PRECIO) == 0;
+        resultado->suma_precios += (estado & ESTADO_FALTA_PRECIO) ? 0 : venta->precio_unitario;
+    }
+    free(tabla);
+}
+
+// Cuenta los registros que conserva un bloque
+void contarBloque(void *argumento, size_t bloque) {
+    contextoLimpieza *ctx = (contextoLimpieza *)argumento;
+    size_t desde = bloque * ctx->tam_bloque;
+    size_t hasta = desde + ctx->tam_bloque < ctx->size ? desde + ctx->tam_bloque : ctx->size;
+    size_t conservados = 0;
+    for (size_t i = desde; i < hasta; i++) {
+        conservados += (ctx->estado[i] & ESTADO_DUPLICADO) == 0;
+    }
+    ctx->salida_bloque[bloque] = conservados;
+}
+
+// Etapa 4: copia los registros conservados, imputados y con su total
+void completarBloque(void *argumento, size_t bloque) {
+    contextoLimpieza *ctx = (contextoLimpieza *)argumento;
+    size_t desde = bloque * ctx->tam_bloque;
+    size_t hasta = desde + ctx->tam_bloque < ctx->size ? desde + ctx->tam_bloque : ctx->size;
+    Venta *salida = &ctx->destino[ctx->salida_bloque[bloque]];
+
+    for (size_t i = desde; i < hasta; i++) {
+        unsigned char estado = ctx->estado[i];
+        Venta venta = ctx->ventas[i];
+        dinero precio_imputado = (estado & ESTADO_USAR_MEDIANA) ? ctx->mediana : ctx->media;
+        venta.cantidad = (estado & ESTADO_FALTA_CANTIDAD) ? ctx->moda : venta.cantidad;
+        venta.precio_unitario = (estado & ESTADO_FALTA_PRECIO) ? precio_imputado : venta.precio_unitario;
+        venta.total = importeVenta(&venta);
+        // La escritura sí se condiciona: el hueco siguiente puede ser de otro bloque
+        if (!(estado & ESTADO_DUPLICADO)) {
+            *salida++ = venta;
+        }
+    }
+}
+
+void liberarContextoLimpieza(contextoLimpieza *ctx) {
+    if (ctx->particiones != NULL) {
+        for (size_t p = 0; p < ctx->num_particiones; p++) {
+            free(ctx->particiones[p].cantidades.entradas);
+            free(ctx->particiones[p].precios);
+        }
+    }
+    free(ctx->particiones);
+    free(ctx->estado);
+    free(ctx->particion);
+    free(ctx->posiciones);
+    free(ctx->inicio_particion);
+    free(ctx->indices);
+    free(ctx->salida_bloque);
+}
+
+// Pide al usuario el método de imputación de precios ('1' media, '2' mediana)
+char pedirMetodoImputacion() {
+    char opcion;
+    printf("  1. Media\n");
+    printf("  2. Mediana\n");
+    printf("  Seleccione una opción: ");
+    scanf(" %c", &opcion);
+    if (opcion != '1' && opcion != '2') {
+        printf("\nOpción inválida. Usando media por defecto.\n");
+        opcion = '1';
+    }
+    return opcion;
+}
+
+/*****Nombre***************************************
+ * Función limpiarDatos
+ *****Descripción**********************************
+ * Elimina duplicados y completa los datos faltantes en
+ * un solo canal paralelo. Si `metodo` no es '1' (media)
+ * ni '2' (mediana), el método se pregunta por registro,
+ * o una sola vez en modo silencioso. Si falta memoria
+ * para el canal o no cabe en el presupuesto de memoria
+ * (externo.h), se usan las etapas secuenciales, cuya
+ * eliminación de duplicados puede trabajar en disco.
+ *****Retorno**************************************
+ *
+ ****Entradas**************************************
+ * @param lista: Un puntero al struct `listaVentas`.
+ * @param metodo: Método de imputación de precios, o '\0' para preguntar.
+ * @param hilos: Cantidad de hilos, o 0 para el valor por defecto.
+ **************************************************/
+void limpiarDatos(listaVentas *lista, char metodo, int hilos) {
+    if (lista == NULL || lista->size == 0) {
+        return;
+    }
+
+    inicioMetrica inicio = metricaInicio();
+    size_t filas = lista->size;
+    if (hilos <= 0) {
+        hilos = hilosPorDefecto();
+    }
+    if (hilos > MAX_HILOS) {
+        hilos = MAX_HILOS;
+    }
+    if (filas < UMBRAL_LIMPIEZA_PARALELA) {
+        hilos = 1;
+    }
+
+    contextoLimpieza ctx;
+    memset(&ctx, 0, sizeof(ctx));
+    ctx.ventas = lista->ventas;
+    ctx.size = filas;
+    ctx.bits_particion = 1;
+    while ((1 << ctx.bits_particion) < hilos * BLOQUES_POR_HILO) ctx.bits_particion++;
+    ctx.num_particiones = (size_t)1 << ctx.bits_particion;
+    ctx.num_bloques = (size_t)hilos * BLOQUES_POR_HILO;
+    ctx.tam_bloque = (filas + ctx.num_bloques - 1) / ctx.num_bloques;
+    ctx.num_bloques = (filas + ctx.tam_bloque - 1) / ctx.tam_bloque;
+
+    // Marcas, particiones, índices, precios y salida por registro, más las tablas hash de las particiones en curso
+    size_t memoria_canal = filas * (sizeof(unsigned char) + sizeof(uint16_t) + sizeof(size_t) + sizeof(dinero) + sizeof(Venta)) +
+                           2 * sizeof(size_t) * (filas / ctx.num_particiones + 1) * (size_t)hilos;
+    if (!cabeEnPresupuesto(memoria_canal)) {
+        printf("La limpieza paralela excede el presupuesto de memoria; se usan las etapas secuenciales.\n");
+        eliminarDatosDuplicados(lista);
+        completarDatosConMetodo(lista, metodo);
+        return;
+    }
+
+    ctx.estado = (unsigned char *)mallocContado(filas);
+    ctx.particion = (uint16_t *)mallocContado(sizeof(uint16_t) * filas);
+    ctx.posiciones = (size_t *)callocContado(ctx.num_bloques * ctx.num_particiones, sizeof(size_t));
+    ctx.inicio_particion = (size_t *)mallocContado(sizeof(size_t) * (ctx.num_particiones + 1));
+    ctx.indices = (size_t *)mallocContado(sizeof(size_t) * filas);
+    ctx.particiones = (particionLimpieza *)callocContado(ctx.num_particiones, sizeof(particionLimpieza));
+    ctx.salida_bloque = (size_t *)mallocContado(sizeof(size_t) * ctx.num_bloques);
+    if (ctx.estado == NULL || ctx.particion == NULL || ctx.posiciones == NULL || ctx.inicio_particion == NULL ||
+        ctx.indices == NULL || ctx.particiones == NULL || ctx.salida_bloque == NULL) {
+        printf("Memoria insuficiente para la limpieza paralela; se usan las etapas secuenciales.\n");
+        liberarContextoLimpieza(&ctx);
+        eliminarDatosDuplicados(lista);
+        completarDatosConMetodo(lista, metodo);
+        return;
+    }
+
+    ejecutarTareas(hilos, marcarBloque, &ctx, ctx.num_bloques);
+
+    // Las particiones quedan contiguas y, dentro de cada una, los bloques en orden
+    size_t posicion = 0;
+    for (size_t p = 0; p < ctx.num_particiones; p++) {
+        ctx.inicio_particion[p] = posicion;
+        for (size_t b = 0; b < ctx.num_bloques; b++) {
+            size_t conteo = ctx.posiciones[b * ctx.num_particiones + p];
+            ctx.posiciones[b * ctx.num_particiones + p] = posicion;
+            posicion += conteo;
+        }
+    }
+    ctx.inicio_particion[ctx.num_particiones] = posicion;
+
+    ejecutarTareas(hilos, distribuirBloque, &ctx, ctx.num_bloques);
+    ejecutarTareas(hilos, depurarParticion, &ctx, ctx.num_particiones);
+
+    // Reunir los resultados de las particiones
+    size_t duplicados = 0, sondeos = 0, faltan_cantidad = 0, faltan_precio = 0, num_precios = 0;
+    dinero suma_precios = 0;
+    int error = 0;
+    tablaCantidades cantidades;
+    error |= !iniciarTablaCantidades(&cantidades);
+    for (size_t p = 0; p < ctx.num_particiones; p++) {
+        particionLimpieza *resultado = &ctx.particiones[p];
+        error |= resultado->error;
+        duplicados += resultado->duplicados;
+        sondeos += resultado->sondeos;
+        faltan_cantidad += resultado->faltan_cantidad;
+        faltan_precio += resultado->faltan_precio;
+        num_precios += resultado->num_precios;
+        suma_precios += resultado->suma_precios;
+        for (size_t e = 0; !error && resultado->cantidades.entradas != NULL && e < resultado->cantidades.capacidad; e++) {
+            conteoCantidad *entrada = &resultado->cantidades.entradas[e];
+            if (entrada->usado && !sumarCantidad(&cantidades, entrada->valor, entrada->conteo, entrada->primero)) {
+                error = 1;
+            }
+        }
+    }
+    if (error) {
+        printf("Error al asignar memoria durante la limpieza.\n");
+        free(cantidades.entradas);
+        liberarContextoLimpieza(&ctx);
+        return;
+    }
+
+    // Los diagnósticos se emiten en el orden original de los registros
+    printf("\n");
+    if (diagnosticoRequiereDetalle(DIAG_DUPLICADO)) {
+        for (size_t i = 0; i < filas; i++) {
+            if (ctx.estado[i] & ESTADO_DUPLICADO) {
+                registrarDiagnostico(DIAG_DUPLICADO, "Se eliminó el registro duplicado con venta ID %d", ctx.ventas[i].venta_id);
+            }
+        }
+    } else {
+        contarDiagnosticos(DIAG_DUPLICADO, duplicados);
+    }
+    resumirDiagnosticos();
+
+    // Moda: mayor frecuencia y, en empate, el valor que aparece primero
+    ctx.moda = 0;
+    size_t mejor_conteo = 0, mejor_primero = 0;
+    for (size_t e = 0; e < cantidades.capacidad; e++) {
+        conteoCantidad *entrada = &cantidades.entradas[e];
+        if (entrada->usado && (entrada->conteo > mejor_conteo ||
+                               (entrada->conteo == mejor_conteo && entrada->primero < mejor_primero))) {
+            ctx.moda = entrada->valor;
+            mejor_conteo = entrada->conteo;
+            mejor_primero = entrada->primero;
+        }
+    }
+    free(cantidades.entradas);
+    ctx.media = dividirDinero(suma_precios, (int64_t)num_precios);
+
+    // Resolver el método de cada precio faltante antes de la etapa paralela
+    int usa_mediana = (metodo == '2');
+    if (faltan_precio > 0 && metodo != '1' && metodo != '2') {
+        if (diagnosticosSilenciosos()) {
+            printf("\n%zu registros con precio unitario faltante. Seleccione el método de imputación:\n", faltan_precio);
+            metodo = pedirMetodoImputacion();
+            usa_mediana = (metodo == '2');
+        } else {
+            for (size_t i = 0; i < filas; i++) {
+                if ((ctx.estado[i] & (ESTADO_FALTA_PRECIO | ESTADO_DUPLICADO)) == ESTADO_FALTA_PRECIO) {
+                    printf("\nRegistro %d: Precio unitario faltante. Seleccione el método de imputación:\n", ctx.ventas[i].venta_id);
+                    if (pedirMetodoImputacion() == '2') {
+                        ctx.estado[i] |= ESTADO_USAR_MEDIANA;
+                        usa_mediana = 1;
+                    }
+                }
+            }
+        }
+    }
+    if (metodo == '2') {
+        for (size_t i = 0; i < filas; i++) {
+            ctx.estado[i] |= (ctx.estado[i] & ESTADO_FALTA_PRECIO) ? ESTADO_USAR_MEDIANA : 0;
+        }
+    }
+
+    if (usa_mediana) {
+        // En modo aproximado la mediana sale del t-digest, sin reunir los precios
+        if (lista->bosquejos != NULL && lista->bosquejos->precios.peso_total + lista->bosquejos->precios.num_buffer > 0) {
+            ctx.mediana = dineroDesdeDouble(cuantilTDigest(&lista->bosquejos->precios, 0.5));
+        } else {
+            dinero *precios = (dinero *)mallocContado(sizeof(dinero) * (num_precios > 0 ? num_precios : 1));
+            if (precios == NULL) {
+                printf("Error al asignar memoria para la mediana; se usa la media.\n");
+                ctx.mediana = ctx.media;
+            } else {
+                size_t k = 0;
+                for (size_t p = 0; p < ctx.num_particiones; p++) {
+                    if (ctx.particiones[p].num_precios > 0) {
+                        memcpy(precios + k, ctx.particiones[p].precios, sizeof(dinero) * ctx.particiones[p].num_precios);
+                        k += ctx.particiones[p].num_precios;
+                    }
+                }
+                ctx.mediana = calcularMediana(precios, num_precios);
+                free(precios);
+            }
+        }
+    }
+
+    size_t conservados = filas - duplicados;
+    ctx.destino = (Venta *)mallocContado(sizeof(Venta) * (conservados > 0 ? conservados : 1));
+    if (ctx.destino == NULL) {
+        printf("Error al asignar memoria durante la limpieza.\n");
+        liberarContextoLimpieza(&ctx);
+        return;
+    }
+    ejecutarTareas(hilos, contarBloque, &ctx, ctx.num_bloques);
+    size_t salida = 0;
+    for (size_t b = 0; b < ctx.num_bloques; b++) {
+        size_t conteo = ctx.salida_bloque[b];
+        ctx.salida_bloque[b] = salida;
+        salida += conteo;
+    }
+    ejecutarTareas(hilos, completarBloque, &ctx, ctx.num_bloques);
+
+    if (diagnosticoRequiereDetalle(DIAG_CANTIDAD_IMPUTADA) || diagnosticoRequiereDetalle(DIAG_PRECIO_IMPUTADO)) {
+        for (size_t i = 0, j = 0; i < filas; i++) {
+            unsigned char estado = ctx.estado[i];
+            if (estado & ESTADO_DUPLICADO) {
+                continue;
+            }
+            if (estado & ESTADO_FALTA_CANTIDAD) {
+                registrarDiagnostico(DIAG_CANTIDAD_IMPUTADA, "Registro %d: cantidad reemplazada por moda %d", ctx.destino[j].venta_id, ctx.moda);
+            }
+            if (estado & ESTADO_FALTA_PRECIO) {
+                registrarDiagnostico(DIAG_PRECIO_IMPUTADO, "Registro %d: precio unitario reemplazado por %s %.2f", ctx.destino[j].venta_id,
+                                     (estado & ESTADO_USAR_MEDIANA) ? "mediana" : "media", dineroADouble(ctx.destino[j].precio_unitario));
+            }
+            j++;
+        }
+    } else {
+        contarDiagnosticos(DIAG_CANTIDAD_IMPUTADA, faltan_cantidad);
+        contarDiagnosticos(DIAG_PRECIO_IMPUTADO, faltan_precio);
+    }
+    resumirDiagnosticos();
+
+    free(lista->ventas);
+    lista->ventas = ctx.destino;
+    lista->size = conservados;
+    lista->capacity = conservados > 0 ? conservados : 1;
+    lista->generacion++;
+    liberarContextoLimpieza(&ctx);
+
+    metricaSondeos(ETAPA_LIMPIEZA, sondeos);
+    metricaFin(ETAPA_LIMPIEZA, inicio, filas);
+}
+
+#endif // LIMPIEZA_H
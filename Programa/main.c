@@ -1,7 +1,15 @@
 #include <stdio.h>
 #include <string.h>
 #include <stdlib.h>
+#include <sys/stat.h>
 #include "ventas.h"
+#include "cache_consultas.h"
+#include "estadisticas.h"
+#include "limpieza.h"
+#include "importacion.h"
+#include "consultas.h"
+#include "servidor.h"
+#include "particiones.h"
 
 void mostrarMenu() {
     printf(" _____________________________________________________________ \n");
@@ -26,7 +34,9 @@ void mostrarSubmenuAnalisis() {
     printf("    1.  Total de ventas\n");
     printf("    2.  Total de ventas mensuales\n");
     printf("    3.  Total de ventas anuales\n");
-    printf("    4.  Volver al menu principal\n");
+    printf("    4.  Top de productos\n");
+    printf("    5.  Consultar producto\n");
+    printf("    6.  Volver al menu principal\n");
     printf(" _____________________________________________________________ \n");
     printf("  Seleccione una opción: ");
 }
@@ -44,6 +54,32 @@ void mostrarSubmenuAnalisisTemporal() {
     printf("  Seleccione una opción: ");
 }
 
+void mostrarSubmenuEstadisticas() {
+    printf(" _____________________________________________________________ \n");
+    printf("|                                                             | \n");
+    printf("|                         Estadísticas                        |\n");
+    printf("|_____________________________________________________________|\n\n");
+    printf("    1. Top 5 de categorías con mayores ventas\n");
+    printf("    2. Reporte estadístico de precios y cantidades\n");
+    printf("    3. Resumen aproximado (modo --aproximado)\n");
+    printf("    4. Consulta filtrada\n");
+    printf("    5. Volver al menú principal\n");
+    printf(" _____________________________________________________________ \n");
+    printf("  Seleccione una opción: ");
+}
+
+// Con --aproximado se mantienen bosquejos durante la importación
+static int modo_aproximado = 0;
+static int num_hilos = 0;
+static const char *consulta_directa = NULL;
+static int modo_servidor = 0;
+static const char *socket_servidor = NULL;
+// Con --procesos=N el análisis se reparte entre N procesos sobre los archivos de --entrada
+#define MAX_ARCHIVOS_ENTRADA 32
+static int num_procesos = 0;
+static const char *archivos_entrada[MAX_ARCHIVOS_ENTRADA];
+static size_t num_archivos_entrada = 0;
+
 void leerRutaArchivo(char *path, size_t longitud) {
     printf("Ingrese la ruta del archivo JSON: ");
     fgets(path, longitud, stdin);
@@ -66,17 +102,76 @@ void manejarImportacion(listaVentas *lista) {
     }
     
     leerRutaArchivo(path, longitud);
-    importarDatos(lista, path);
+    importarDatosEnParalelo(lista, path, num_hilos);
     
     free(path);
 }
 
 void manejarProcesamiento(listaVentas *lista) {
-    eliminarDatosDuplicados(lista);
-    completarDatos(lista);
+    limpiarDatos(lista, '\0', num_hilos);
 }
 
-void manejarAnalisis(listaVentas *lista) {
+void mostrarTopProductos(listaVentas *lista, cacheConsultas *cache) {
+    indiceProductos *indice = cacheIndiceProductos(cache, lista);
+    if (indice == NULL || indice->num_productos == 0) {
+        printf("No hay datos de ventas disponibles.\n");
+        return;
+    }
+
+    size_t n;
+    printf("Cantidad de productos a mostrar: ");
+    if (scanf("%zu", &n) != 1 || n == 0) {
+        n = 10;
+    }
+    while (getchar() != '\n');
+
+    ProductoResumen **top = (ProductoResumen **)malloc(sizeof(ProductoResumen *) * n);
+    if (top == NULL) {
+        printf("Error al asignar memoria.\n");
+        return;
+    }
+
+    size_t encontrados = topProductos(indice, n, top);
+    printf("\nTop %zu de %zu productos por ingresos:\n", encontrados, indice->num_productos);
+    for (size_t i = 0; i < encontrados; i++) {
+        printf("%2zu) %6d %-24s %-16s Unidades: %-8ld Ventas: %-6zu Ingresos: %.2f\n", i + 1,
+               top[i]->producto_id, top[i]->producto_nombre, top[i]->categoria,
+               top[i]->unidades, top[i]->transacciones, dineroADouble(top[i]->ingresos));
+    }
+    free(top);
+}
+
+void mostrarProducto(listaVentas *lista, cacheConsultas *cache) {
+    indiceProductos *indice = cacheIndiceProductos(cache, lista);
+    if (indice == NULL) {
+        return;
+    }
+
+    int producto_id;
+    printf("Ingrese el identificador del producto: ");
+    if (scanf("%d", &producto_id) != 1) {
+        producto_id = -1;
+    }
+    while (getchar() != '\n');
+
+    ProductoResumen *producto = buscarProducto(indice, producto_id);
+    if (producto == NULL) {
+        printf("\nNo se encontraron ventas del producto %d.\n", producto_id);
+        return;
+    }
+
+    printf("\nProducto %d: %s\n", producto->producto_id, producto->producto_nombre);
+    printf("Categoría: %s\n", producto->categoria);
+    printf("Unidades vendidas: %ld\n", producto->unidades);
+    printf("Transacciones: %zu\n", producto->transacciones);
+    printf("Ingresos: %.2f\n", dineroADouble(producto->ingresos));
+    printf("Ventas mensuales:\n");
+    for (size_t m = 0; m < producto->num_meses; m++) {
+        printf("  %04d-%02d  - Total: %.2f\n", producto->meses[m].anio_mes / 100, producto->meses[m].anio_mes % 100, dineroADouble(producto->meses[m].total));
+    }
+}
+
+void manejarAnalisis(listaVentas *lista, cacheConsultas *cache) {
     char subOpcion1;
     do {
         mostrarSubmenuAnalisis();
@@ -86,39 +181,39 @@ void manejarAnalisis(listaVentas *lista) {
 
         switch (subOpcion1) {
             case '1': {
-                float total = totalVentas(lista);
-                printf("Total de ventas: %.2f\n", total);
+                dinero total = cacheTotalVentas(cache, lista);
+                printf("Total de ventas: %.2f\n", dineroADouble(total));
                 break;
             }
             case '2': {
                 char **meses_totales;
-                float *totales_mensuales;
+                dinero *totales_mensuales;
                 size_t num_meses;
 
-                totalVentasMensuales(lista, &meses_totales, &totales_mensuales, &num_meses);
+                cacheTotalVentasMensuales(cache, lista, &meses_totales, &totales_mensuales, &num_meses);
                 for (size_t i = 0; i < num_meses; i++) {
-                    printf("%2zu) %-30s - Total: %.2f\n", i + 1, meses_totales[i], totales_mensuales[i]);
-                    free(meses_totales[i]);
+                    printf("%2zu) %-30s - Total: %.2f\n", i + 1, meses_totales[i], dineroADouble(totales_mensuales[i]));
                 }
-                free(meses_totales);
-                free(totales_mensuales);
                 break;
             }
             case '3': {
                 char **años_totales;
-                float *totales_anuales;
+                dinero *totales_anuales;
                 size_t num_años;
 
-                totalVentasAnuales(lista, &años_totales, &totales_anuales, &num_años);
+                cacheTotalVentasAnuales(cache, lista, &años_totales, &totales_anuales, &num_años);
                 for (size_t i = 0; i < num_años; i++) {
-                    printf("%d) %s  		- Total: %.2f\n", i+1, años_totales[i], totales_anuales[i]);
-                    free(años_totales[i]);
+                    printf("%zu) %s  		- Total: %.2f\n", i+1, años_totales[i], dineroADouble(totales_anuales[i]));
                 }
-                free(años_totales);
-                free(totales_anuales);
                 break;
             }
             case '4':
+                mostrarTopProductos(lista, cache);
+                break;
+            case '5':
+                mostrarProducto(lista, cache);
+                break;
+            case '6':
                 printf("Volviendo al menú principal...\n");
                 break;
 
@@ -126,10 +221,10 @@ void manejarAnalisis(listaVentas *lista) {
                 printf("Opción inválida. Por favor, intente nuevamente.\n");
                 break;
         }
-    } while (subOpcion1 != '4');
+    } while (subOpcion1 != '6');
 }
 
-void manejarAnalisisTemporal(listaVentas *lista) {
+void manejarAnalisisTemporal(listaVentas *lista, cacheConsultas *cache) {
     char subOpcion;
     do {
         mostrarSubmenuAnalisisTemporal();
@@ -139,12 +234,12 @@ void manejarAnalisisTemporal(listaVentas *lista) {
 
         switch (subOpcion) {
             case '1': {
-                char *mes_mayor_venta = mesConMayorVenta(lista);
+                const char *mes_mayor_venta = cacheMesConMayorVenta(cache, lista);
                 printf("Mes con mayor venta: %s\n", mes_mayor_venta);
                 break;
             }
             case '2': {
-                char *dia_mas_activo = diaMasActivo(lista);
+                const char *dia_mas_activo = cacheDiaMasActivo(cache, lista);
                 printf("Día de la semana más activo: %s\n", dia_mas_activo);
                 break;
             }
@@ -154,7 +249,7 @@ void manejarAnalisisTemporal(listaVentas *lista) {
                 scanf("%d", &trimestre);
                 printf("Ingrese el año: ");
                 scanf("%d", &anio);
-                float tasa = tasaCrecimientoTrimestral(lista, trimestre, anio);
+                float tasa = cacheTasaCrecimientoTrimestral(cache, lista, trimestre, anio);
                 printf("Tasa de crecimiento/decrecimiento: %.2f%%\n", tasa);
                 break;
             }
@@ -169,14 +264,132 @@ void manejarAnalisisTemporal(listaVentas *lista) {
     } while (subOpcion != '4');
 }
 
+void manejarEstadisticas(listaVentas *lista) {
+    char subOpcion;
+    do {
+        mostrarSubmenuEstadisticas();
+        scanf(" %c", &subOpcion);
+        printf("\n");
+        while (getchar() != '\n');
+
+        switch (subOpcion) {
+            case '1':
+                obtenerTopCategorias(lista);
+                break;
+            case '2':
+                mostrarReporteEstadistico(lista);
+                break;
+            case '3':
+                mostrarReporteAproximado(lista->bosquejos);
+                break;
+            case '4': {
+                char texto[512];
+                printf("Ingrese la consulta (por ejemplo, categoria=Categoría 2;anio=2023;agrupar=mes): ");
+                if (fgets(texto, sizeof(texto), stdin) != NULL) {
+                    texto[strcspn(texto, "\n")] = '\0';
+                    consultarVentas(lista, texto);
+                }
+                break;
+            }
+            case '5':
+                printf("Volviendo al menú principal...\n");
+                break;
+
+            default:
+                printf("Opción inválida. Por favor, intente nuevamente.\n");
+                break;
+        }
+    } while (subOpcion != '5');
+}
+
+// Ejecuta la consulta de --consulta sobre los datos procesados, sin menú
+int ejecutarConsultaDirecta(const char *texto) {
+    listaVentas *lista = crearListaVentas();
+    if (lista == NULL) {
+        return 0;
+    }
+    int importados = importarDatosEnParalelo(lista, "ventas_procesadas.json", num_hilos);
+    if (importados) {
+        consultarVentas(lista, texto);
+    }
+    liberarListaVentas(lista);
+    return importados;
+}
+
+// Carga los datos procesados y los sirve por socket hasta que se detenga el servidor; sin datos válidos no arranca
+int ejecutarModoServidor() {
+    listaVentas *lista = crearListaVentas();
+    if (lista == NULL) {
+        return 0;
+    }
+    if (!importarDatosEnParalelo(lista, "ventas_procesadas.json", num_hilos)) {
+        liberarListaVentas(lista);
+        return 0;
+    }
+    int resultado = ejecutarServidor(lista, socket_servidor, num_hilos);
+    liberarListaVentas(lista);
+    return resultado;
+}
+
+// Analiza los archivos de entrada (por defecto, ventas_procesadas.json) en varios procesos, sin menú
+int ejecutarAnalisisParticionado() {
+    if (num_archivos_entrada == 0) {
+        archivos_entrada[num_archivos_entrada++] = "ventas_procesadas.json";
+    }
+    return analizarEnParticiones(archivos_entrada, num_archivos_entrada, num_procesos, num_hilos, modo_aproximado);
+}
+
+/*****Nombre***************************************
+ * Función revisarDatosProcesados
+ *****Descripción**********************************
+ * Revisa al iniciar solo la cabecera de los datos
+ * procesados, sin importar las ventas. Si la cabecera
+ * no coincide con su suma de control, los datos no se
+ * usan.
+ *****Retorno**************************************
+ * @return: 1 si hay datos procesados para cargar, 0 si
+ *          no existen o están dañados.
+ ****Entradas**************************************
+ * @param path: Ruta de los datos procesados.
+ * @param filas: Recibe las filas declaradas, o 0 si el
+ *               archivo tiene el formato anterior sin suma.
+ **************************************************/
+int revisarDatosProcesados(const char *path, size_t *filas) {
+    struct stat info;
+    *filas = 0;
+    if (stat(path, &info) != 0 || !S_ISREG(info.st_mode)) {
+        return 0;
+    }
+    if (revisarCabeceraDatos(path, filas) == CABECERA_INVALIDA) {
+        printf("Error: la cabecera de %s no coincide con su suma de control; los datos no se cargarán\n", path);
+        printf("y el archivo se reemplazará si se guardan datos nuevos.\n");
+        return 0;
+    }
+    return 1;
+}
+
+// Importa los datos procesados; la importación rechaza las ventas que no coinciden con su suma o con las filas declaradas
+void cargarDatosProcesados(listaVentas *lista, const char *path, size_t filas) {
+    if (filas > 0) {
+        reservarListaVentas(lista, lista->size + filas);
+    }
+    if (!importarDatosEnParalelo(lista, path, num_hilos)) {
+        printf("Los datos de %s no se cargaron; el archivo se reemplazará si se guardan datos nuevos.\n", path);
+    }
+}
+
 void manejarMenuPrincipal() {
     listaVentas *lista = crearListaVentas();
-    char opcion;
-    char *datos_previos = leerArchivo("ventas_procesadas.json");
-    if (datos_previos != NULL) {
-        importarDatos(lista, "ventas_procesadas.json");
-        free(datos_previos);
+    cacheConsultas *cache = crearCacheConsultas();
+    if (modo_aproximado) {
+        lista->bosquejos = crearBosquejosVentas();
     }
+    char opcion;
+
+    // Los datos procesados se importan la primera vez que se elige una opción que los usa, no al iniciar
+    size_t filas_procesadas;
+    int datos_pendientes = revisarDatosProcesados("ventas_procesadas.json", &filas_procesadas);
+    unsigned long generacion_guardada = lista->generacion;
 
     do {
         mostrarMenu();
@@ -184,6 +397,13 @@ void manejarMenuPrincipal() {
         printf("\n");
         while (getchar() != '\n');
 
+        // Salir no necesita las ventas: si no se cargaron ni cambiaron, el archivo queda como está
+        if (datos_pendientes && opcion >= '1' && opcion <= '5') {
+            cargarDatosProcesados(lista, "ventas_procesadas.json", filas_procesadas);
+            generacion_guardada = lista->generacion;
+            datos_pendientes = 0;
+        }
+
         switch (opcion) {
             case '1':
                 manejarImportacion(lista);
@@ -194,19 +414,21 @@ void manejarMenuPrincipal() {
                 break;
 
             case '3':
-                manejarAnalisis(lista);
+                manejarAnalisis(lista, cache);
                 break;
 
             case '4':
-                manejarAnalisisTemporal(lista);
+                manejarAnalisisTemporal(lista, cache);
                 break;
 
             case '5':
-                obtenerTopCategorias(lista);
+                manejarEstadisticas(lista);
                 break;
 
             case '6':
-                guardarDatosProcesados(lista, "ventas_procesadas.json");
+                if (lista->generacion != generacion_guardada) {
+                    guardarDatosProcesados(lista, "ventas_procesadas.json");
+                }
                 printf("Saliendo del programa...\n");
                 break;
 
@@ -216,14 +438,138 @@ void manejarMenuPrincipal() {
 
     } while (opcion != '6');
 
+    liberarCacheConsultas(cache);
     liberarListaVentas(lista);
 }
 
-int main() {
+void mostrarUso(const char *programa) {
+    printf("Uso: %s [--metricas[=archivo]] [--silencioso] [--detalle=N] [--errores=archivo] [--aproximado] [--hilos=N]\n", programa);
+    printf("       [--comprimir=gzip|zstd|ninguna] [--consulta=expresion] [--servidor[=socket]]\n");
+    printf("       [--procesos=N [--entrada=archivo]...] [--memoria=MB]\n");
+    printf("  --metricas[=archivo]  Al salir, escribe un resumen JSON de métricas por etapa\n");
+    printf("                        en el archivo indicado (por defecto, la salida de errores).\n");
+    printf("                        También se activa con la variable de entorno VENTAS_METRICAS.\n");
+    printf("  --silencioso          La importación y la limpieza solo imprimen un resumen por etapa.\n");
+    printf("  --detalle=N           Muestra como máximo N líneas de detalle por tipo y etapa.\n");
+    printf("  --errores=archivo     Escribe el detalle completo por registro en el archivo.\n");
+    printf("  --aproximado          Mantiene bosquejos (HyperLogLog, Count-Min, Space-Saving,\n");
+    printf("                        t-digest) durante la importación para respuestas aproximadas.\n");
+    printf("  --hilos=N             Hilos de la importación, la limpieza y los totales (por defecto,\n");
+    printf("                        VENTAS_HILOS o la cantidad de núcleos). Los totales no dependen\n");
+    printf("                        de la cantidad de hilos.\n");
+    printf("  --comprimir=formato   Escribe ventas_procesadas.json comprimido. Los archivos gzip\n");
+    printf("                        y zstd se detectan y descomprimen al importar.\n");
+    printf("  --consulta=expresion  Ejecuta una consulta sobre ventas_procesadas.json y termina,\n");
+    printf("                        sin mostrar el menú. Ejemplo:\n");
+    printf("                        --consulta=\"desde=2023-01;hasta=2023-06;precio_min=10;agrupar=categoria\"\n");
+    printf("                        Claves: desde, hasta, anio, categoria, producto, precio_min,\n");
+    printf("                        precio_max, cantidad_min, cantidad_max y agrupar (ninguno,\n");
+    printf("                        categoria, producto, mes o anio).\n");
+    printf("  --servidor[=socket]   Carga ventas_procesadas.json una vez y responde los análisis\n");
+    printf("                        por un socket Unix (por defecto, %s), un comando por línea\n", SOCKET_POR_DEFECTO);
+    printf("                        (total, mensual, anual, mes_mayor, dia_activo, crecimiento T AAAA,\n");
+    printf("                        top_categorias, consulta EXPRESION, detener). \"importar RUTA\"\n");
+    printf("                        agrega un archivo en segundo plano sin detener las consultas,\n");
+    printf("                        que ven la última versión publicada (\"estado\" la informa).\n");
+    printf("                        --hilos fija los hilos que atienden clientes.\n");
+    printf("  --procesos=N          Reparte el análisis de los archivos de --entrada entre N procesos\n");
+    printf("                        (por venta_id), combina sus totales parciales y muestra los\n");
+    printf("                        reportes sin el menú. Cada proceso solo guarda en memoria su\n");
+    printf("                        parte de las ventas. Con --aproximado también combina los bosquejos.\n");
+    printf("  --entrada=archivo     Archivo a analizar con --procesos; se puede repetir (por\n");
+    printf("                        defecto, ventas_procesadas.json).\n");
+    printf("  --memoria=MB          Presupuesto de memoria para la eliminación de duplicados y las\n");
+    printf("                        tablas de grupos de las consultas. Lo que no cabe se vuelca a\n");
+    printf("                        archivos temporales y se combina después.\n");
+}
+
+int procesarArgumentos(int argc, char *argv[]) {
+    int silencioso = 0;
+    size_t limite_detalle = DETALLE_ILIMITADO;
+    int limite_indicado = 0;
+    const char *archivo_errores = NULL;
+
+    iniciarMetricasDesdeEntorno();
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--metricas") == 0) {
+            activarMetricas("-");
+        } else if (strncmp(argv[i], "--metricas=", 11) == 0) {
+            activarMetricas(argv[i] + 11);
+        } else if (strcmp(argv[i], "--silencioso") == 0) {
+            silencioso = 1;
+        } else if (strncmp(argv[i], "--detalle=", 10) == 0) {
+            limite_detalle = strtoul(argv[i] + 10, NULL, 10);
+            limite_indicado = 1;
+        } else if (strncmp(argv[i], "--errores=", 10) == 0) {
+            archivo_errores = argv[i] + 10;
+        } else if (strcmp(argv[i], "--aproximado") == 0) {
+            modo_aproximado = 1;
+        } else if (strncmp(argv[i], "--hilos=", 8) == 0) {
+            num_hilos = atoi(argv[i] + 8);
+            configurarHilosReduccion(num_hilos);
+        } else if (strncmp(argv[i], "--comprimir=", 12) == 0) {
+            if (!configurarCompresionSalida(argv[i] + 12)) {
+                return 0;
+            }
+        } else if (strcmp(argv[i], "--servidor") == 0) {
+            modo_servidor = 1;
+        } else if (strncmp(argv[i], "--servidor=", 11) == 0) {
+            modo_servidor = 1;
+            socket_servidor = argv[i] + 11;
+        } else if (strncmp(argv[i], "--consulta=", 11) == 0) {
+            consulta_directa = argv[i] + 11;
+        } else if (strncmp(argv[i], "--procesos=", 11) == 0) {
+            num_procesos = atoi(argv[i] + 11);
+            if (num_procesos < 1 || num_procesos > MAX_PROCESOS) {
+                printf("Error: la cantidad de procesos debe estar entre 1 y %d.\n", MAX_PROCESOS);
+                return 0;
+            }
+        } else if (strncmp(argv[i], "--entrada=", 10) == 0) {
+            if (num_archivos_entrada == MAX_ARCHIVOS_ENTRADA) {
+                printf("Error: se admiten como máximo %d archivos de entrada.\n", MAX_ARCHIVOS_ENTRADA);
+                return 0;
+            }
+            archivos_entrada[num_archivos_entrada++] = argv[i] + 10;
+        } else if (strncmp(argv[i], "--memoria=", 10) == 0) {
+            long megabytes = atol(argv[i] + 10);
+            if (megabytes < 1) {
+                printf("Error: el presupuesto de memoria debe ser de al menos 1 MB.\n");
+                return 0;
+            }
+            configurarPresupuestoMemoria((size_t)megabytes * 1024 * 1024);
+        } else {
+            mostrarUso(argv[0]);
+            return 0;
+        }
+    }
+
+    // En modo silencioso no se imprime detalle salvo que se pida un límite
+    if (silencioso && !limite_indicado) {
+        limite_detalle = 0;
+    }
+    return configurarDiagnosticos(silencioso, limite_detalle, archivo_errores);
+}
+
+int main(int argc, char *argv[]) {
     #ifdef _WIN32
     system("chcp 65001 > nul");
     #endif
 
+    if (!procesarArgumentos(argc, argv)) {
+        return EXIT_FAILURE;
+    }
+
+    if (modo_servidor) {
+        return ejecutarModoServidor() ? 0 : EXIT_FAILURE;
+    }
+    if (num_procesos > 0) {
+        return ejecutarAnalisisParticionado() ? 0 : EXIT_FAILURE;
+    }
+    if (consulta_directa != NULL) {
+        return ejecutarConsultaDirecta(consulta_directa) ? 0 : EXIT_FAILURE;
+    }
+
     manejarMenuPrincipal();
     
     return 0;
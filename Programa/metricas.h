@@ -0,0 +1,305 @@
+#ifndef METRICAS_H
+#define METRICAS_H
+
+/*****Datos administrativos************************
+ * Nombre del archivo: metricas
+ * Tipo de archivo: C Encabezado
+ * Proyecto: Sistema de Análisis de Datos de Ventas
+ *****Descripción**********************************
+ * Instrumentación liviana por etapa: tiempo de pared,
+ * filas procesadas, bytes leídos/escritos, asignaciones
+ * de memoria y sondeos en tablas de búsqueda. Se activa
+ * con la variable de entorno VENTAS_METRICAS o la opción
+ * --metricas, y al salir vuelca un resumen en JSON al
+ * archivo indicado ("-" para la salida de errores).
+ * Si no está activa, cada punto de medición cuesta una
+ * sola comparación. Los contadores se actualizan con
+ * un candado, porque el servidor mide etapas desde
+ * varios hilos a la vez.
+ * Las asignaciones se cuentan con las envolturas
+ * mallocContado, callocContado, reallocContado y
+ * strdupContado, que usan los módulos del programa, y
+ * con los ganchos de cJSON. Una etapa registra las del
+ * proceso entre su inicio y su fin, incluidas las de
+ * sus hilos.
+ **************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <cjson/cJSON.h>
+#ifndef _WIN32
+#include <sys/resource.h>
+#endif
+
+/*****Nombre****************************************
+ * enum EtapaMetrica
+ *****Descripción***********************************
+ * Etapas instrumentadas del sistema.
+ ***************************************************/
+typedef enum {
+    ETAPA_IMPORTAR,
+    ETAPA_DUPLICADOS,
+    ETAPA_COMPLETAR,
+    ETAPA_TOTAL,
+    ETAPA_MENSUAL,
+    ETAPA_ANUAL,
+    ETAPA_MES_MAYOR,
+    ETAPA_DIA_ACTIVO,
+    ETAPA_TASA_CRECIMIENTO,
+    ETAPA_TOP_CATEGORIAS,
+    ETAPA_GUARDAR,
+    ETAPA_INDICE_PRODUCTOS,
+    ETAPA_ESTADISTICAS,
+    ETAPA_LIMPIEZA,
+    ETAPA_CONSULTA,
+    NUM_ETAPAS
+} EtapaMetrica;
+
+/*****Nombre****************************************
+ * struct MetricaEtapa
+ *****Descripción***********************************
+ * Contadores acumulados de una etapa.
+ *****Campos****************************************
+ * @nombre: Nombre de la etapa en el resumen JSON.
+ * @llamadas: Veces que se ejecutó la etapa.
+ * @segundos: Tiempo de pared acumulado.
+ * @filas: Registros procesados.
+ * @bytes_leidos: Bytes leídos de disco.
+ * @bytes_escritos: Bytes escritos a disco.
+ * @asignaciones: Llamadas a malloc/calloc/realloc/strdup.
+ * @sondeos: Comparaciones hechas al buscar claves.
+ ***************************************************/
+typedef struct {
+    const char *nombre;
+    unsigned long llamadas;
+    double segundos;
+    unsigned long long filas;
+    unsigned long long bytes_leidos;
+    unsigned long long bytes_escritos;
+    unsigned long long asignaciones;
+    unsigned long long sondeos;
+} MetricaEtapa;
+
+/*****Nombre****************************************
+ * struct inicioMetrica
+ *****Descripción***********************************
+ * Estado al comenzar una medición (metricaInicio).
+ *****Campos****************************************
+ * @reloj: Tiempo de pared al inicio.
+ * @asignaciones: Asignaciones del proceso hasta el inicio.
+ ***************************************************/
+typedef struct {
+    double reloj;
+    unsigned long long asignaciones;
+} inicioMetrica;
+
+static MetricaEtapa metricas[NUM_ETAPAS] = {
+    [ETAPA_IMPORTAR] = { .nombre = "importarDatos" },
+    [ETAPA_DUPLICADOS] = { .nombre = "eliminarDatosDuplicados" },
+    [ETAPA_COMPLETAR] = { .nombre = "completarDatos" },
+    [ETAPA_TOTAL] = { .nombre = "totalVentas" },
+    [ETAPA_MENSUAL] = { .nombre = "totalVentasMensuales" },
+    [ETAPA_ANUAL] = { .nombre = "totalVentasAnuales" },
+    [ETAPA_MES_MAYOR] = { .nombre = "mesConMayorVenta" },
+    [ETAPA_DIA_ACTIVO] = { .nombre = "diaMasActivo" },
+    [ETAPA_TASA_CRECIMIENTO] = { .nombre = "tasaCrecimientoTrimestral" },
+    [ETAPA_TOP_CATEGORIAS] = { .nombre = "obtenerTopCategorias" },
+    [ETAPA_GUARDAR] = { .nombre = "guardarDatosProcesados" },
+    [ETAPA_INDICE_PRODUCTOS] = { .nombre = "construirIndiceProductos" },
+    [ETAPA_ESTADISTICAS] = { .nombre = "reporteEstadistico" },
+    [ETAPA_LIMPIEZA] = { .nombre = "limpiarDatos" },
+    [ETAPA_CONSULTA] = { .nombre = "ejecutarConsulta" }
+};
+
+static int metricas_activas = 0;
+static const char *metricas_destino = NULL;
+static pthread_mutex_t candado_metricas = PTHREAD_MUTEX_INITIALIZER;
+// Asignaciones del proceso desde que se activaron las métricas
+static atomic_ullong asignaciones_proceso = 0;
+
+double metricaReloj() {
+#ifdef _WIN32
+    return (double)clock() / CLOCKS_PER_SEC;
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+#endif
+}
+
+/*****Nombre***************************************
+ * Función volcarMetricas
+ *****Descripción**********************************
+ * Escribe el resumen JSON de las métricas acumuladas
+ * en el destino configurado. Se registra con `atexit`.
+ *****Retorno**************************************
+ *
+ ****Entradas**************************************
+ *
+ **************************************************/
+void volcarMetricas() {
+    if (!metricas_activas) {
+        return;
+    }
+
+    FILE *archivo = stderr;
+    if (metricas_destino != NULL && strcmp(metricas_destino, "-") != 0) {
+        archivo = fopen(metricas_destino, "w");
+        if (archivo == NULL) {
+            fprintf(stderr, "Error al abrir el archivo de métricas %s.\n", metricas_destino);
+            return;
+        }
+    }
+
+    long pico_rss = 0;
+#ifndef _WIN32
+    struct rusage uso;
+    getrusage(RUSAGE_SELF, &uso);
+    pico_rss = uso.ru_maxrss;
+#endif
+
+    fprintf(archivo, "{\n  \"pico_rss_kb\": %ld,\n  \"etapas\": [", pico_rss);
+    pthread_mutex_lock(&candado_metricas);
+    int primera = 1;
+    for (int e = 0; e < NUM_ETAPAS; e++) {
+        MetricaEtapa *m = &metricas[e];
+        if (m->llamadas == 0) {
+            continue;
+        }
+        fprintf(archivo, "%s\n    {\"etapa\": \"%s\", \"llamadas\": %lu, \"segundos\": %.9f, \"filas\": %llu, "
+                "\"filas_por_segundo\": %.1f, \"bytes_leidos\": %llu, \"bytes_escritos\": %llu, "
+                "\"asignaciones\": %llu, \"sondeos\": %llu}",
+                primera ? "" : ",", m->nombre, m->llamadas, m->segundos, m->filas,
+                m->segundos > 0 ? m->filas / m->segundos : 0.0, m->bytes_leidos, m->bytes_escritos,
+                m->asignaciones, m->sondeos);
+        primera = 0;
+    }
+    pthread_mutex_unlock(&candado_metricas);
+    fprintf(archivo, "\n  ]\n}\n");
+
+    if (archivo != stderr) {
+        fclose(archivo);
+    }
+}
+
+// Cuenta una asignación si las métricas están activas
+void contarAsignacion() {
+    if (metricas_activas) {
+        atomic_fetch_add_explicit(&asignaciones_proceso, 1, memory_order_relaxed);
+    }
+}
+
+void* mallocContado(size_t tamano) {
+    contarAsignacion();
+    return malloc(tamano);
+}
+
+void* callocContado(size_t cantidad, size_t tamano) {
+    contarAsignacion();
+    return calloc(cantidad, tamano);
+}
+
+void* reallocContado(void *memoria, size_t tamano) {
+    contarAsignacion();
+    return realloc(memoria, tamano);
+}
+
+char* strdupContado(const char *cadena) {
+    contarAsignacion();
+    return strdup(cadena);
+}
+
+/*****Nombre***************************************
+ * Función activarMetricas
+ *****Descripción**********************************
+ * Activa la recolección de métricas, instala los
+ * ganchos que cuentan las asignaciones de cJSON y
+ * registra el volcado del resumen al terminar el
+ * programa. Con los ganchos, cJSON amplía sus textos
+ * con malloc y una copia en lugar de realloc.
+ *****Retorno**************************************
+ *
+ ****Entradas**************************************
+ * @param destino: Archivo donde escribir el resumen JSON,
+ *                 o "-" para la salida de errores.
+ **************************************************/
+void activarMetricas(const char *destino) {
+    metricas_destino = destino;
+    if (!metricas_activas) {
+        cJSON_Hooks ganchos = { mallocContado, free };
+        cJSON_InitHooks(&ganchos);
+        metricas_activas = 1;
+        atexit(volcarMetricas);
+    }
+}
+
+/*****Nombre***************************************
+ * Función iniciarMetricasDesdeEntorno
+ *****Descripción**********************************
+ * Activa las métricas si la variable de entorno
+ * VENTAS_METRICAS está definida; su valor es el destino.
+ *****Retorno**************************************
+ *
+ ****Entradas**************************************
+ *
+ **************************************************/
+void iniciarMetricasDesdeEntorno() {
+    const char *destino = getenv("VENTAS_METRICAS");
+    if (destino != NULL && destino[0] != '\0') {
+        activarMetricas(destino);
+    }
+}
+
+// Inicio de una medición; queda en cero si las métricas están inactivas
+inicioMetrica metricaInicio() {
+    inicioMetrica inicio = { 0.0, 0 };
+    if (metricas_activas) {
+        inicio.reloj = metricaReloj();
+        inicio.asignaciones = atomic_load_explicit(&asignaciones_proceso, memory_order_relaxed);
+    }
+    return inicio;
+}
+
+// Cierre de una medición iniciada con metricaInicio
+void metricaFin(EtapaMetrica etapa, inicioMetrica inicio, size_t filas) {
+    if (metricas_activas) {
+        double segundos = metricaReloj() - inicio.reloj;
+        unsigned long long asignaciones = atomic_load_explicit(&asignaciones_proceso, memory_order_relaxed) - inicio.asignaciones;
+        pthread_mutex_lock(&candado_metricas);
+        metricas[etapa].llamadas++;
+        metricas[etapa].segundos += segundos;
+        metricas[etapa].filas += filas;
+        metricas[etapa].asignaciones += asignaciones;
+        pthread_mutex_unlock(&candado_metricas);
+    }
+}
+
+void metricaBytesLeidos(EtapaMetrica etapa, size_t bytes) {
+    if (metricas_activas) {
+        pthread_mutex_lock(&candado_metricas);
+        metricas[etapa].bytes_leidos += bytes;
+        pthread_mutex_unlock(&candado_metricas);
+    }
+}
+
+void metricaBytesEscritos(EtapaMetrica etapa, size_t bytes) {
+    if (metricas_activas) {
+        pthread_mutex_lock(&candado_metricas);
+        metricas[etapa].bytes_escritos += bytes;
+        pthread_mutex_unlock(&candado_metricas);
+    }
+}
+
+void metricaSondeos(EtapaMetrica etapa, size_t sondeos) {
+    if (metricas_activas) {
+        pthread_mutex_lock(&candado_metricas);
+        metricas[etapa].sondeos += sondeos;
+        pthread_mutex_unlock(&candado_metricas);
+    }
+}
+
+#endif // METRICAS_H
@@ -0,0 +1,771 @@
+#ifndef PARTICIONES_H
+#define PARTICIONES_H
+
+/*****Datos administrativos************************
+ * Nombre del archivo: particiones
+ * Tipo de archivo: C Encabezado
+ * Proyecto: Sistema de Análisis de Datos de Ventas
+ *****Descripción**********************************
+ * Análisis repartido en varios procesos, para historias
+ * que no caben en la memoria de un solo proceso. Cada
+ * proceso hijo importa solo su partición de las ventas
+ * (venta_id módulo la cantidad de procesos) de todos los
+ * archivos de entrada, calcula totales parciales y los
+ * envía al padre por una tubería como un objeto JSON:
+ *   {"filas": N, "total": M, "meses": {"Enero 2023": M, ...},
+ *    "anios": {"2023": M, ...}, "trimestres": {"2023-1": M, ...},
+ *    "categorias": {"Categoría 1": M, ...}, "dias": [7 conteos],
+ *    "bosquejos": {...}}
+ * Los montos van en unidades mínimas de `dinero`, así que
+ * la combinación es exacta. El padre suma los parciales
+ * (y, en modo aproximado, une los bosquejos) y muestra
+ * los mismos reportes del menú. Requiere fork y pipe.
+ **************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "ventas.h"
+#include "importacion.h"
+
+#define MAX_PROCESOS 64
+
+/*****Nombre****************************************
+ * struct totalesPorClave
+ *****Descripción***********************************
+ * Totales acumulados por etiqueta (mes, año, trimestre
+ * o categoría), indexados por el código del diccionario.
+ *****Campos****************************************
+ * @claves: Diccionario de etiquetas.
+ * @totales: Total de cada código.
+ * @capacidad: Capacidad de `totales`.
+ ***************************************************/
+typedef struct {
+    diccionarioCadenas claves;
+    dinero *totales;
+    size_t capacidad;
+} totalesPorClave;
+
+// Suma el monto al total de la clave; devuelve 0 si falla la asignación de memoria
+int acumularTotalPorClave(totalesPorClave *tabla, const char *clave, dinero monto) {
+    codigoCadena codigo = internarCadena(&tabla->claves, clave);
+    if (codigo == CODIGO_INVALIDO) {
+        return 0;
+    }
+    if (codigo >= tabla->capacidad) {
+        size_t nueva_capacidad = tabla->capacidad ? tabla->capacidad * 2 : 32;
+        dinero *totales = (dinero *)reallocContado(tabla->totales, sizeof(dinero) * nueva_capacidad);
+        if (totales == NULL) {
+            printf("Error al asignar memoria para los totales parciales.\n");
+            return 0;
+        }
+        memset(totales + tabla->capacidad, 0, sizeof(dinero) * (nueva_capacidad - tabla->capacidad));
+        tabla->totales = totales;
+        tabla->capacidad = nueva_capacidad;
+    }
+    tabla->totales[codigo] += monto;
+    return 1;
+}
+
+void liberarTotalesPorClave(totalesPorClave *tabla) {
+    liberarDiccionario(&tabla->claves);
+    free(tabla->totales);
+    tabla->totales = NULL;
+    tabla->capacidad = 0;
+}
+
+/*****Nombre****************************************
+ * struct entradaTotal
+ *****Descripción***********************************
+ * Etiqueta y total de un `totalesPorClave`, para ordenar
+ * los reportes.
+ *****Campos****************************************
+ * @clave: Etiqueta (apunta al diccionario).
+ * @total: Total acumulado.
+ * @orden: Posición cronológica (AAAAMM, AAAA o AAAAT).
+ ***************************************************/
+typedef struct {
+    const char *clave;
+    dinero total;
+    long orden;
+} entradaTotal;
+
+int compararEntradasPorOrden(const void *a, const void *b) {
+    const entradaTotal *x = (const entradaTotal *)a;
+    const entradaTotal *y = (const entradaTotal *)b;
+    if (x->orden != y->orden) {
+        return (x->orden > y->orden) - (x->orden < y->orden);
+    }
+    return strcmp(x->clave, y->clave);
+}
+
+int compararEntradasPorTotal(const void *a, const void *b) {
+    const entradaTotal *x = (const entradaTotal *)a;
+    const entradaTotal *y = (const entradaTotal *)b;
+    if (x->total != y->total) {
+        return (x->total < y->total) - (x->total > y->total);
+    }
+    return strcmp(x->clave, y->clave);
+}
+
+// Posición cronológica de una etiqueta "Mes AAAA" de totalVentasMensuales
+long ordenDeMes(const char *etiqueta) {
+    const char *espacio = strrchr(etiqueta, ' ');
+    long anio = (espacio != NULL) ? strtol(espacio + 1, NULL, 10) : 0;
+    for (int m = 0; m < 12; m++) {
+        size_t largo = strlen(nombres_meses[m]);
+        if (strncmp(etiqueta, nombres_meses[m], largo) == 0 && etiqueta[largo] == ' ') {
+            return anio * 100 + m + 1;
+        }
+    }
+    return anio * 100;
+}
+
+// Posición cronológica de una etiqueta "AAAA" o "AAAA-T"
+long ordenDeAnioOTrimestre(const char *etiqueta) {
+    int anio = 0, trimestre = 0;
+    if (sscanf(etiqueta, "%d-%d", &anio, &trimestre) == 2) {
+        return (long)anio * 10 + trimestre;
+    }
+    return anio;
+}
+
+/*****Nombre***************************************
+ * Función listarTotales
+ *****Descripción**********************************
+ * Copia los totales a un arreglo ordenado, por la
+ * posición cronológica (si se indica `orden`) o de
+ * mayor a menor total.
+ *****Retorno**************************************
+ * @return: Arreglo de entradas (el llamador lo libera),
+ *          o NULL si no hay claves o falla la asignación.
+ ****Entradas**************************************
+ * @param tabla: Totales a listar.
+ * @param orden: Función de orden cronológico, o NULL.
+ **************************************************/
+entradaTotal* listarTotales(const totalesPorClave *tabla, long (*orden)(const char *)) {
+    size_t num = tabla->claves.num;
+    entradaTotal *entradas = (num > 0) ? (entradaTotal *)mallocContado(sizeof(entradaTotal) * num) : NULL;
+    if (entradas == NULL) {
+        return NULL;
+    }
+    for (size_t c = 0; c < num; c++) {
+        entradas[c].clave = tabla->claves.cadenas[c];
+        entradas[c].total = tabla->totales[c];
+        entradas[c].orden = (orden != NULL) ? orden(entradas[c].clave) : 0;
+    }
+    qsort(entradas, num, sizeof(entradaTotal), (orden != NULL) ? compararEntradasPorOrden : compararEntradasPorTotal);
+    return entradas;
+}
+
+/*****Nombre****************************************
+ * struct resumenParticiones
+ *****Descripción***********************************
+ * Combinación de los totales parciales de todas las
+ * particiones.
+ *****Campos****************************************
+ * @filas: Ventas importadas entre todas las particiones.
+ * @total: Total de ventas.
+ * @meses: Totales por "Mes AAAA".
+ * @anios: Totales por "AAAA".
+ * @trimestres: Totales por "AAAA-T".
+ * @categorias: Totales por categoría.
+ * @dias: Transacciones por día de la semana (`tm_wday`).
+ * @bosquejos: Unión de los bosquejos (modo aproximado), o NULL.
+ ***************************************************/
+typedef struct {
+    size_t filas;
+    dinero total;
+    totalesPorClave meses;
+    totalesPorClave anios;
+    totalesPorClave trimestres;
+    totalesPorClave categorias;
+    long dias[7];
+    bosquejosVentas *bosquejos;
+} resumenParticiones;
+
+void liberarResumenParticiones(resumenParticiones *resumen) {
+    liberarTotalesPorClave(&resumen->meses);
+    liberarTotalesPorClave(&resumen->anios);
+    liberarTotalesPorClave(&resumen->trimestres);
+    liberarTotalesPorClave(&resumen->categorias);
+    liberarBosquejosVentas(resumen->bosquejos);
+    resumen->bosquejos = NULL;
+}
+
+// Agrega al objeto {etiqueta: monto, ...} con los montos en unidades mínimas
+void agregarTotalesParciales(cJSON *parcial, const char *nombre, char **etiquetas, dinero *totales, size_t num) {
+    cJSON *objeto = cJSON_CreateObject();
+    for (size_t i = 0; i < num; i++) {
+        cJSON_AddNumberToObject(objeto, etiquetas[i], (double)totales[i]);
+    }
+    cJSON_AddItemToObject(parcial, nombre, objeto);
+}
+
+/*****Nombre***************************************
+ * Función bosquejosAJSON
+ *****Descripción**********************************
+ * Serializa los bosquejos para enviarlos al proceso
+ * padre. Los registros HyperLogLog van como texto
+ * hexadecimal y del Count-Min solo las celdas no nulas.
+ *****Retorno**************************************
+ * @return: El objeto JSON, o NULL si falla la asignación.
+ ****Entradas**************************************
+ * @param bosquejos: Un puntero al struct `bosquejosVentas`.
+ **************************************************/
+cJSON* bosquejosAJSON(bosquejosVentas *bosquejos) {
+    cJSON *objeto = cJSON_CreateObject();
+    char *hexadecimal = (char *)mallocContado(HLL_REGISTROS * 2 + 1);
+    if (objeto == NULL || hexadecimal == NULL) {
+        cJSON_Delete(objeto);
+        free(hexadecimal);
+        return NULL;
+    }
+    cJSON_AddNumberToObject(objeto, "filas", (double)bosquejos->filas);
+
+    const hyperLogLog *hll[] = { &bosquejos->ids_venta, &bosquejos->ids_producto };
+    const char *nombres_hll[] = { "ids_venta", "ids_producto" };
+    for (int h = 0; h < 2; h++) {
+        for (size_t i = 0; i < HLL_REGISTROS; i++) {
+            snprintf(hexadecimal + 2 * i, 3, "%02x", hll[h]->registros[i]);
+        }
+        cJSON_AddStringToObject(objeto, nombres_hll[h], hexadecimal);
+    }
+    free(hexadecimal);
+
+    cJSON *celdas = cJSON_AddArrayToObject(objeto, "ingresos_categoria");
+    for (int fila = 0; fila < CM_PROFUNDIDAD; fila++) {
+        for (size_t columna = 0; columna < CM_ANCHO; columna++) {
+            double valor = bosquejos->ingresos_categoria.celdas[fila][columna];
+            if (valor != 0.0) {
+                cJSON *celda = cJSON_CreateArray();
+                cJSON_AddItemToArray(celda, cJSON_CreateNumber((double)(fila * CM_ANCHO + columna)));
+                cJSON_AddItemToArray(celda, cJSON_CreateNumber(valor));
+                cJSON_AddItemToArray(celdas, celda);
+            }
+        }
+    }
+
+    const elementosFrecuentes *frecuentes[] = { &bosquejos->top_categorias, &bosquejos->top_productos };
+    const char *nombres_frecuentes[] = { "top_categorias", "top_productos" };
+    for (int f = 0; f < 2; f++) {
+        cJSON *arreglo = cJSON_AddArrayToObject(objeto, nombres_frecuentes[f]);
+        for (size_t i = 0; i < frecuentes[f]->num; i++) {
+            char clave[17];
+            snprintf(clave, sizeof(clave), "%016llx", (unsigned long long)frecuentes[f]->claves[i]);
+            cJSON *elemento = cJSON_CreateObject();
+            cJSON_AddStringToObject(elemento, "clave", clave);
+            cJSON_AddStringToObject(elemento, "etiqueta", frecuentes[f]->etiquetas[i]);
+            cJSON_AddNumberToObject(elemento, "peso", frecuentes[f]->pesos[i]);
+            cJSON_AddNumberToObject(elemento, "error", frecuentes[f]->errores[i]);
+            cJSON_AddItemToArray(arreglo, elemento);
+        }
+    }
+
+    tDigest *precios = &bosquejos->precios;
+    fusionarTDigest(precios);
+    cJSON *digest = cJSON_CreateObject();
+    cJSON_AddNumberToObject(digest, "minimo", precios->minimo);
+    cJSON_AddNumberToObject(digest, "maximo", precios->maximo);
+    cJSON *centroides = cJSON_AddArrayToObject(digest, "centroides");
+    for (size_t i = 0; i < precios->num_centroides; i++) {
+        cJSON *centroide = cJSON_CreateArray();
+        cJSON_AddItemToArray(centroide, cJSON_CreateNumber(precios->centroides[i].media));
+        cJSON_AddItemToArray(centroide, cJSON_CreateNumber(precios->centroides[i].peso));
+        cJSON_AddItemToArray(centroides, centroide);
+    }
+    cJSON_AddItemToObject(objeto, "precios", digest);
+    return objeto;
+}
+
+/*****Nombre***************************************
+ * Función bosquejosDesdeJSON
+ *****Descripción**********************************
+ * Reconstruye los bosquejos serializados con
+ * bosquejosAJSON. Los campos ausentes o mal formados
+ * quedan vacíos.
+ *****Retorno**************************************
+ * @return: Los bosquejos (el llamador los libera), o NULL
+ *          si falla la asignación de memoria.
+ ****Entradas**************************************
+ * @param objeto: Objeto JSON de los bosquejos.
+ **************************************************/
+bosquejosVentas* bosquejosDesdeJSON(cJSON *objeto) {
+    bosquejosVentas *bosquejos = crearBosquejosVentas();
+    if (bosquejos == NULL) {
+        return NULL;
+    }
+    cJSON *filas = cJSON_GetObjectItem(objeto, "filas");
+    bosquejos->filas = cJSON_IsNumber(filas) ? (size_t)filas->valuedouble : 0;
+
+    hyperLogLog *hll[] = { &bosquejos->ids_venta, &bosquejos->ids_producto };
+    const char *nombres_hll[] = { "ids_venta", "ids_producto" };
+    for (int h = 0; h < 2; h++) {
+        cJSON *registros = cJSON_GetObjectItem(objeto, nombres_hll[h]);
+        if (!cJSON_IsString(registros) || strlen(registros->valuestring) != HLL_REGISTROS * 2) {
+            continue;
+        }
+        for (size_t i = 0; i < HLL_REGISTROS; i++) {
+            char par[3] = { registros->valuestring[2 * i], registros->valuestring[2 * i + 1], '\0' };
+            hll[h]->registros[i] = (uint8_t)strtoul(par, NULL, 16);
+        }
+    }
+
+    cJSON *celda = NULL;
+    cJSON_ArrayForEach(celda, cJSON_GetObjectItem(objeto, "ingresos_categoria")) {
+        cJSON *posicion = cJSON_GetArrayItem(celda, 0);
+        cJSON *valor = cJSON_GetArrayItem(celda, 1);
+        if (cJSON_IsNumber(posicion) && cJSON_IsNumber(valor) && posicion->valueint >= 0 && posicion->valueint < CM_PROFUNDIDAD * CM_ANCHO) {
+            bosquejos->ingresos_categoria.celdas[posicion->valueint / CM_ANCHO][posicion->valueint % CM_ANCHO] = valor->valuedouble;
+        }
+    }
+
+    elementosFrecuentes *frecuentes[] = { &bosquejos->top_categorias, &bosquejos->top_productos };
+    const char *nombres_frecuentes[] = { "top_categorias", "top_productos" };
+    for (int f = 0; f < 2; f++) {
+        cJSON *elemento = NULL;
+        cJSON_ArrayForEach(elemento, cJSON_GetObjectItem(objeto, nombres_frecuentes[f])) {
+            cJSON *clave = cJSON_GetObjectItem(elemento, "clave");
+            cJSON *etiqueta = cJSON_GetObjectItem(elemento, "etiqueta");
+            cJSON *peso = cJSON_GetObjectItem(elemento, "peso");
+            cJSON *error = cJSON_GetObjectItem(elemento, "error");
+            if (cJSON_IsString(clave) && cJSON_IsString(etiqueta) && cJSON_IsNumber(peso) && cJSON_IsNumber(error)) {
+                agregarElementosFrecuentesConError(frecuentes[f], strtoull(clave->valuestring, NULL, 16), etiqueta->valuestring,
+                                                   peso->valuedouble, error->valuedouble);
+            }
+        }
+    }
+
+    cJSON *digest = cJSON_GetObjectItem(objeto, "precios");
+    tDigest *precios = &bosquejos->precios;
+    size_t capacidad = sizeof(precios->centroides) / sizeof(Centroide);
+    cJSON *centroide = NULL;
+    cJSON_ArrayForEach(centroide, cJSON_GetObjectItem(digest, "centroides")) {
+        cJSON *media = cJSON_GetArrayItem(centroide, 0);
+        cJSON *peso = cJSON_GetArrayItem(centroide, 1);
+        if (cJSON_IsNumber(media) && cJSON_IsNumber(peso) && precios->num_centroides < capacidad) {
+            precios->centroides[precios->num_centroides].media = media->valuedouble;
+            precios->centroides[precios->num_centroides].peso = peso->valuedouble;
+            precios->num_centroides++;
+            precios->peso_total += peso->valuedouble;
+        }
+    }
+    if (precios->num_centroides > 0) {
+        precios->minimo = cJSON_GetNumberValue(cJSON_GetObjectItem(digest, "minimo"));
+        precios->maximo = cJSON_GetNumberValue(cJSON_GetObjectItem(digest, "maximo"));
+    }
+    return bosquejos;
+}
+
+/*****Nombre***************************************
+ * Función totalesParcialesAJSON
+ *****Descripción**********************************
+ * Calcula los totales parciales de las ventas de una
+ * partición con las mismas funciones del menú.
+ *****Retorno**************************************
+ * @return: El objeto JSON, o NULL si falla la asignación.
+ ****Entradas**************************************
+ * @param lista: Ventas de la partición.
+ **************************************************/
+cJSON* totalesParcialesAJSON(listaVentas *lista) {
+    cJSON *parcial = cJSON_CreateObject();
+    if (parcial == NULL) {
+        return NULL;
+    }
+    cJSON_AddNumberToObject(parcial, "filas", (double)lista->size);
+    cJSON_AddNumberToObject(parcial, "total", (double)totalVentas(lista));
+
+    char **etiquetas;
+    dinero *totales;
+    size_t num;
+    totalVentasMensuales(lista, &etiquetas, &totales, &num);
+    agregarTotalesParciales(parcial, "meses", etiquetas, totales, num);
+    for (size_t i = 0; i < num; i++) free(etiquetas[i]);
+    free(etiquetas);
+    free(totales);
+
+    totalVentasAnuales(lista, &etiquetas, &totales, &num);
+    agregarTotalesParciales(parcial, "anios", etiquetas, totales, num);
+    for (size_t i = 0; i < num; i++) free(etiquetas[i]);
+    free(etiquetas);
+    free(totales);
+
+    // Totales por trimestre
+    totalesPorClave trimestres = { 0 };
+    for (size_t i = 0; i < lista->size; i++) {
+        int anio_venta = lista->ventas[i].fecha / 10000;
+        int mes_venta = lista->ventas[i].fecha / 100 % 100;
+        char clave[24];
+        snprintf(clave, sizeof(clave), "%d-%d", anio_venta, (mes_venta - 1) / 3 + 1);
+        acumularTotalPorClave(&trimestres, clave, importeVenta(&lista->ventas[i]));
+    }
+    agregarTotalesParciales(parcial, "trimestres", trimestres.claves.cadenas, trimestres.totales, trimestres.claves.num);
+    liberarTotalesPorClave(&trimestres);
+
+    size_t num_categorias = 0;
+    CategoriaVenta *categorias = (lista->size > 0) ? calcularTotalesCategorias(lista, &num_categorias) : NULL;
+    cJSON *objeto = cJSON_CreateObject();
+    for (size_t i = 0; i < num_categorias; i++) {
+        cJSON_AddNumberToObject(objeto, cadenaDeCodigo(&lista->categorias, categorias[i].codigo), (double)categorias[i].totalVentas);
+    }
+    cJSON_AddItemToObject(parcial, "categorias", objeto);
+    free(categorias);
+
+    int dias[7];
+    contarTransaccionesPorDia(lista, dias);
+    cJSON *arreglo = cJSON_AddArrayToObject(parcial, "dias");
+    for (int d = 0; d < 7; d++) {
+        cJSON_AddItemToArray(arreglo, cJSON_CreateNumber(dias[d]));
+    }
+
+    if (lista->bosquejos != NULL) {
+        cJSON *bosquejos = bosquejosAJSON(lista->bosquejos);
+        if (bosquejos != NULL) {
+            cJSON_AddItemToObject(parcial, "bosquejos", bosquejos);
+        }
+    }
+    return parcial;
+}
+
+// Suma al resumen los montos de un objeto {etiqueta: monto, ...}; devuelve 0 si falla
+int combinarTotalesParciales(totalesPorClave *tabla, cJSON *objeto) {
+    cJSON *elemento = NULL;
+    cJSON_ArrayForEach(elemento, objeto) {
+        if (!cJSON_IsNumber(elemento) || elemento->string == NULL ||
+            !acumularTotalPorClave(tabla, elemento->string, (dinero)elemento->valuedouble)) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+/*****Nombre***************************************
+ * Función combinarParcial
+ *****Descripción**********************************
+ * Suma al resumen los totales parciales de una
+ * partición.
+ *****Retorno**************************************
+ * @return: 1 si el parcial estaba completo, 0 si no.
+ ****Entradas**************************************
+ * @param resumen: Resumen acumulado.
+ * @param parcial: Objeto JSON enviado por la partición.
+ **************************************************/
+int combinarParcial(resumenParticiones *resumen, cJSON *parcial) {
+    cJSON *filas = cJSON_GetObjectItem(parcial, "filas");
+    cJSON *total = cJSON_GetObjectItem(parcial, "total");
+    cJSON *dias = cJSON_GetObjectItem(parcial, "dias");
+    if (!cJSON_IsNumber(filas) || !cJSON_IsNumber(total) || !cJSON_IsArray(dias) || cJSON_GetArraySize(dias) != 7) {
+        return 0;
+    }
+    resumen->filas += (size_t)filas->valuedouble;
+    resumen->total += (dinero)total->valuedouble;
+    for (int d = 0; d < 7; d++) {
+        resumen->dias[d] += (long)cJSON_GetNumberValue(cJSON_GetArrayItem(dias, d));
+    }
+
+    if (!combinarTotalesParciales(&resumen->meses, cJSON_GetObjectItem(parcial, "meses")) ||
+        !combinarTotalesParciales(&resumen->anios, cJSON_GetObjectItem(parcial, "anios")) ||
+        !combinarTotalesParciales(&resumen->trimestres, cJSON_GetObjectItem(parcial, "trimestres")) ||
+        !combinarTotalesParciales(&resumen->categorias, cJSON_GetObjectItem(parcial, "categorias"))) {
+        return 0;
+    }
+
+    cJSON *objeto = cJSON_GetObjectItem(parcial, "bosquejos");
+    if (cJSON_IsObject(objeto)) {
+        bosquejosVentas *bosquejos = bosquejosDesdeJSON(objeto);
+        if (bosquejos == NULL) {
+            return 0;
+        }
+        if (resumen->bosquejos == NULL) {
+            resumen->bosquejos = bosquejos;
+        } else {
+            combinarBosquejosVentas(resumen->bosquejos, bosquejos);
+            liberarBosquejosVentas(bosquejos);
+        }
+    }
+    return 1;
+}
+
+/*****Nombre***************************************
+ * Función mostrarResumenParticiones
+ *****Descripción**********************************
+ * Imprime los reportes del menú a partir de los
+ * totales combinados. Los meses y los años se listan
+ * en orden cronológico; la tasa de crecimiento se
+ * calcula para el último trimestre con ventas.
+ *****Retorno**************************************
+ *
+ ****Entradas**************************************
+ * @param resumen: Resumen combinado de las particiones.
+ **************************************************/
+void mostrarResumenParticiones(resumenParticiones *resumen) {
+    printf("Total de ventas: %.2f\n", dineroADouble(resumen->total));
+
+    entradaTotal *meses = listarTotales(&resumen->meses, ordenDeMes);
+    printf("\nTotal de ventas mensuales:\n");
+    for (size_t i = 0; meses != NULL && i < resumen->meses.claves.num; i++) {
+        printf("%2zu) %-30s - Total: %.2f\n", i + 1, meses[i].clave, dineroADouble(meses[i].total));
+    }
+
+    entradaTotal *anios = listarTotales(&resumen->anios, ordenDeAnioOTrimestre);
+    printf("\nTotal de ventas anuales:\n");
+    for (size_t i = 0; anios != NULL && i < resumen->anios.claves.num; i++) {
+        printf("%zu) %s  		- Total: %.2f\n", i + 1, anios[i].clave, dineroADouble(anios[i].total));
+    }
+    free(anios);
+
+    // Mes con mayor venta: el primero, en orden cronológico, con el mayor total
+    printf("\n");
+    if (meses == NULL) {
+        printf("Mes con mayor venta: No se encontraron ventas registradas.\n");
+    } else {
+        size_t mayor = 0;
+        for (size_t i = 1; i < resumen->meses.claves.num; i++) {
+            if (meses[i].total > meses[mayor].total) {
+                mayor = i;
+            }
+        }
+        printf("Mes con mayor venta: %s - Total: %.2f\n", meses[mayor].clave, dineroADouble(meses[mayor].total));
+    }
+    free(meses);
+
+    int dia_mas_activo = 0;
+    for (int d = 1; d < 7; d++) {
+        if (resumen->dias[d] > resumen->dias[dia_mas_activo]) {
+            dia_mas_activo = d;
+        }
+    }
+    printf("Día de la semana más activo: %s - Total de transacciones: %ld\n", nombres_dias[dia_mas_activo], resumen->dias[dia_mas_activo]);
+
+    // Tasa de crecimiento del último trimestre contra el anterior, como tasaCrecimientoTrimestral
+    entradaTotal *trimestres = listarTotales(&resumen->trimestres, ordenDeAnioOTrimestre);
+    if (trimestres != NULL) {
+        entradaTotal *ultimo = &trimestres[resumen->trimestres.claves.num - 1];
+        int anio = (int)(ultimo->orden / 10);
+        int trimestre = (int)(ultimo->orden % 10);
+        char clave_anterior[24];
+        snprintf(clave_anterior, sizeof(clave_anterior), "%d-%d", trimestre == 1 ? anio - 1 : anio, trimestre == 1 ? 4 : trimestre - 1);
+        codigoCadena codigo = buscarCadena(&resumen->trimestres.claves, clave_anterior);
+        dinero anterior = (codigo != CODIGO_INVALIDO) ? resumen->trimestres.totales[codigo] : 0;
+        if (anterior == 0) {
+            printf("No hay datos suficientes para calcular la tasa de crecimiento.\n");
+        } else {
+            double tasa = (double)(ultimo->total - anterior) / anterior * 100.0;
+            printf("Tasa de crecimiento para el trimestre %d del año %d: %.2f%%\n", trimestre, anio, tasa);
+        }
+        free(trimestres);
+    }
+
+    entradaTotal *categorias = listarTotales(&resumen->categorias, NULL);
+    printf("\nTop 5 de categorías con mayores ventas:\n");
+    for (size_t i = 0; categorias != NULL && i < resumen->categorias.claves.num && i < 5; i++) {
+        printf("%zu) %-30s - Total Ventas: %.2f\n", i + 1, categorias[i].clave, dineroADouble(categorias[i].total));
+    }
+    free(categorias);
+
+    if (resumen->bosquejos != NULL) {
+        printf("\n");
+        mostrarReporteAproximado(resumen->bosquejos);
+    }
+}
+
+#ifndef _WIN32
+#include <errno.h>
+#include <unistd.h>
+#include <sys/wait.h>
+
+// Escribe todo el texto en el descriptor; devuelve 0 si falla
+int escribirTodo(int fd, const char *texto, size_t largo) {
+    while (largo > 0) {
+        ssize_t escritos = write(fd, texto, largo);
+        if (escritos < 0 && errno == EINTR) {
+            continue;
+        }
+        if (escritos <= 0) {
+            return 0;
+        }
+        texto += escritos;
+        largo -= (size_t)escritos;
+    }
+    return 1;
+}
+
+// Lee el descriptor hasta el final; devuelve el texto (el llamador lo libera) o NULL
+char* leerTodo(int fd) {
+    size_t capacidad = 65536;
+    size_t largo = 0;
+    char *texto = (char *)mallocContado(capacidad);
+    while (texto != NULL) {
+        if (largo + 1 == capacidad) {
+            char *mayor = (char *)reallocContado(texto, capacidad * 2);
+            if (mayor == NULL) {
+                free(texto);
+                return NULL;
+            }
+            texto = mayor;
+            capacidad *= 2;
+        }
+        ssize_t leidos = read(fd, texto + largo, capacidad - largo - 1);
+        if (leidos < 0 && errno == EINTR) {
+            continue;
+        }
+        if (leidos < 0) {
+            free(texto);
+            return NULL;
+        }
+        if (leidos == 0) {
+            texto[largo] = '\0';
+            return texto;
+        }
+        largo += (size_t)leidos;
+    }
+    return NULL;
+}
+
+/*****Nombre***************************************
+ * Función ejecutarParticion
+ *****Descripción**********************************
+ * Cuerpo de un proceso hijo: importa su partición de
+ * los archivos, escribe los totales parciales en la
+ * tubería y termina sin volver al llamador. Sus
+ * mensajes de importación van a la salida de errores.
+ * Si algún archivo no se puede importar, termina con
+ * código 1 sin escribir totales.
+ *****Retorno**************************************
+ *
+ ****Entradas**************************************
+ * @param fd: Extremo de escritura de la tubería.
+ * @param archivos: Rutas de los archivos de entrada.
+ * @param num_archivos: Cantidad de archivos.
+ * @param procesos: Cantidad de particiones.
+ * @param particion: Partición de este proceso.
+ * @param hilos: Hilos de la importación y las reducciones.
+ * @param aproximado: Si se mantienen bosquejos.
+ **************************************************/
+void ejecutarParticion(int fd, const char **archivos, size_t num_archivos, int procesos, int particion, int hilos, int aproximado) {
+    dup2(STDERR_FILENO, STDOUT_FILENO);
+    configurarParticionImportacion((unsigned int)procesos, (unsigned int)particion);
+    configurarHilosReduccion(hilos);
+
+    int correcto = 0;
+    listaVentas *lista = crearListaVentas();
+    if (lista != NULL) {
+        if (aproximado) {
+            lista->bosquejos = crearBosquejosVentas();
+        }
+        // Un archivo que no se pudo importar deja la partición incompleta: no se envían totales
+        correcto = 1;
+        for (size_t a = 0; correcto && a < num_archivos; a++) {
+            correcto = importarDatosEnParalelo(lista, archivos[a], hilos);
+        }
+
+        if (correcto) {
+            cJSON *parcial = totalesParcialesAJSON(lista);
+            char *texto = (parcial != NULL) ? cJSON_PrintUnformatted(parcial) : NULL;
+            correcto = texto != NULL && escribirTodo(fd, texto, strlen(texto));
+            cJSON_free(texto);
+            cJSON_Delete(parcial);
+        }
+        liberarListaVentas(lista);
+    }
+
+    close(fd);
+    fflush(stdout);
+    _exit(correcto ? 0 : 1);
+}
+
+/*****Nombre***************************************
+ * Función analizarEnParticiones
+ *****Descripción**********************************
+ * Reparte el análisis de los archivos entre procesos
+ * hijos, combina sus totales parciales y muestra los
+ * reportes. Cada hijo solo mantiene en memoria su
+ * partición, aunque todos leen todos los archivos.
+ *****Retorno**************************************
+ * @return: 1 si todas las particiones respondieron, 0 si no.
+ ****Entradas**************************************
+ * @param archivos: Rutas de los archivos de entrada.
+ * @param num_archivos: Cantidad de archivos.
+ * @param procesos: Cantidad de procesos (1 a MAX_PROCESOS).
+ * @param hilos: Hilos por proceso; 0 reparte los núcleos entre los procesos.
+ * @param aproximado: Si se mantienen y combinan bosquejos.
+ **************************************************/
+int analizarEnParticiones(const char **archivos, size_t num_archivos, int procesos, int hilos, int aproximado) {
+    if (procesos < 1 || procesos > MAX_PROCESOS) {
+        printf("Error: la cantidad de procesos debe estar entre 1 y %d.\n", MAX_PROCESOS);
+        return 0;
+    }
+    if (hilos <= 0) {
+        hilos = hilosPorDefecto() / procesos;
+        if (hilos < 1) hilos = 1;
+    }
+
+    // Lo pendiente en el buffer de salida no debe repetirse en cada hijo
+    fflush(stdout);
+    fflush(stderr);
+
+    pid_t hijos[MAX_PROCESOS];
+    int tuberias[MAX_PROCESOS];
+    int lanzados = 0;
+    for (int p = 0; p < procesos; p++) {
+        int extremos[2];
+        if (pipe(extremos) != 0) {
+            printf("Error al crear la tubería de la partición %d.\n", p);
+            break;
+        }
+        pid_t hijo = fork();
+        if (hijo < 0) {
+            printf("Error al crear el proceso de la partición %d.\n", p);
+            close(extremos[0]);
+            close(extremos[1]);
+            break;
+        }
+        if (hijo == 0) {
+            close(extremos[0]);
+            for (int anterior = 0; anterior < lanzados; anterior++) {
+                close(tuberias[anterior]);
+            }
+            ejecutarParticion(extremos[1], archivos, num_archivos, procesos, p, hilos, aproximado);
+        }
+        close(extremos[1]);
+        hijos[lanzados] = hijo;
+        tuberias[lanzados] = extremos[0];
+        lanzados++;
+    }
+
+    // Los hijos escriben en paralelo; el padre lee las tuberías en orden
+    resumenParticiones resumen = { 0 };
+    int completo = (lanzados == procesos);
+    for (int p = 0; p < lanzados; p++) {
+        char *texto = leerTodo(tuberias[p]);
+        close(tuberias[p]);
+
+        int estado = 0;
+        while (waitpid(hijos[p], &estado, 0) < 0 && errno == EINTR);
+        cJSON *parcial = (texto != NULL) ? cJSON_Parse(texto) : NULL;
+        if (!WIFEXITED(estado) || WEXITSTATUS(estado) != 0 || parcial == NULL || !combinarParcial(&resumen, parcial)) {
+            printf("Error: la partición %d no devolvió sus totales.\n", p);
+            completo = 0;
+        }
+        cJSON_Delete(parcial);
+        free(texto);
+    }
+
+    if (completo) {
+        printf("Análisis en %d procesos de %zu ventas.\n\n", procesos, resumen.filas);
+        mostrarResumenParticiones(&resumen);
+    }
+    liberarResumenParticiones(&resumen);
+    return completo;
+}
+
+#else
+
+int analizarEnParticiones(const char **archivos, size_t num_archivos, int procesos, int hilos, int aproximado) {
+    printf("El análisis en varios procesos no está disponible en Windows.\n");
+    return 0;
+}
+
+#endif // _WIN32
+
+#endif // PARTICIONES_H
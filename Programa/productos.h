@@ -0,0 +1,364 @@
+#ifndef PRODUCTOS_H
+#define PRODUCTOS_H
+
+/*****Datos administrativos************************
+ * Nombre del archivo: productos
+ * Tipo de archivo: C Encabezado
+ * Proyecto: Sistema de Análisis de Datos de Ventas
+ *****Descripción**********************************
+ * Índice de productos por producto_id. Se construye en
+ * una sola pasada sobre la lista de ventas y guarda, por
+ * producto, su nombre, su categoría, las unidades y el
+ * ingreso acumulados, la cantidad de transacciones y la
+ * serie de ingresos por mes. La búsqueda por id usa una
+ * tabla hash de direccionamiento abierto.
+ **************************************************/
+
+#include <stdlib.h>
+#include <string.h>
+#include "ventas.h"
+
+#define CAPACIDAD_INICIAL_PRODUCTOS 64
+
+/*****Nombre****************************************
+ * struct TotalMensualProducto
+ *****Descripción***********************************
+ * Ingreso de un producto en un mes.
+ *****Campos****************************************
+ * @anio_mes: Mes en formato AAAAMM.
+ * @total: Ingreso del producto en el mes.
+ ***************************************************/
+typedef struct {
+    int anio_mes;
+    dinero total;
+} TotalMensualProducto;
+
+/*****Nombre****************************************
+ * struct ProductoResumen
+ *****Descripción***********************************
+ * Datos agregados de un producto. Las cadenas apuntan
+ * a los diccionarios de la lista (las de la primera
+ * venta del producto), por lo que el índice no debe usarse después de
+ * liberar la lista.
+ *****Campos****************************************
+ * @producto_id: Identificador del producto.
+ * @producto_nombre: Nombre del producto.
+ * @categoria: Categoría del producto.
+ * @unidades: Unidades vendidas.
+ * @ingresos: Ingreso total.
+ * @transacciones: Cantidad de ventas del producto.
+ * @meses: Ingreso por mes, ordenado por mes.
+ * @num_meses: Cantidad de meses con ventas.
+ * @capacidad_meses: Capacidad del arreglo de meses.
+ ***************************************************/
+typedef struct {
+    int producto_id;
+    const char *producto_nombre;
+    const char *categoria;
+    long unidades;
+    dinero ingresos;
+    size_t transacciones;
+    TotalMensualProducto *meses;
+    size_t num_meses;
+    size_t capacidad_meses;
+} ProductoResumen;
+
+/*****Nombre****************************************
+ * struct indiceProductos
+ *****Descripción***********************************
+ * Índice hash de productos.
+ *****Campos****************************************
+ * @productos: Arreglo denso de productos, en orden de aparición.
+ * @num_productos: Cantidad de productos distintos.
+ * @capacidad_productos: Capacidad del arreglo de productos.
+ * @tabla: Casillas de la tabla hash; guardan la posición del
+ *         producto más uno, o 0 si la casilla está vacía.
+ * @capacidad_tabla: Cantidad de casillas (potencia de dos).
+ * @generacion: Generación de la lista con la que se construyó.
+ ***************************************************/
+typedef struct {
+    ProductoResumen *productos;
+    size_t num_productos;
+    size_t capacidad_productos;
+    size_t *tabla;
+    size_t capacidad_tabla;
+    unsigned long generacion;
+} indiceProductos;
+
+void liberarIndiceProductos(indiceProductos *indice) {
+    if (indice != NULL) {
+        for (size_t i = 0; i < indice->num_productos; i++) {
+            free(indice->productos[i].meses);
+        }
+        free(indice->productos);
+        free(indice->tabla);
+        free(indice);
+    }
+}
+
+/*****Nombre***************************************
+ * Función ubicarProducto
+ *****Descripción**********************************
+ * Busca la casilla de un producto con sondeo lineal.
+ *****Retorno**************************************
+ * @return: La posición de la casilla que contiene al
+ *          producto, o la de la casilla vacía donde iría.
+ ****Entradas**************************************
+ * @param indice: Un puntero al struct `indiceProductos`.
+ * @param producto_id: Identificador del producto.
+ * @param sondeos: Acumula la cantidad de casillas revisadas.
+ **************************************************/
+size_t ubicarProducto(const indiceProductos *indice, int producto_id, size_t *sondeos) {
+    size_t mascara = indice->capacidad_tabla - 1;
+    // mezclar64 distribuye los ids consecutivos en la tabla
+    size_t casilla = (size_t)mezclar64((uint32_t)producto_id) & mascara;
+    while (1) {
+        (*sondeos)++;
+        size_t ocupante = indice->tabla[casilla];
+        if (ocupante == 0 || indice->productos[ocupante - 1].producto_id == producto_id) {
+            return casilla;
+        }
+        casilla = (casilla + 1) & mascara;
+    }
+}
+
+// Duplica la tabla hash y reubica los productos existentes
+int crecerTablaProductos(indiceProductos *indice) {
+    size_t nueva_capacidad = indice->capacidad_tabla * 2;
+    size_t *nueva_tabla = (size_t *)callocContado(nueva_capacidad, sizeof(size_t));
+    if (nueva_tabla == NULL) {
+        printf("Error al redimensionar el índice de productos.\n");
+        return 0;
+    }
+
+    free(indice->tabla);
+    indice->tabla = nueva_tabla;
+    indice->capacidad_tabla = nueva_capacidad;
+
+    size_t sondeos = 0;
+    for (size_t i = 0; i < indice->num_productos; i++) {
+        indice->tabla[ubicarProducto(indice, indice->productos[i].producto_id, &sondeos)] = i + 1;
+    }
+    return 1;
+}
+
+// Suma un ingreso al mes indicado de la serie de un producto
+int acumularMesProducto(ProductoResumen *producto, int anio_mes, dinero total) {
+    // Las ventas suelen llegar agrupadas por fecha: se revisa primero el último mes
+    for (size_t m = producto->num_meses; m > 0; m--) {
+        if (producto->meses[m - 1].anio_mes == anio_mes) {
+            producto->meses[m - 1].total += total;
+            return 1;
+        }
+    }
+
+    if (producto->num_meses == producto->capacidad_meses) {
+        size_t nueva_capacidad = producto->capacidad_meses ? producto->capacidad_meses * 2 : 4;
+        TotalMensualProducto *temp = (TotalMensualProducto *)reallocContado(producto->meses, sizeof(TotalMensualProducto) * nueva_capacidad);
+        if (temp == NULL) {
+            return 0;
+        }
+        producto->meses = temp;
+        producto->capacidad_meses = nueva_capacidad;
+    }
+
+    // Inserción ordenada por mes
+    size_t posicion = producto->num_meses;
+    while (posicion > 0 && producto->meses[posicion - 1].anio_mes > anio_mes) {
+        producto->meses[posicion] = producto->meses[posicion - 1];
+        posicion--;
+    }
+    producto->meses[posicion].anio_mes = anio_mes;
+    producto->meses[posicion].total = total;
+    producto->num_meses++;
+    return 1;
+}
+
+/*****Nombre***************************************
+ * Función construirIndiceProductos
+ *****Descripción**********************************
+ * Construye el índice de productos en una sola pasada
+ * sobre la lista de ventas.
+ *****Retorno**************************************
+ * @return: Un puntero al índice construido, o `NULL` si
+ *          falla la asignación de memoria.
+ ****Entradas**************************************
+ * @param lista: Un puntero al struct `listaVentas`.
+ **************************************************/
+indiceProductos* construirIndiceProductos(listaVentas *lista) {
+    inicioMetrica inicio = metricaInicio();
+    size_t sondeos = 0;
+
+    indiceProductos *indice = (indiceProductos *)callocContado(1, sizeof(indiceProductos));
+    if (indice == NULL) {
+        printf("Error al asignar memoria para el índice de productos.\n");
+        return NULL;
+    }
+    indice->capacidad_tabla = CAPACIDAD_INICIAL_PRODUCTOS * 2;
+    indice->capacidad_productos = CAPACIDAD_INICIAL_PRODUCTOS;
+    indice->tabla = (size_t *)callocContado(indice->capacidad_tabla, sizeof(size_t));
+    indice->productos = (ProductoResumen *)mallocContado(sizeof(ProductoResumen) * indice->capacidad_productos);
+    if (indice->tabla == NULL || indice->productos == NULL) {
+        printf("Error al asignar memoria para el índice de productos.\n");
+        liberarIndiceProductos(indice);
+        return NULL;
+    }
+    indice->generacion = lista->generacion;
+
+    for (size_t i = 0; i < lista->size; i++) {
+        Venta *venta = &lista->ventas[i];
+        size_t casilla = ubicarProducto(indice, venta->producto_id, &sondeos);
+
+        if (indice->tabla[casilla] == 0) {
+            // Mantener la tabla a lo sumo medio llena
+            if ((indice->num_productos + 1) * 2 > indice->capacidad_tabla) {
+                if (!crecerTablaProductos(indice)) {
+                    liberarIndiceProductos(indice);
+                    return NULL;
+                }
+                casilla = ubicarProducto(indice, venta->producto_id, &sondeos);
+            }
+            if (indice->num_productos == indice->capacidad_productos) {
+                size_t nueva_capacidad = indice->capacidad_productos * 2;
+                ProductoResumen *temp = (ProductoResumen *)reallocContado(indice->productos, sizeof(ProductoResumen) * nueva_capacidad);
+                if (temp == NULL) {
+                    printf("Error al redimensionar el índice de productos.\n");
+                    liberarIndiceProductos(indice);
+                    return NULL;
+                }
+                indice->productos = temp;
+                indice->capacidad_productos = nueva_capacidad;
+            }
+
+            ProductoResumen *nuevo = &indice->productos[indice->num_productos];
+            memset(nuevo, 0, sizeof(ProductoResumen));
+            nuevo->producto_id = venta->producto_id;
+            nuevo->producto_nombre = nombreProducto(lista, venta);
+            nuevo->categoria = nombreCategoria(lista, venta);
+            indice->tabla[casilla] = ++indice->num_productos;
+        }
+
+        ProductoResumen *producto = &indice->productos[indice->tabla[casilla] - 1];
+        dinero total = importeVenta(venta);
+        producto->unidades += venta->cantidad;
+        producto->ingresos += total;
+        producto->transacciones++;
+
+        if (!acumularMesProducto(producto, venta->fecha / 100, total)) {
+            printf("Error al redimensionar la serie mensual del producto %d.\n", producto->producto_id);
+            liberarIndiceProductos(indice);
+            return NULL;
+        }
+    }
+
+    metricaSondeos(ETAPA_INDICE_PRODUCTOS, sondeos);
+    metricaFin(ETAPA_INDICE_PRODUCTOS, inicio, lista->size);
+    return indice;
+}
+
+/*****Nombre***************************************
+ * Función buscarProducto
+ *****Descripción**********************************
+ * Busca un producto por su identificador en tiempo
+ * constante esperado.
+ *****Retorno**************************************
+ * @return: Un puntero al resumen del producto, o `NULL`
+ *          si no existe.
+ ****Entradas**************************************
+ * @param indice: Un puntero al struct `indiceProductos`.
+ * @param producto_id: Identificador del producto.
+ **************************************************/
+ProductoResumen* buscarProducto(indiceProductos *indice, int producto_id) {
+    size_t sondeos = 0;
+    size_t ocupante = indice->tabla[ubicarProducto(indice, producto_id, &sondeos)];
+    return ocupante ? &indice->productos[ocupante - 1] : NULL;
+}
+
+// Intercambio y hundimiento en un montículo mínimo de productos por ingresos
+void hundirMonticuloProductos(ProductoResumen **monticulo, size_t n, size_t i) {
+    while (1) {
+        size_t menor = i;
+        size_t izq = 2 * i + 1;
+        size_t der = 2 * i + 2;
+        if (izq < n && monticulo[izq]->ingresos < monticulo[menor]->ingresos) menor = izq;
+        if (der < n && monticulo[der]->ingresos < monticulo[menor]->ingresos) menor = der;
+        if (menor == i) return;
+        ProductoResumen *temp = monticulo[i];
+        monticulo[i] = monticulo[menor];
+        monticulo[menor] = temp;
+        i = menor;
+    }
+}
+
+/*****Nombre***************************************
+ * Función topProductos
+ *****Descripción**********************************
+ * Obtiene los `n` productos con mayores ingresos usando
+ * un montículo mínimo de tamaño `n`, sin ordenar todos
+ * los productos.
+ *****Retorno**************************************
+ * @return: Cantidad de productos escritos en `resultado`,
+ *          ordenados de mayor a menor ingreso.
+ ****Entradas**************************************
+ * @param indice: Un puntero al struct `indiceProductos`.
+ * @param n: Cantidad de productos solicitados.
+ * @param resultado: Arreglo de al menos `n` punteros.
+ **************************************************/
+size_t topProductos(indiceProductos *indice, size_t n, ProductoResumen **resultado) {
+    size_t tamano = 0;
+    if (n == 0) {
+        return 0;
+    }
+
+    for (size_t i = 0; i < indice->num_productos; i++) {
+        ProductoResumen *producto = &indice->productos[i];
+        if (tamano < n) {
+            // Insertar y subir
+            size_t j = tamano++;
+            resultado[j] = producto;
+            while (j > 0 && resultado[(j - 1) / 2]->ingresos > resultado[j]->ingresos) {
+                ProductoResumen *temp = resultado[j];
+                resultado[j] = resultado[(j - 1) / 2];
+                resultado[(j - 1) / 2] = temp;
+                j = (j - 1) / 2;
+            }
+        } else if (producto->ingresos > resultado[0]->ingresos) {
+            resultado[0] = producto;
+            hundirMonticuloProductos(resultado, tamano, 0);
+        }
+    }
+
+    // Extraer el mínimo repetidamente deja el arreglo en orden descendente
+    for (size_t fin = tamano; fin > 1; fin--) {
+        ProductoResumen *temp = resultado[0];
+        resultado[0] = resultado[fin - 1];
+        resultado[fin - 1] = temp;
+        hundirMonticuloProductos(resultado, fin - 1, 0);
+    }
+    return tamano;
+}
+
+/*****Nombre***************************************
+ * Función serieMensualProducto
+ *****Descripción**********************************
+ * Obtiene la serie de ingresos por mes de un producto.
+ *****Retorno**************************************
+ * @return: Cantidad de meses de la serie, o 0 si el
+ *          producto no existe.
+ ****Entradas**************************************
+ * @param indice: Un puntero al struct `indiceProductos`.
+ * @param producto_id: Identificador del producto.
+ * @param serie: Recibe un puntero a la serie ordenada por
+ *               mes (propiedad del índice).
+ **************************************************/
+size_t serieMensualProducto(indiceProductos *indice, int producto_id, const TotalMensualProducto **serie) {
+    ProductoResumen *producto = buscarProducto(indice, producto_id);
+    if (producto == NULL) {
+        *serie = NULL;
+        return 0;
+    }
+    *serie = producto->meses;
+    return producto->num_meses;
+}
+
+#endif // PRODUCTOS_H
@@ -0,0 +1,125 @@
+#ifndef REDUCCION_H
+#define REDUCCION_H
+
+/*****Datos administrativos************************
+ * Nombre del archivo: reduccion
+ * Tipo de archivo: C Encabezado
+ * Proyecto: Sistema de Análisis de Datos de Ventas
+ *****Descripción**********************************
+ * Reducciones paralelas deterministas. Los elementos se
+ * dividen en bloques de tamaño fijo (BLOQUE_REDUCCION),
+ * que no depende de la cantidad de hilos; cada bloque
+ * produce un resultado parcial y los parciales se
+ * combinan con un árbol fijo por pares (0+1, 2+3, ...,
+ * luego 0+2, ...). Como el particionado y el orden de
+ * combinación dependen solo de la cantidad de elementos,
+ * el resultado es idéntico bit a bit con cualquier
+ * cantidad de hilos, aun para acumuladores de punto
+ * flotante.
+ **************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "metricas.h"
+#include "hilos.h"
+
+#define BLOQUE_REDUCCION 16384
+// Elementos mínimos por hilo: por debajo, crear el hilo cuesta más que la suma que le toca
+#define ELEMENTOS_POR_HILO_REDUCCION (16 * BLOQUE_REDUCCION)
+
+// Hilos de las reducciones; 0 usa hilosPorDefecto(). Se configura con configurarHilosReduccion
+static int hilos_reduccion = 0;
+
+void configurarHilosReduccion(int hilos) {
+    hilos_reduccion = hilos;
+}
+
+/*****Nombre****************************************
+ * struct reduccionDeterminista
+ *****Descripción***********************************
+ * Describe una reducción sobre los índices
+ * [0, num_elementos).
+ *****Campos****************************************
+ * @num_elementos: Cantidad de elementos a reducir.
+ * @tam_parcial: Bytes de un resultado parcial.
+ * @contexto: Datos de entrada de la reducción.
+ * @inicializar: Deja un parcial en el valor neutro.
+ * @reducir: Acumula los elementos [desde, hasta) en un parcial.
+ * @combinar: Acumula el parcial `origen` en `destino`.
+ * @parciales: Uso interno: un parcial por bloque.
+ ***************************************************/
+typedef struct {
+    size_t num_elementos;
+    size_t tam_parcial;
+    void *contexto;
+    void (*inicializar)(void *contexto, void *parcial);
+    void (*reducir)(void *contexto, size_t desde, size_t hasta, void *parcial);
+    void (*combinar)(void *contexto, void *destino, const void *origen);
+    unsigned char *parciales;
+} reduccionDeterminista;
+
+// Tarea de un bloque: reduce sus elementos en el parcial que le corresponde
+void reducirBloqueDeterminista(void *argumento, size_t bloque) {
+    reduccionDeterminista *reduccion = (reduccionDeterminista *)argumento;
+    size_t desde = bloque * BLOQUE_REDUCCION;
+    size_t hasta = desde + BLOQUE_REDUCCION < reduccion->num_elementos ? desde + BLOQUE_REDUCCION : reduccion->num_elementos;
+    void *parcial = reduccion->parciales + bloque * reduccion->tam_parcial;
+    reduccion->inicializar(reduccion->contexto, parcial);
+    reduccion->reducir(reduccion->contexto, desde, hasta, parcial);
+}
+
+/*****Nombre***************************************
+ * Función reducirEnBloques
+ *****Descripción**********************************
+ * Ejecuta la reducción con hasta `hilos` hilos (0 usa
+ * la configuración de configurarHilosReduccion) y deja
+ * el resultado en `resultado`. Cada hilo recibe al
+ * menos ELEMENTOS_POR_HILO_REDUCCION elementos, así que
+ * las reducciones chicas corren en el hilo que llama.
+ * El resultado no depende de `hilos`.
+ *****Retorno**************************************
+ * @return: 1 si se completó, 0 si falló la asignación
+ *          de memoria (`resultado` queda sin cambios).
+ ****Entradas**************************************
+ * @param reduccion: Descripción de la reducción.
+ * @param hilos: Cantidad de hilos, o 0.
+ * @param resultado: Recibe el resultado (`tam_parcial` bytes).
+ **************************************************/
+int reducirEnBloques(reduccionDeterminista *reduccion, int hilos, void *resultado) {
+    size_t num_bloques = (reduccion->num_elementos + BLOQUE_REDUCCION - 1) / BLOQUE_REDUCCION;
+    if (num_bloques == 0) {
+        reduccion->inicializar(reduccion->contexto, resultado);
+        return 1;
+    }
+
+    reduccion->parciales = (unsigned char *)mallocContado(num_bloques * reduccion->tam_parcial);
+    if (reduccion->parciales == NULL) {
+        printf("Error al asignar memoria para la reducción.\n");
+        return 0;
+    }
+
+    if (hilos <= 0) {
+        hilos = hilos_reduccion > 0 ? hilos_reduccion : hilosPorDefecto();
+    }
+    size_t hilos_utiles = reduccion->num_elementos / ELEMENTOS_POR_HILO_REDUCCION;
+    if ((size_t)hilos > hilos_utiles) {
+        hilos = hilos_utiles > 0 ? (int)hilos_utiles : 1;
+    }
+    ejecutarTareas(hilos, reducirBloqueDeterminista, reduccion, num_bloques);
+
+    // Árbol de combinación fijo: en cada nivel, el parcial i absorbe al i + paso
+    for (size_t paso = 1; paso < num_bloques; paso *= 2) {
+        for (size_t i = 0; i + paso < num_bloques; i += 2 * paso) {
+            reduccion->combinar(reduccion->contexto, reduccion->parciales + i * reduccion->tam_parcial,
+                                reduccion->parciales + (i + paso) * reduccion->tam_parcial);
+        }
+    }
+
+    memcpy(resultado, reduccion->parciales, reduccion->tam_parcial);
+    free(reduccion->parciales);
+    reduccion->parciales = NULL;
+    return 1;
+}
+
+#endif // REDUCCION_H
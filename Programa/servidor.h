@@ -0,0 +1,659 @@
+#ifndef SERVIDOR_H
+#define SERVIDOR_H
+
+/*****Datos administrativos************************
+ * Nombre del archivo: servidor
+ * Tipo de archivo: C Encabezado
+ * Proyecto: Sistema de Análisis de Datos de Ventas
+ *****Descripción**********************************
+ * Modo servidor: los datos se cargan una sola vez y los
+ * análisis se responden por un socket de dominio Unix.
+ * Cada comando es una línea de texto y cada respuesta
+ * una línea JSON:
+ *   total                 {"total": 775036.41}
+ *   mensual               {"mensual": [{"mes": "Enero 2023", "total": ...}, ...]}
+ *   anual                 {"anual": [{"anio": "2023", "total": ...}, ...]}
+ *   mes_mayor             {"mes": "Mayo 2023", "total": ...}
+ *   dia_activo            {"dia": "Lunes", "transacciones": ...}
+ *   crecimiento T AAAA    {"trimestre": T, "anio": AAAA, "tasa": ...}
+ *   top_categorias [N]    {"categorias": [{"categoria": ..., "total": ...}, ...]}
+ *   consulta EXPRESION    {"grupos": [...], "bloques_revisados": ..., "bloques": ...}
+ *   importar RUTA         {"encolado": RUTA, "pendientes": N}
+ *   estado                {"version": N, "ventas": N, "pendientes": N}
+ *   ping                  {"ok": true}
+ *   salir                 cierra la conexión
+ *   detener               detiene el servidor
+ * Los errores se responden como {"error": "..."}.
+ *
+ * Varios hilos trabajadores esperan en el mismo epoll.
+ * Cada conexión se registra con EPOLLONESHOT, de modo
+ * que la atiende un solo hilo a la vez (sus respuestas
+ * salen en orden) y se vuelve a armar al terminar.
+ *
+ * Las ventas viven en un almacén versionado (versiones.h).
+ * "importar" encola un archivo que un hilo de ingesta
+ * agrega en segundo plano y publica como una versión
+ * nueva; cada comando se responde sobre la versión
+ * vigente al recibirlo, sin candados ni esperas, así
+ * que los análisis siguen en paralelo durante la
+ * importación. Requiere Linux (epoll).
+ **************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "ventas.h"
+
+#define SOCKET_POR_DEFECTO "ventas.sock"
+
+#ifdef __linux__
+#include <errno.h>
+#include <signal.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include "consultas.h"
+#include "hilos.h"
+#include "versiones.h"
+
+#define MAX_LINEA_SERVIDOR 4096
+#define CONEXIONES_PENDIENTES 64
+// Tiempo máximo para entregar una respuesta a un cliente que no la lee
+#define ESPERA_ENVIO_SEGUNDOS 5
+
+/*****Nombre****************************************
+ * struct clienteServidor
+ *****Descripción***********************************
+ * Conexión de un cliente.
+ *****Campos****************************************
+ * @fd: Socket de la conexión.
+ * @buffer: Texto recibido que aún no forma una línea completa.
+ * @largo: Bytes usados en `buffer`.
+ * @anterior: Conexión anterior en la lista del servidor.
+ * @siguiente: Conexión siguiente en la lista del servidor.
+ ***************************************************/
+typedef struct clienteServidor {
+    int fd;
+    char buffer[MAX_LINEA_SERVIDOR];
+    size_t largo;
+    struct clienteServidor *anterior;
+    struct clienteServidor *siguiente;
+} clienteServidor;
+
+/*****Nombre****************************************
+ * struct servidorVentas
+ *****Descripción***********************************
+ * Estado compartido por los hilos del servidor.
+ *****Campos****************************************
+ * @almacen: Versiones de las ventas.
+ * @ingesta: Hilo que importa los archivos de "importar".
+ * @lectores: Lectores del almacén ya asignados a hilos.
+ * @epoll: Descriptor del epoll compartido.
+ * @escucha: Socket que acepta conexiones.
+ * @aviso: Tubería que despierta a todos los hilos al detener.
+ * @detener: Se activa para terminar el servidor.
+ * @clientes: Conexiones abiertas, para cerrarlas al terminar.
+ * @candado: Protege `clientes`.
+ * @atendidos: Comandos respondidos.
+ ***************************************************/
+typedef struct {
+    almacenVersiones almacen;
+    ingestaVentas ingesta;
+    atomic_size_t lectores;
+    int epoll;
+    int escucha;
+    int aviso[2];
+    atomic_int detener;
+    clienteServidor *clientes;
+    pthread_mutex_t candado;
+    atomic_ulong atendidos;
+} servidorVentas;
+
+// Tubería de aviso del servidor activo, para el manejador de señales
+static int aviso_servidor = -1;
+
+void manejarSenalServidor(int senal) {
+    (void)senal;
+    if (aviso_servidor >= 0) {
+        ssize_t escritos = write(aviso_servidor, "x", 1);
+        (void)escritos;
+    }
+}
+
+// Pide a todos los hilos que terminen
+void detenerServidor(servidorVentas *servidor) {
+    atomic_store(&servidor->detener, 1);
+    ssize_t escritos = write(servidor->aviso[1], "x", 1);
+    (void)escritos;
+}
+
+// Envía todo el texto; devuelve 0 si la conexión falló
+int enviarServidor(int fd, const char *texto, size_t largo) {
+    while (largo > 0) {
+        ssize_t enviados = send(fd, texto, largo, MSG_NOSIGNAL);
+        if (enviados < 0 && errno == EINTR) {
+            continue;
+        }
+        if (enviados <= 0) {
+            return 0;
+        }
+        texto += enviados;
+        largo -= (size_t)enviados;
+    }
+    return 1;
+}
+
+// Agrega al objeto un arreglo de {clave: etiqueta, "total": monto}
+void agregarTotalesJSON(cJSON *respuesta, const char *nombre, const char *clave, char **etiquetas, dinero *totales, size_t num) {
+    cJSON *arreglo = cJSON_AddArrayToObject(respuesta, nombre);
+    for (size_t i = 0; i < num; i++) {
+        cJSON *elemento = cJSON_CreateObject();
+        cJSON_AddStringToObject(elemento, clave, etiquetas[i]);
+        cJSON_AddNumberToObject(elemento, "total", dineroADouble(totales[i]));
+        cJSON_AddItemToArray(arreglo, elemento);
+    }
+}
+
+void liberarEtiquetas(char **etiquetas, dinero *totales, size_t num) {
+    for (size_t i = 0; i < num; i++) {
+        free(etiquetas[i]);
+    }
+    free(etiquetas);
+    free(totales);
+}
+
+// Agrega al objeto los grupos de una consulta filtrada
+void agregarConsultaJSON(cJSON *respuesta, listaVentas *lista, const char *texto) {
+    Consulta consulta;
+    ResultadoConsulta resultado;
+    if (!analizarConsulta(lista, texto, &consulta)) {
+        cJSON_AddStringToObject(respuesta, "error", "Consulta inválida.");
+        return;
+    }
+    if (!ejecutarConsulta(lista, &consulta, &resultado)) {
+        cJSON_AddStringToObject(respuesta, "error", "No se pudo ejecutar la consulta.");
+        return;
+    }
+
+    ordenarResultadoConsulta(&consulta, &resultado);
+    cJSON *grupos = cJSON_AddArrayToObject(respuesta, "grupos");
+    for (size_t g = 0; g < resultado.num_grupos; g++) {
+        GrupoConsulta *grupo = &resultado.grupos[g];
+        char etiqueta[64];
+        etiquetaGrupoConsulta(lista, &consulta, grupo, etiqueta, sizeof(etiqueta));
+        cJSON *elemento = cJSON_CreateObject();
+        cJSON_AddStringToObject(elemento, "grupo", etiqueta);
+        cJSON_AddNumberToObject(elemento, "ventas", (double)grupo->ventas);
+        cJSON_AddNumberToObject(elemento, "unidades", (double)grupo->unidades);
+        cJSON_AddNumberToObject(elemento, "importe", dineroADouble(grupo->importe));
+        cJSON_AddItemToArray(grupos, elemento);
+    }
+    cJSON_AddNumberToObject(respuesta, "bloques_revisados", (double)(resultado.num_zonas - resultado.zonas_saltadas));
+    cJSON_AddNumberToObject(respuesta, "bloques", (double)resultado.num_zonas);
+    liberarResultadoConsulta(&resultado);
+}
+
+// Convierte la respuesta en una línea terminada en '\n' y libera el objeto; NULL si falla
+char* lineaRespuesta(cJSON *respuesta) {
+    char *texto = cJSON_PrintUnformatted(respuesta);
+    cJSON_Delete(respuesta);
+    if (texto == NULL) {
+        return NULL;
+    }
+    size_t largo = strlen(texto);
+    char *linea_respuesta = (char *)reallocContado(texto, largo + 2);
+    if (linea_respuesta == NULL) {
+        free(texto);
+        return NULL;
+    }
+    linea_respuesta[largo] = '\n';
+    linea_respuesta[largo + 1] = '\0';
+    return linea_respuesta;
+}
+
+/*****Nombre***************************************
+ * Función responderComando
+ *****Descripción**********************************
+ * Ejecuta un comando sobre la lista y arma su
+ * respuesta JSON.
+ *****Retorno**************************************
+ * @return: La respuesta en una línea terminada en
+ *          '\n' (el llamador la libera), o NULL si
+ *          falla la asignación de memoria.
+ ****Entradas**************************************
+ * @param lista: Un puntero al struct `listaVentas`.
+ * @param linea: Comando recibido, sin el fin de línea.
+ **************************************************/
+char* responderComando(listaVentas *lista, const char *linea) {
+    cJSON *respuesta = cJSON_CreateObject();
+    if (respuesta == NULL) {
+        return NULL;
+    }
+
+    char comando[32] = "";
+    int leidos = 0;
+    sscanf(linea, " %31s %n", comando, &leidos);
+    const char *argumentos = linea + leidos;
+
+    if (strcmp(comando, "ping") == 0) {
+        cJSON_AddBoolToObject(respuesta, "ok", 1);
+    } else if (strcmp(comando, "total") == 0) {
+        cJSON_AddNumberToObject(respuesta, "total", dineroADouble(totalVentas(lista)));
+    } else if (strcmp(comando, "mensual") == 0 || strcmp(comando, "mes_mayor") == 0) {
+        char **meses = NULL;
+        dinero *totales = NULL;
+        size_t num = 0;
+        totalVentasMensuales(lista, &meses, &totales, &num);
+        if (strcmp(comando, "mensual") == 0) {
+            agregarTotalesJSON(respuesta, "mensual", "mes", meses, totales, num);
+        } else if (num == 0) {
+            cJSON_AddStringToObject(respuesta, "error", "No se encontraron ventas registradas.");
+        } else {
+            size_t mayor = 0;
+            for (size_t i = 1; i < num; i++) {
+                if (totales[i] > totales[mayor]) mayor = i;
+            }
+            cJSON_AddStringToObject(respuesta, "mes", meses[mayor]);
+            cJSON_AddNumberToObject(respuesta, "total", dineroADouble(totales[mayor]));
+        }
+        liberarEtiquetas(meses, totales, num);
+    } else if (strcmp(comando, "anual") == 0) {
+        char **anios = NULL;
+        dinero *totales = NULL;
+        size_t num = 0;
+        totalVentasAnuales(lista, &anios, &totales, &num);
+        agregarTotalesJSON(respuesta, "anual", "anio", anios, totales, num);
+        liberarEtiquetas(anios, totales, num);
+    } else if (strcmp(comando, "dia_activo") == 0) {
+        int transacciones[7];
+        contarTransaccionesPorDia(lista, transacciones);
+        int mayor = 0;
+        for (int d = 1; d < 7; d++) {
+            if (transacciones[d] > transacciones[mayor]) mayor = d;
+        }
+        cJSON_AddStringToObject(respuesta, "dia", nombres_dias[mayor]);
+        cJSON_AddNumberToObject(respuesta, "transacciones", transacciones[mayor]);
+    } else if (strcmp(comando, "crecimiento") == 0) {
+        int trimestre, anio;
+        if (sscanf(argumentos, "%d %d", &trimestre, &anio) != 2 || trimestre < 1 || trimestre > 4) {
+            cJSON_AddStringToObject(respuesta, "error", "Uso: crecimiento TRIMESTRE AÑO (trimestre de 1 a 4).");
+        } else {
+            dinero actual, anterior;
+            sumarTrimestres(lista, trimestre, anio, &actual, &anterior);
+            cJSON_AddNumberToObject(respuesta, "trimestre", trimestre);
+            cJSON_AddNumberToObject(respuesta, "anio", anio);
+            if (anterior == 0) {
+                cJSON_AddStringToObject(respuesta, "error", "No hay datos suficientes para calcular la tasa de crecimiento.");
+            } else {
+                cJSON_AddNumberToObject(respuesta, "tasa", (double)(actual - anterior) / anterior * 100.0);
+            }
+        }
+    } else if (strcmp(comando, "top_categorias") == 0) {
+        int limite = 5;
+        sscanf(argumentos, "%d", &limite);
+        size_t num;
+        CategoriaVenta *categorias = calcularTotalesCategorias(lista, &num);
+        if (categorias == NULL) {
+            cJSON_AddStringToObject(respuesta, "error", "No se pudieron calcular las categorías.");
+        } else {
+            cJSON *arreglo = cJSON_AddArrayToObject(respuesta, "categorias");
+            for (size_t i = 0; i < num && (limite <= 0 || i < (size_t)limite); i++) {
+                cJSON *elemento = cJSON_CreateObject();
+                cJSON_AddStringToObject(elemento, "categoria", cadenaDeCodigo(&lista->categorias, categorias[i].codigo));
+                cJSON_AddNumberToObject(elemento, "total", dineroADouble(categorias[i].totalVentas));
+                cJSON_AddItemToArray(arreglo, elemento);
+            }
+            free(categorias);
+        }
+    } else if (strcmp(comando, "consulta") == 0) {
+        agregarConsultaJSON(respuesta, lista, argumentos);
+    } else {
+        cJSON_AddStringToObject(respuesta, "error", "Comando desconocido.");
+    }
+
+    return lineaRespuesta(respuesta);
+}
+
+// Registra (o vuelve a armar) una conexión en el epoll para un solo aviso
+int armarCliente(servidorVentas *servidor, clienteServidor *cliente, int operacion) {
+    struct epoll_event evento;
+    evento.events = EPOLLIN | EPOLLRDHUP | EPOLLONESHOT;
+    evento.data.ptr = cliente;
+    return epoll_ctl(servidor->epoll, operacion, cliente->fd, &evento) == 0;
+}
+
+void cerrarCliente(servidorVentas *servidor, clienteServidor *cliente) {
+    pthread_mutex_lock(&servidor->candado);
+    if (cliente->anterior != NULL) cliente->anterior->siguiente = cliente->siguiente;
+    else servidor->clientes = cliente->siguiente;
+    if (cliente->siguiente != NULL) cliente->siguiente->anterior = cliente->anterior;
+    pthread_mutex_unlock(&servidor->candado);
+
+    epoll_ctl(servidor->epoll, EPOLL_CTL_DEL, cliente->fd, NULL);
+    close(cliente->fd);
+    free(cliente);
+}
+
+// Acepta las conexiones pendientes y las registra
+void aceptarClientes(servidorVentas *servidor) {
+    int fd;
+    while ((fd = accept(servidor->escucha, NULL, NULL)) >= 0) {
+        clienteServidor *cliente = (clienteServidor *)callocContado(1, sizeof(clienteServidor));
+        if (cliente == NULL) {
+            close(fd);
+            continue;
+        }
+        struct timeval espera = { ESPERA_ENVIO_SEGUNDOS, 0 };
+        setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &espera, sizeof(espera));
+        cliente->fd = fd;
+
+        pthread_mutex_lock(&servidor->candado);
+        cliente->siguiente = servidor->clientes;
+        if (servidor->clientes != NULL) servidor->clientes->anterior = cliente;
+        servidor->clientes = cliente;
+        pthread_mutex_unlock(&servidor->candado);
+
+        if (!armarCliente(servidor, cliente, EPOLL_CTL_ADD)) {
+            cerrarCliente(servidor, cliente);
+        }
+    }
+}
+
+/*****Nombre***************************************
+ * Función responderAlmacen
+ *****Descripción**********************************
+ * Responde los comandos que no son análisis:
+ * "importar RUTA" encola el archivo en el hilo de
+ * ingesta y "estado" informa la versión vigente.
+ *****Retorno**************************************
+ * @return: La respuesta terminada en '\n', o NULL si la
+ *          línea no es uno de estos comandos.
+ ****Entradas**************************************
+ * @param servidor: Un puntero al `servidorVentas`.
+ * @param lector: Lector del almacén del hilo que responde.
+ * @param linea: Comando recibido, sin el fin de línea.
+ **************************************************/
+char* responderAlmacen(servidorVentas *servidor, size_t lector, const char *linea) {
+    char comando[32] = "";
+    int leidos = 0;
+    sscanf(linea, " %31s %n", comando, &leidos);
+    const char *ruta = linea + leidos;
+    if (strcmp(comando, "importar") != 0 && strcmp(comando, "estado") != 0) {
+        return NULL;
+    }
+
+    cJSON *respuesta = cJSON_CreateObject();
+    if (respuesta == NULL) {
+        return NULL;
+    }
+    if (strcmp(comando, "estado") == 0) {
+        versionVentas *version = comenzarLectura(&servidor->almacen, lector);
+        cJSON_AddNumberToObject(respuesta, "version", (double)version->numero);
+        cJSON_AddNumberToObject(respuesta, "ventas", (double)version->lista.size);
+        terminarLectura(&servidor->almacen, lector);
+        cJSON_AddNumberToObject(respuesta, "pendientes", (double)ingestasPendientes(&servidor->ingesta));
+    } else if (ruta[0] == '\0') {
+        cJSON_AddStringToObject(respuesta, "error", "Uso: importar RUTA");
+    } else {
+        size_t pendientes = encolarIngesta(&servidor->ingesta, ruta);
+        if (pendientes == 0) {
+            cJSON_AddStringToObject(respuesta, "error", "No se pudo encolar la importación.");
+        } else {
+            cJSON_AddStringToObject(respuesta, "encolado", ruta);
+            cJSON_AddNumberToObject(respuesta, "pendientes", (double)pendientes);
+        }
+    }
+    return lineaRespuesta(respuesta);
+}
+
+/*****Nombre***************************************
+ * Función atenderCliente
+ *****Descripción**********************************
+ * Lee lo disponible en la conexión y responde cada
+ * línea completa, en orden.
+ *****Retorno**************************************
+ * @return: 1 si la conexión sigue abierta, 0 si hay
+ *          que cerrarla.
+ ****Entradas**************************************
+ * @param servidor: Un puntero al `servidorVentas`.
+ * @param cliente: Conexión con datos para leer.
+ * @param lector: Lector del almacén del hilo que atiende.
+ **************************************************/
+int atenderCliente(servidorVentas *servidor, clienteServidor *cliente, size_t lector) {
+    for (;;) {
+        ssize_t leidos = recv(cliente->fd, cliente->buffer + cliente->largo, sizeof(cliente->buffer) - cliente->largo, MSG_DONTWAIT);
+        if (leidos < 0 && errno == EINTR) {
+            continue;
+        }
+        if (leidos < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            return 1;
+        }
+        if (leidos <= 0) {
+            return 0;
+        }
+        cliente->largo += (size_t)leidos;
+
+        char *inicio = cliente->buffer;
+        char *fin;
+        while ((fin = memchr(inicio, '\n', cliente->largo - (inicio - cliente->buffer))) != NULL) {
+            *fin = '\0';
+            if (fin > inicio && fin[-1] == '\r') fin[-1] = '\0';
+
+            if (strcmp(inicio, "salir") == 0) {
+                return 0;
+            }
+            if (strcmp(inicio, "detener") == 0) {
+                enviarServidor(cliente->fd, "{\"ok\":true}\n", 12);
+                detenerServidor(servidor);
+                return 0;
+            }
+            // Cada análisis se calcula sobre la versión vigente al recibir el comando
+            char *respuesta = responderAlmacen(servidor, lector, inicio);
+            if (respuesta == NULL) {
+                versionVentas *version = comenzarLectura(&servidor->almacen, lector);
+                respuesta = responderComando(&version->lista, inicio);
+                terminarLectura(&servidor->almacen, lector);
+            }
+            int enviado = (respuesta != NULL) && enviarServidor(cliente->fd, respuesta, strlen(respuesta));
+            free(respuesta);
+            if (!enviado) {
+                return 0;
+            }
+            atomic_fetch_add(&servidor->atendidos, 1);
+            inicio = fin + 1;
+        }
+
+        // Conservar la línea incompleta al principio del buffer
+        cliente->largo -= (size_t)(inicio - cliente->buffer);
+        memmove(cliente->buffer, inicio, cliente->largo);
+        if (cliente->largo == sizeof(cliente->buffer)) {
+            const char *error = "{\"error\":\"Línea demasiado larga.\"}\n";
+            enviarServidor(cliente->fd, error, strlen(error));
+            return 0;
+        }
+    }
+}
+
+// Hilo trabajador: espera eventos del epoll compartido y los atiende
+void* trabajarServidor(void *argumento) {
+    servidorVentas *servidor = (servidorVentas *)argumento;
+    size_t lector = atomic_fetch_add(&servidor->lectores, 1);
+    struct epoll_event evento;
+
+    while (!atomic_load(&servidor->detener)) {
+        if (epoll_wait(servidor->epoll, &evento, 1, -1) <= 0) {
+            continue;
+        }
+        if (evento.data.ptr == &servidor->aviso) {
+            // El aviso queda sin leer para que despierte también a los demás hilos
+            atomic_store(&servidor->detener, 1);
+            break;
+        }
+        if (evento.data.ptr == &servidor->escucha) {
+            aceptarClientes(servidor);
+            struct epoll_event rearmado = { EPOLLIN | EPOLLONESHOT, { .ptr = &servidor->escucha } };
+            epoll_ctl(servidor->epoll, EPOLL_CTL_MOD, servidor->escucha, &rearmado);
+            continue;
+        }
+
+        clienteServidor *cliente = (clienteServidor *)evento.data.ptr;
+        if (!atenderCliente(servidor, cliente, lector) || (evento.events & (EPOLLHUP | EPOLLERR)) ||
+            !armarCliente(servidor, cliente, EPOLL_CTL_MOD)) {
+            cerrarCliente(servidor, cliente);
+        }
+    }
+    return NULL;
+}
+
+// Abre el socket de escucha en `ruta`, reemplazando un socket viejo; -1 si falla
+int abrirSocketServidor(const char *ruta) {
+    struct sockaddr_un direccion;
+    if (strlen(ruta) >= sizeof(direccion.sun_path)) {
+        printf("La ruta del socket es demasiado larga: %s\n", ruta);
+        return -1;
+    }
+    memset(&direccion, 0, sizeof(direccion));
+    direccion.sun_family = AF_UNIX;
+    strcpy(direccion.sun_path, ruta);
+
+    struct stat estado;
+    if (stat(ruta, &estado) == 0 && S_ISSOCK(estado.st_mode)) {
+        unlink(ruta);
+    }
+
+    int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (fd < 0 || bind(fd, (struct sockaddr *)&direccion, sizeof(direccion)) != 0 || listen(fd, CONEXIONES_PENDIENTES) != 0) {
+        printf("No se pudo abrir el socket %s: %s\n", ruta, strerror(errno));
+        if (fd >= 0) close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+/*****Nombre***************************************
+ * Función ejecutarServidor
+ *****Descripción**********************************
+ * Atiende comandos sobre la lista hasta recibir
+ * "detener", SIGINT o SIGTERM. Mientras tanto la lista
+ * queda en el almacén versionado; al terminar recibe
+ * también las ventas importadas con "importar".
+ *****Retorno**************************************
+ * @return: 1 si el servidor se detuvo normalmente, 0 si
+ *          no se pudo iniciar.
+ ****Entradas**************************************
+ * @param lista: Un puntero al struct `listaVentas`.
+ * @param ruta: Ruta del socket (NULL usa SOCKET_POR_DEFECTO).
+ * @param hilos: Hilos trabajadores, o 0 para el valor por defecto.
+ **************************************************/
+int ejecutarServidor(listaVentas *lista, const char *ruta, int hilos) {
+    if (ruta == NULL) {
+        ruta = SOCKET_POR_DEFECTO;
+    }
+    if (hilos <= 0) {
+        hilos = hilosPorDefecto();
+    }
+    if (hilos > MAX_HILOS) {
+        hilos = MAX_HILOS;
+    }
+
+    // La lista pasa a ser la versión 1 del almacén, con su mapa de zonas ya construido
+    servidorVentas servidor;
+    memset(&servidor, 0, sizeof(servidor));
+    if (!iniciarAlmacenVersiones(&servidor.almacen, lista)) {
+        return 0;
+    }
+    atomic_init(&servidor.lectores, 0);
+    atomic_init(&servidor.detener, 0);
+    atomic_init(&servidor.atendidos, 0);
+    pthread_mutex_init(&servidor.candado, NULL);
+
+    servidor.escucha = abrirSocketServidor(ruta);
+    if (servidor.escucha < 0) {
+        pthread_mutex_destroy(&servidor.candado);
+        cerrarAlmacenVersiones(&servidor.almacen, lista);
+        return 0;
+    }
+    servidor.epoll = epoll_create1(EPOLL_CLOEXEC);
+    if (servidor.epoll < 0 || pipe(servidor.aviso) != 0) {
+        printf("No se pudo iniciar el servidor: %s\n", strerror(errno));
+        if (servidor.epoll >= 0) close(servidor.epoll);
+        close(servidor.escucha);
+        unlink(ruta);
+        pthread_mutex_destroy(&servidor.candado);
+        cerrarAlmacenVersiones(&servidor.almacen, lista);
+        return 0;
+    }
+    struct epoll_event escucha = { EPOLLIN | EPOLLONESHOT, { .ptr = &servidor.escucha } };
+    struct epoll_event aviso = { EPOLLIN, { .ptr = &servidor.aviso } };
+    epoll_ctl(servidor.epoll, EPOLL_CTL_ADD, servidor.escucha, &escucha);
+    epoll_ctl(servidor.epoll, EPOLL_CTL_ADD, servidor.aviso[0], &aviso);
+
+    // Las señales de terminación solo avisan; los hilos trabajadores no las reciben
+    struct sigaction accion, accion_int, accion_term;
+    memset(&accion, 0, sizeof(accion));
+    accion.sa_handler = manejarSenalServidor;
+    aviso_servidor = servidor.aviso[1];
+    sigaction(SIGINT, &accion, &accion_int);
+    sigaction(SIGTERM, &accion, &accion_term);
+    sigset_t senales, anteriores;
+    sigemptyset(&senales);
+    sigaddset(&senales, SIGINT);
+    sigaddset(&senales, SIGTERM);
+    pthread_sigmask(SIG_BLOCK, &senales, &anteriores);
+
+    int ingesta = iniciarIngesta(&servidor.ingesta, &servidor.almacen, hilos);
+    pthread_t trabajadores[MAX_HILOS];
+    int lanzados = 0;
+    for (int h = 0; h < hilos && ingesta; h++) {
+        if (pthread_create(&trabajadores[lanzados], NULL, trabajarServidor, &servidor) == 0) {
+            lanzados++;
+        }
+    }
+    pthread_sigmask(SIG_SETMASK, &anteriores, NULL);
+
+    if (lanzados == 0) {
+        printf("No se pudo iniciar el servidor.\n");
+        detenerServidor(&servidor);
+    } else {
+        printf("Servidor escuchando en %s con %d hilos (%zu ventas cargadas).\n", ruta, lanzados, lista->size);
+        fflush(stdout);
+    }
+    for (int h = 0; h < lanzados; h++) {
+        pthread_join(trabajadores[h], NULL);
+    }
+    if (ingesta) {
+        detenerIngesta(&servidor.ingesta);
+    }
+
+    sigaction(SIGINT, &accion_int, NULL);
+    sigaction(SIGTERM, &accion_term, NULL);
+    aviso_servidor = -1;
+    while (servidor.clientes != NULL) {
+        cerrarCliente(&servidor, servidor.clientes);
+    }
+    close(servidor.epoll);
+    close(servidor.aviso[0]);
+    close(servidor.aviso[1]);
+    close(servidor.escucha);
+    unlink(ruta);
+    pthread_mutex_destroy(&servidor.candado);
+    cerrarAlmacenVersiones(&servidor.almacen, lista);
+
+    printf("Servidor detenido (%lu comandos atendidos).\n", (unsigned long)atomic_load(&servidor.atendidos));
+    return lanzados > 0;
+}
+
+#else
+
+int ejecutarServidor(listaVentas *lista, const char *ruta, int hilos) {
+    printf("El modo servidor solo está disponible en Linux.\n");
+    return 0;
+}
+
+#endif // __linux__
+
+#endif // SERVIDOR_H
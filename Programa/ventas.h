@@ -14,8 +14,17 @@
 
 #include <stdlib.h>
 #include <string.h>
+#include <limits.h>
+#include <ctype.h>
 #include <time.h>
 #include "funcs_json.h"
+#include "metricas.h"
+#include "diagnosticos.h"
+#include "bosquejos.h"
+#include "diccionario.h"
+#include "dinero.h"
+#include "reduccion.h"
+#include "externo.h"
 
 /*****Nombre****************************************
  * struct Venta
@@ -23,28 +32,77 @@
  * Representa una venta con detalles asociados, 
  * incluyendo el identificador de la venta, la fecha,
  * el identificador y nombre del producto, la categoría,
- * la cantidad vendida y el precio unitario.
+ * la cantidad vendida y el precio unitario. El nombre
+ * del producto y la categoría se guardan como códigos
+ * de los diccionarios de la lista (`listaVentas`).
+ * Es un registro de ancho fijo (40 bytes) sin memoria
+ * propia: la fecha se guarda como número y los campos
+ * de 32 bits van antes de los montos para no dejar
+ * relleno entre ellos.
  *****Campos****************************************
- * @int venta_id: Identificador único de la venta.
- * @char *fecha: Fecha en la que se realizó la venta.
- * @int producto_id: Identificador único del producto.
- * @char *producto_nombre: Nombre del producto.
- * @char *categoria: Categoría del producto.
- * @int cantidad: Cantidad de unidades vendidas.
- * @float precio_unitario: Precio por unidad del producto.
- * @float total: Total calculado para la venta.
+ * @int32_t venta_id: Identificador único de la venta.
+ * @int32_t fecha: Fecha de la venta como entero AAAAMMDD,
+ *                 validada al importar.
+ * @int32_t producto_id: Identificador único del producto.
+ * @codigo_producto: Código del nombre del producto.
+ * @codigo_categoria: Código de la categoría del producto.
+ * @int32_t cantidad: Cantidad de unidades vendidas.
+ * @dinero precio_unitario: Precio por unidad del producto.
+ * @dinero total: Total calculado para la venta (0 si no se conoce).
  ***************************************************/
 typedef struct {
-    int venta_id;
-    char *fecha;
-    int producto_id;
-    char *producto_nombre;
-    char *categoria;
-    int cantidad;
-    float precio_unitario;
-    float total;
+    int32_t venta_id;
+    int32_t fecha;
+    int32_t producto_id;
+    codigoCadena codigo_producto;
+    codigoCadena codigo_categoria;
+    int32_t cantidad;
+    dinero precio_unitario;
+    dinero total;
 } Venta;
 
+// Importe de una venta: su total si se conoce, o cantidad por precio unitario
+dinero importeVenta(const Venta *venta) {
+    return (venta->total != 0) ? venta->total : venta->cantidad * venta->precio_unitario;
+}
+
+/*****Nombre****************************************
+ * struct mapaZonas
+ *****Descripción***********************************
+ * Resumen por bloques de FILAS_POR_ZONA ventas
+ * consecutivas con el mínimo y el máximo de la fecha,
+ * el precio y la cantidad de cada bloque, y un mapa de
+ * bits de sus categorías. Un recorrido filtrado puede
+ * saltar los bloques cuyo rango no cumple el filtro sin
+ * mirar sus ventas. El mapa se guarda junto con los
+ * datos procesados y se reutiliza al importarlos.
+ *****Campos****************************************
+ * @zonas: Resumen de cada bloque.
+ * @num_zonas: Cantidad de bloques.
+ * @generacion: Generación de la lista al construirlo.
+ ***************************************************/
+#define FILAS_POR_ZONA 8192
+
+// Bit de una categoría en el mapa de bits de una zona; con más de 64 categorías
+// varias comparten bit, lo que solo impide saltar algunos bloques
+#define BIT_CATEGORIA(codigo) (1ULL << ((codigo) & 63))
+
+typedef struct {
+    int fecha_min;
+    int fecha_max;
+    dinero precio_min;
+    dinero precio_max;
+    int cantidad_min;
+    int cantidad_max;
+    uint64_t categorias;
+} zonaVentas;
+
+typedef struct {
+    zonaVentas *zonas;
+    size_t num_zonas;
+    unsigned long generacion;
+} mapaZonas;
+
 /*****Nombre****************************************
  * struct listaVentas
  *****Descripción***********************************
@@ -55,26 +113,47 @@ typedef struct {
  * @Venta *ventas: Puntero a un arreglo dinámico de estructuras `Venta`.
  * @size: Tamaño actual de la lista.
  * @capacity: Capacidad total del arreglo de ventas.
+ * @generacion: Contador que aumenta cada vez que cambian los datos;
+ *              permite invalidar resultados calculados previamente.
+ * @bosquejos: Bosquejos del modo aproximado, actualizados durante la
+ *             importación, o NULL si el modo no está activo.
+ * @productos: Diccionario de nombres de producto.
+ * @categorias: Diccionario de categorías.
+ * @zonas: Mapa de zonas, construido al recorrer por bloques o al importar.
  ***************************************************/
 typedef struct {
     Venta *ventas;
     size_t size;
     size_t capacity;
+    unsigned long generacion;
+    bosquejosVentas *bosquejos;
+    diccionarioCadenas productos;
+    diccionarioCadenas categorias;
+    mapaZonas zonas;
 } listaVentas;
 
+// Nombre del producto y categoría de una venta de la lista
+#define nombreProducto(lista, venta) cadenaDeCodigo(&(lista)->productos, (venta)->codigo_producto)
+#define nombreCategoria(lista, venta) cadenaDeCodigo(&(lista)->categorias, (venta)->codigo_categoria)
+
 /*****Nombre****************************************
  * struct CategoriaVenta
  *****Descripción***********************************
  * Representa una lista dinámica de ventas por categoria
  *****Campos****************************************
- * @categoria: Categoria de productos vendidos.
+ * @codigo: Código de la categoría de productos vendidos.
  * @totalVentas: Total de ventas.
  ***************************************************/
 typedef struct {
-    char *categoria;
-    float totalVentas;
+    codigoCadena codigo;
+    dinero totalVentas;
 } CategoriaVenta;
 
+#define CAPACIDAD_INICIAL_VENTAS 10
+
+// Tamaño promedio aproximado de un registro de venta en JSON (bytes)
+#define BYTES_POR_VENTA_JSON 200
+
 /*****Nombre***************************************
  * Función crearListaVentas
  *****Descripción**********************************
@@ -92,14 +171,14 @@ typedef struct {
  **************************************************/
 listaVentas* crearListaVentas() {
     // Asignar memoria para el struct listaVentas
-    listaVentas *lista = (listaVentas *)malloc(sizeof(listaVentas));
+    listaVentas *lista = (listaVentas *)mallocContado(sizeof(listaVentas));
     if (lista == NULL) {
         printf("Error al asignar memoria para la lista de ventas.\n");
         return NULL;
     }
     
     // Asignar memoria para un array de structs Venta de tamaño inicial 10
-    lista->ventas = (Venta *)malloc(sizeof(Venta) * 10);
+    lista->ventas = (Venta *)mallocContado(sizeof(Venta) * CAPACIDAD_INICIAL_VENTAS);
     if (lista->ventas == NULL) {
         printf("Error al asignar memoria para las ventas.\n");
         free(lista);
@@ -108,11 +187,82 @@ listaVentas* crearListaVentas() {
     
     // Inicializar campos del struct listaVentas
     lista->size = 0;       
-    lista->capacity = 10;  
+    lista->capacity = CAPACIDAD_INICIAL_VENTAS;
+    lista->generacion = 0;
+    lista->bosquejos = NULL;
+    inicializarDiccionario(&lista->productos);
+    inicializarDiccionario(&lista->categorias);
+    memset(&lista->zonas, 0, sizeof(mapaZonas));
 
     return lista;
 }
 
+/*****Nombre***************************************
+ * Función reservarListaVentas
+ *****Descripción**********************************
+ * Garantiza que la lista tenga capacidad para al menos
+ * `capacidad` ventas. Si hace falta crecer, la nueva
+ * capacidad es el máximo entre la solicitada y el doble
+ * de la actual, de modo que reservas sucesivas mantienen
+ * un crecimiento geométrico. Si `realloc` falla, la lista
+ * queda intacta.
+ * El arreglo es contiguo porque los reportes y el mapa
+ * de zonas lo recorren por índice: al crecer puede
+ * moverse, así que nadie guarda punteros a ventas entre
+ * inserciones, y en el almacén versionado (versiones.h)
+ * el arreglo anterior vive hasta que no quedan lectores.
+ *****Retorno**************************************
+ * @return: 1 si la lista tiene la capacidad solicitada,
+ *          0 si no se pudo asignar la memoria.
+ ****Entradas************************************** 
+ * @param lista: Un puntero al struct `listaVentas`.
+ * @param capacidad: Cantidad mínima de ventas a acomodar.
+ **************************************************/
+int reservarListaVentas(listaVentas *lista, size_t capacidad) {
+    if (lista == NULL) {
+        printf("Error: La lista de ventas no está inicializada.\n");
+        return 0;
+    }
+
+    if (capacidad <= lista->capacity) {
+        return 1;
+    }
+
+    size_t nueva_capacidad = lista->capacity * 2;
+    if (nueva_capacidad < capacidad) {
+        nueva_capacidad = capacidad;
+    }
+
+    Venta *temp = (Venta *)reallocContado(lista->ventas, sizeof(Venta) * nueva_capacidad);
+    if (temp == NULL) {
+        printf("Error al redimensionar la memoria para las ventas.\n");
+        return 0;
+    }
+
+    lista->ventas = temp;
+    lista->capacity = nueva_capacidad;
+    return 1;
+}
+
+/*****Nombre***************************************
+ * Función estimarVentasPorTamano
+ *****Descripción**********************************
+ * Estima la cantidad de ventas contenidas en un archivo
+ * JSON a partir de su tamaño en bytes. Sirve para
+ * pre-dimensionar la lista cuando aún no se conoce el
+ * largo exacto del arreglo.
+ *****Retorno**************************************
+ * @return: Cantidad estimada de ventas.
+ ****Entradas************************************** 
+ * @param bytes: Tamaño del archivo en bytes.
+ **************************************************/
+size_t estimarVentasPorTamano(long bytes) {
+    if (bytes <= 0) {
+        return 0;
+    }
+    return (size_t)bytes / BYTES_POR_VENTA_JSON + 1;
+}
+
 /*****Nombre***************************************
  * Función agregarVenta
  *****Descripción**********************************
@@ -120,34 +270,57 @@ listaVentas* crearListaVentas() {
  * Si la lista está llena, duplica la capacidad del arreglo 
  * de ventas mediante `realloc` para acomodar la nueva venta.
  *****Retorno**************************************
- * 
+ * @return: 1 si la venta se agregó, 0 si no se pudo
+ *          asignar la memoria (la lista queda intacta).
  ****Entradas************************************** 
  * @param lista: Un puntero al struct `listaVentas`.
  * @param venta: Un struct `Venta`.
  **************************************************/
-void agregarVenta(listaVentas *lista, Venta nuevaVenta) {
+int agregarVenta(listaVentas *lista, Venta nuevaVenta) {
     if (lista == NULL) {
         printf("Error: La lista de ventas no está inicializada.\n");
-        return;
+        return 0;
     }
     
     // Verificar si hay suficiente capacidad; si no, redimensionar el array
-    if (lista->size >= lista->capacity) {
-        // Duplicar la capacidad actual
-        lista->capacity *= 2;
-        Venta *temp = (Venta *)realloc(lista->ventas, sizeof(Venta) * lista->capacity);
-        if (temp == NULL) {
-            printf("Error al redimensionar la memoria para las ventas.\n");
-            return;
-        }
-        lista->ventas = temp;
+    if (lista->size >= lista->capacity && !reservarListaVentas(lista, lista->size + 1)) {
+        return 0;
     }
     
     // Agregar la nueva venta
     lista->ventas[lista->size] = nuevaVenta;
     lista->size++;
+    lista->generacion++;
+    return 1;
 }
 
+/*****Nombre***************************************
+ * Función agregarVentas
+ *****Descripción**********************************
+ * Agrega un bloque de ventas a la lista con una sola
+ * reserva de memoria y una sola copia.
+ *****Retorno**************************************
+ * @return: 1 si el bloque se agregó (o estaba vacío),
+ *          0 si no se pudo asignar la memoria (la lista
+ *          queda intacta).
+ ****Entradas************************************** 
+ * @param lista: Un puntero al struct `listaVentas`.
+ * @param ventas: Arreglo de ventas a agregar.
+ * @param cantidad: Cantidad de ventas del arreglo.
+ **************************************************/
+int agregarVentas(listaVentas *lista, const Venta *ventas, size_t cantidad) {
+    if (cantidad == 0) {
+        return 1;
+    }
+    if (!reservarListaVentas(lista, lista->size + cantidad)) {
+        return 0;
+    }
+
+    memcpy(lista->ventas + lista->size, ventas, sizeof(Venta) * cantidad);
+    lista->size += cantidad;
+    lista->generacion++;
+    return 1;
+}
 
 /*****Nombre***************************************
  * Función liberarListaVentas
@@ -164,38 +337,545 @@ void agregarVenta(listaVentas *lista, Venta nuevaVenta) {
  **************************************************/
 void liberarListaVentas(listaVentas *lista) {
     if (lista != NULL) {
+        liberarBosquejosVentas(lista->bosquejos);
+        liberarDiccionario(&lista->productos);
+        liberarDiccionario(&lista->categorias);
+        free(lista->zonas.zonas);
         free(lista->ventas); 
         free(lista);         
     }
 }
 
+#define NUM_ATRIBUTOS_OBLIGATORIOS 5
+
+static const char *atributos_obligatorios[NUM_ATRIBUTOS_OBLIGATORIOS] = { "venta_id", "fecha", "producto_id", "producto_nombre", "categoria" };
+
+// Máscara con un bit por cada atributo obligatorio ausente en el objeto (0 si están todos)
+unsigned int atributosFaltantes(cJSON *item) {
+    unsigned int mascara = 0;
+    for (int i = 0; i < NUM_ATRIBUTOS_OBLIGATORIOS; i++) {
+        if (!cJSON_HasObjectItem(item, atributos_obligatorios[i])) {
+            mascara |= 1u << i;
+        }
+    }
+    return mascara;
+}
+
+// Partición de las ventas que se importan, para repartir el análisis entre procesos;
+// con una sola partición se importan todas
+static unsigned int particion_total = 1;
+static unsigned int particion_actual = 0;
+
+// Hace que las importaciones siguientes solo agreguen las ventas de la partición `actual` de `total`
+void configurarParticionImportacion(unsigned int total, unsigned int actual) {
+    particion_total = (total > 0) ? total : 1;
+    particion_actual = actual % particion_total;
+}
+
+// Indica si la venta (con todos los atributos obligatorios) pertenece a la partición configurada.
+// Se reparte por venta_id, de modo que los registros duplicados quedan en la misma partición.
+int ventaEnParticion(cJSON *item) {
+    if (particion_total == 1) {
+        return 1;
+    }
+    unsigned int venta_id = (unsigned int)cJSON_GetObjectItem(item, "venta_id")->valueint;
+    return venta_id % particion_total == particion_actual;
+}
+
+// Nombres de los atributos en los mensajes: los obligatorios y luego los numéricos opcionales
+static const char *nombre_atributos[] = { "Identificador de venta", "Fecha", "Identificador de producto", "Nombre de producto", "Categoría",
+                                          "Cantidad", "Precio unitario", "Total" };
+
+// Escribe en `destino` los nombres de los atributos marcados en la máscara, separados por comas
+void listarAtributos(unsigned int mascara, char *destino, size_t capacidad) {
+    size_t usado = 0;
+    destino[0] = '\0';
+    for (size_t i = 0; i < sizeof(nombre_atributos) / sizeof(nombre_atributos[0]); i++) {
+        if ((mascara & (1u << i)) && usado < capacidad) {
+            usado += snprintf(destino + usado, capacidad - usado, "%s%s", usado > 0 ? ", " : "", nombre_atributos[i]);
+        }
+    }
+}
+
 // Función para construir el mensaje de error sobre atributos faltantes
-void reportarAtributosFaltantes(cJSON *item, int linea) {
-    const char *atributos[] = { "venta_id", "fecha", "producto_id", "producto_nombre", "categoria" };
-    const char *nombre_atributos[] = { "Identificador de venta", "Fecha", "Identificador de producto", "Nombre de producto", "Categoría" };
-    int faltan = 0;
-    char mensaje[256] = "La línea ";
-    snprintf(mensaje + strlen(mensaje), sizeof(mensaje) - strlen(mensaje), "%d no se pudo importar debido a que faltan los atributos: ", linea);
-
-    for (int i = 0; i < 5; i++) {
-        if (!cJSON_HasObjectItem(item, atributos[i])) {
-            if (faltan > 0) {
-                strncat(mensaje, ", ", sizeof(mensaje) - strlen(mensaje));
-            }
-            strncat(mensaje, nombre_atributos[i], sizeof(mensaje) - strlen(mensaje));
-            faltan++;
+void reportarAtributosFaltantes(unsigned int mascara, int linea) {
+    char faltantes[160] = "";
+
+    // La lista de atributos solo se arma si la línea de detalle se va a escribir
+    if (diagnosticoRequiereDetalle(DIAG_ATRIBUTOS_FALTANTES)) {
+        listarAtributos(mascara, faltantes, sizeof(faltantes));
+    }
+
+    registrarDiagnostico(DIAG_ATRIBUTOS_FALTANTES, "La línea %d no se pudo importar debido a que faltan los atributos: %s.", linea, faltantes);
+}
+
+// Función para construir el mensaje de error sobre atributos con tipo o formato inválido
+void reportarAtributosInvalidos(unsigned int mascara, int linea) {
+    char invalidos[160] = "";
+    if (diagnosticoRequiereDetalle(DIAG_ATRIBUTOS_INVALIDOS)) {
+        listarAtributos(mascara, invalidos, sizeof(invalidos));
+    }
+
+    registrarDiagnostico(DIAG_ATRIBUTOS_INVALIDOS, "La línea %d no se pudo importar debido a que tienen un tipo o formato inválido los atributos: %s.", linea, invalidos);
+}
+
+// Convierte una fecha "AAAA-MM-DD" al entero AAAAMMDD, o 0 si no tiene ese formato o el día no existe
+int fechaANumero(const char *fecha) {
+    for (int i = 0; i < 10; i++) {
+        if ((i == 4 || i == 7) ? fecha[i] != '-' : (fecha[i] < '0' || fecha[i] > '9')) {
+            return 0;
         }
     }
+    if (fecha[10] != '\0') {
+        return 0;
+    }
+    int anio = (fecha[0] - '0') * 1000 + (fecha[1] - '0') * 100 + (fecha[2] - '0') * 10 + (fecha[3] - '0');
+    int mes = (fecha[5] - '0') * 10 + (fecha[6] - '0');
+    int dia = (fecha[8] - '0') * 10 + (fecha[9] - '0');
+    static const int dias_mes[] = { 31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31 };
+    int bisiesto = (anio % 4 == 0 && anio % 100 != 0) || anio % 400 == 0;
+    if (anio < 1 || mes < 1 || mes > 12 || dia < 1 || dia > dias_mes[mes - 1] + (mes == 2 && bisiesto)) {
+        return 0;
+    }
+    return anio * 10000 + mes * 100 + dia;
+}
+
+// Día de la semana de una fecha AAAAMMDD (0 = domingo), por el método de Sakamoto
+int diaSemanaDeFecha(int fecha) {
+    static const int desfase[] = { 0, 3, 2, 5, 0, 3, 5, 1, 4, 6, 2, 4 };
+    int anio = fecha / 10000;
+    int mes = fecha / 100 % 100;
+    int dia = fecha % 100;
+    if (mes < 3) anio--;
+    return (anio + anio / 4 - anio / 100 + anio / 400 + desfase[mes - 1] + dia) % 7;
+}
+
+// Indica si el atributo es un número entero representable en 32 bits
+int esEntero32(const cJSON *atributo) {
+    return cJSON_IsNumber(atributo) && atributo->valuedouble >= INT32_MIN && atributo->valuedouble <= INT32_MAX &&
+           atributo->valuedouble == (double)(int64_t)atributo->valuedouble;
+}
+
+/*****Nombre***************************************
+ * Función atributosInvalidos
+ *****Descripción**********************************
+ * Revisa el tipo y el formato de los atributos de un
+ * objeto que ya tiene todos los obligatorios: los
+ * identificadores deben ser enteros de 32 bits, la fecha
+ * una cadena "AAAA-MM-DD" con un día existente, el
+ * nombre y la categoría cadenas, y la cantidad, el
+ * precio y el total, si están y no son null, números
+ * (la cantidad, entera).
+ *****Retorno**************************************
+ * @return: Máscara con un bit por atributo inválido, en
+ *          el orden de `nombre_atributos` (0 si es válido).
+ ****Entradas**************************************
+ * @param item: Objeto JSON de la venta.
+ **************************************************/
+unsigned int atributosInvalidos(cJSON *item) {
+    unsigned int mascara = 0;
+    cJSON *fecha = cJSON_GetObjectItem(item, "fecha");
+    if (!esEntero32(cJSON_GetObjectItem(item, "venta_id"))) mascara |= 1u << 0;
+    if (!cJSON_IsString(fecha) || fechaANumero(fecha->valuestring) == 0) mascara |= 1u << 1;
+    if (!esEntero32(cJSON_GetObjectItem(item, "producto_id"))) mascara |= 1u << 2;
+    if (!cJSON_IsString(cJSON_GetObjectItem(item, "producto_nombre"))) mascara |= 1u << 3;
+    if (!cJSON_IsString(cJSON_GetObjectItem(item, "categoria"))) mascara |= 1u << 4;
+
+    cJSON *cantidad = cJSON_GetObjectItem(item, "cantidad");
+    cJSON *precio = cJSON_GetObjectItem(item, "precio_unitario");
+    cJSON *total = cJSON_GetObjectItem(item, "total");
+    if (cantidad != NULL && !cJSON_IsNull(cantidad) && !esEntero32(cantidad)) mascara |= 1u << 5;
+    if (precio != NULL && !cJSON_IsNull(precio) && !cJSON_IsNumber(precio)) mascara |= 1u << 6;
+    if (total != NULL && !cJSON_IsNull(total) && !cJSON_IsNumber(total)) mascara |= 1u << 7;
+    return mascara;
+}
+
+// Los atributos inválidos se informan en la misma máscara que los faltantes, desplazados
+#define DESPLAZAMIENTO_INVALIDOS 8
 
-    if (faltan == 0) {
-        // Si no faltan atributos (esto no debería pasar con esta función), eliminar el mensaje
-        mensaje[0] = '\0';
+// Motivo para no importar un objeto: la máscara de atributos faltantes o, si están todos, la de
+// atributos inválidos desplazada DESPLAZAMIENTO_INVALIDOS bits (0 si la venta se puede importar)
+unsigned int validarVenta(cJSON *item) {
+    unsigned int faltantes = atributosFaltantes(item);
+    return faltantes != 0 ? faltantes : atributosInvalidos(item) << DESPLAZAMIENTO_INVALIDOS;
+}
+
+// Registra el diagnóstico que corresponde a la máscara devuelta por validarVenta
+void reportarVentaRechazada(unsigned int mascara, int linea) {
+    if (mascara >> DESPLAZAMIENTO_INVALIDOS) {
+        reportarAtributosInvalidos(mascara >> DESPLAZAMIENTO_INVALIDOS, linea);
     } else {
-        strncat(mensaje, ".", sizeof(mensaje) - strlen(mensaje));
-        printf("%s\n", mensaje);
+        reportarAtributosFaltantes(mascara, linea);
+    }
+}
+
+/*****Nombre***************************************
+ * Función convertirVenta
+ *****Descripción**********************************
+ * Convierte un objeto JSON ya revisado por validarVenta
+ * en una `Venta`. El nombre del producto y la categoría
+ * quedan sin codificar hasta llamar a codificarVenta.
+ *****Retorno**************************************
+ * @return: La venta convertida.
+ ****Entradas**************************************
+ * @param item: Objeto JSON de la venta.
+ **************************************************/
+Venta convertirVenta(cJSON *item) {
+    Venta venta;
+    venta.venta_id = cJSON_GetObjectItem(item, "venta_id")->valueint;
+    venta.fecha = fechaANumero(cJSON_GetObjectItem(item, "fecha")->valuestring);
+    venta.producto_id = cJSON_GetObjectItem(item, "producto_id")->valueint;
+    venta.codigo_producto = CODIGO_INVALIDO;
+    venta.codigo_categoria = CODIGO_INVALIDO;
+    venta.cantidad = cJSON_GetObjectItem(item, "cantidad") ? cJSON_GetObjectItem(item, "cantidad")->valueint : 0;
+    venta.precio_unitario = cJSON_GetObjectItem(item, "precio_unitario") ? dineroDesdeDouble(cJSON_GetObjectItem(item, "precio_unitario")->valuedouble) : 0;
+    venta.total = cJSON_GetObjectItem(item, "total") ? dineroDesdeDouble(cJSON_GetObjectItem(item, "total")->valuedouble) : 0;
+    return venta;
+}
+
+// Asigna a la venta los códigos del nombre de producto y la categoría del objeto JSON
+void codificarVenta(listaVentas *lista, Venta *venta, cJSON *item) {
+    venta->codigo_producto = internarCadena(&lista->productos, cJSON_GetObjectItem(item, "producto_nombre")->valuestring);
+    venta->codigo_categoria = internarCadena(&lista->categorias, cJSON_GetObjectItem(item, "categoria")->valuestring);
+}
+
+// En modo aproximado los bosquejos se actualizan al agregar cada venta importada
+void registrarVentaImportada(listaVentas *lista, const Venta *venta) {
+    if (lista->bosquejos != NULL) {
+        registrarVentaBosquejos(lista->bosquejos, venta->venta_id, venta->producto_id, nombreProducto(lista, venta),
+                                nombreCategoria(lista, venta), dineroADouble(venta->precio_unitario), dineroADouble(importeVenta(venta)));
+    }
+}
+
+// Rangos de valores de la zona `z` de la lista
+zonaVentas calcularZona(const listaVentas *lista, size_t z) {
+    size_t desde = z * FILAS_POR_ZONA;
+    size_t hasta = desde + FILAS_POR_ZONA < lista->size ? desde + FILAS_POR_ZONA : lista->size;
+    zonaVentas zona = { INT_MAX, INT_MIN, INT64_MAX, INT64_MIN, INT_MAX, INT_MIN, 0 };
+    for (size_t i = desde; i < hasta; i++) {
+        const Venta *venta = &lista->ventas[i];
+        if (venta->fecha < zona.fecha_min) zona.fecha_min = venta->fecha;
+        if (venta->fecha > zona.fecha_max) zona.fecha_max = venta->fecha;
+        if (venta->precio_unitario < zona.precio_min) zona.precio_min = venta->precio_unitario;
+        if (venta->precio_unitario > zona.precio_max) zona.precio_max = venta->precio_unitario;
+        if (venta->cantidad < zona.cantidad_min) zona.cantidad_min = venta->cantidad;
+        if (venta->cantidad > zona.cantidad_max) zona.cantidad_max = venta->cantidad;
+        zona.categorias |= BIT_CATEGORIA(venta->codigo_categoria);
+    }
+    return zona;
+}
+
+/*****Nombre***************************************
+ * Función actualizarMapaZonas
+ *****Descripción**********************************
+ * Reconstruye el mapa de zonas de la lista si las
+ * ventas cambiaron desde la última construcción.
+ *****Retorno**************************************
+ * @return: 1 si el mapa está vigente, 0 si falló la
+ *          asignación de memoria.
+ ****Entradas**************************************
+ * @param lista: Un puntero al struct `listaVentas`.
+ **************************************************/
+int actualizarMapaZonas(listaVentas *lista) {
+    mapaZonas *mapa = &lista->zonas;
+    size_t num_zonas = (lista->size + FILAS_POR_ZONA - 1) / FILAS_POR_ZONA;
+    if (mapa->zonas != NULL && mapa->generacion == lista->generacion && mapa->num_zonas == num_zonas) {
+        return 1;
+    }
+
+    zonaVentas *zonas = (zonaVentas *)mallocContado(sizeof(zonaVentas) * (num_zonas > 0 ? num_zonas : 1));
+    if (zonas == NULL) {
+        printf("Error al asignar memoria para el mapa de zonas.\n");
+        return 0;
+    }
+    for (size_t z = 0; z < num_zonas; z++) {
+        zonas[z] = calcularZona(lista, z);
+    }
+
+    free(mapa->zonas);
+    mapa->zonas = zonas;
+    mapa->num_zonas = num_zonas;
+    mapa->generacion = lista->generacion;
+    return 1;
+}
+
+/*****Nombre***************************************
+ * Función mapaZonasAJSON
+ *****Descripción**********************************
+ * Arma la cabecera de los datos procesados con el mapa
+ * de zonas vigente. Las categorías se listan en orden
+ * de código para que el mapa de bits de cada zona se
+ * pueda interpretar al importar.
+ *****Retorno**************************************
+ * @return: El objeto JSON, o NULL si no se pudo armar.
+ ****Entradas**************************************
+ * @param lista: Un puntero al struct `listaVentas`.
+ **************************************************/
+cJSON* mapaZonasAJSON(listaVentas *lista) {
+    if (!actualizarMapaZonas(lista)) {
+        return NULL;
+    }
+    cJSON *cabecera = cJSON_CreateObject();
+    cJSON_AddNumberToObject(cabecera, "filas_por_zona", FILAS_POR_ZONA);
+    cJSON *categorias = cJSON_AddArrayToObject(cabecera, "categorias");
+    cJSON *zonas = cJSON_AddArrayToObject(cabecera, "zonas");
+    if (cabecera == NULL || categorias == NULL || zonas == NULL) {
+        cJSON_Delete(cabecera);
+        return NULL;
+    }
+    for (size_t c = 0; c < lista->categorias.num; c++) {
+        cJSON_AddItemToArray(categorias, cJSON_CreateString(lista->categorias.cadenas[c]));
+    }
+    for (size_t z = 0; z < lista->zonas.num_zonas; z++) {
+        const zonaVentas *zona = &lista->zonas.zonas[z];
+        size_t desde = z * FILAS_POR_ZONA;
+        char bits[17];
+        snprintf(bits, sizeof(bits), "%016llx", (unsigned long long)zona->categorias);
+
+        cJSON *zonaJSON = cJSON_CreateObject();
+        cJSON_AddNumberToObject(zonaJSON, "filas", (double)(desde + FILAS_POR_ZONA < lista->size ? FILAS_POR_ZONA : lista->size - desde));
+        cJSON_AddNumberToObject(zonaJSON, "fecha_min", zona->fecha_min);
+        cJSON_AddNumberToObject(zonaJSON, "fecha_max", zona->fecha_max);
+        cJSON_AddNumberToObject(zonaJSON, "precio_min", dineroADouble(zona->precio_min));
+        cJSON_AddNumberToObject(zonaJSON, "precio_max", dineroADouble(zona->precio_max));
+        cJSON_AddNumberToObject(zonaJSON, "cantidad_min", zona->cantidad_min);
+        cJSON_AddNumberToObject(zonaJSON, "cantidad_max", zona->cantidad_max);
+        cJSON_AddStringToObject(zonaJSON, "categorias", bits);
+        cJSON_AddItemToArray(zonas, zonaJSON);
+    }
+    return cabecera;
+}
+
+/*****Nombre***************************************
+ * Función cargarMapaZonas
+ *****Descripción**********************************
+ * Adopta el mapa de zonas guardado en la cabecera de
+ * los datos procesados, si corresponde exactamente a
+ * las ventas importadas: la lista estaba vacía, no se
+ * descartó ninguna venta y el tamaño de zona coincide.
+ * En otro caso el mapa se reconstruye al usarlo.
+ *****Retorno**************************************
+ * @return: 1 si se adoptó el mapa, 0 si no.
+ ****Entradas**************************************
+ * @param lista: Un puntero al struct `listaVentas`.
+ * @param cabecera: Objeto JSON principal del archivo.
+ * @param size_inicial: Ventas de la lista antes de importar.
+ **************************************************/
+int cargarMapaZonas(listaVentas *lista, cJSON *cabecera, size_t size_inicial) {
+    cJSON *filas_por_zona = cJSON_GetObjectItem(cabecera, "filas_por_zona");
+    cJSON *categorias = cJSON_GetObjectItem(cabecera, "categorias");
+    cJSON *zonas = cJSON_GetObjectItem(cabecera, "zonas");
+    size_t num_zonas = (lista->size + FILAS_POR_ZONA - 1) / FILAS_POR_ZONA;
+    if (size_inicial != 0 || !cJSON_IsNumber(filas_por_zona) || filas_por_zona->valueint != FILAS_POR_ZONA ||
+        !cJSON_IsArray(categorias) || !cJSON_IsArray(zonas) || (size_t)cJSON_GetArraySize(zonas) != num_zonas || num_zonas == 0) {
+        return 0;
+    }
+
+    // Bits de la lista que corresponden a cada bit del archivo (los códigos pueden diferir)
+    uint64_t equivalencias[64] = { 0 };
+    int posicion = 0;
+    cJSON *categoria = NULL;
+    cJSON_ArrayForEach(categoria, categorias) {
+        codigoCadena codigo = cJSON_IsString(categoria) ? buscarCadena(&lista->categorias, categoria->valuestring) : CODIGO_INVALIDO;
+        if (codigo != CODIGO_INVALIDO) {
+            equivalencias[posicion & 63] |= BIT_CATEGORIA(codigo);
+        }
+        posicion++;
+    }
+
+    zonaVentas *nuevas = (zonaVentas *)mallocContado(sizeof(zonaVentas) * num_zonas);
+    if (nuevas == NULL) {
+        return 0;
+    }
+    size_t z = 0;
+    cJSON *zonaJSON = NULL;
+    cJSON_ArrayForEach(zonaJSON, zonas) {
+        cJSON *filas = cJSON_GetObjectItem(zonaJSON, "filas");
+        cJSON *bits = cJSON_GetObjectItem(zonaJSON, "categorias");
+        const char *campos[] = { "fecha_min", "fecha_max", "precio_min", "precio_max", "cantidad_min", "cantidad_max" };
+        int completa = cJSON_IsNumber(filas) && cJSON_IsString(bits);
+        for (size_t c = 0; c < sizeof(campos) / sizeof(campos[0]); c++) {
+            completa = completa && cJSON_IsNumber(cJSON_GetObjectItem(zonaJSON, campos[c]));
+        }
+        size_t esperadas = (z + 1) * FILAS_POR_ZONA < lista->size ? FILAS_POR_ZONA : lista->size - z * FILAS_POR_ZONA;
+        if (!completa || (size_t)filas->valuedouble != esperadas) {
+            free(nuevas);
+            return 0;
+        }
+
+        zonaVentas *zona = &nuevas[z++];
+        zona->fecha_min = cJSON_GetObjectItem(zonaJSON, "fecha_min")->valueint;
+        zona->fecha_max = cJSON_GetObjectItem(zonaJSON, "fecha_max")->valueint;
+        zona->precio_min = dineroDesdeDouble(cJSON_GetObjectItem(zonaJSON, "precio_min")->valuedouble);
+        zona->precio_max = dineroDesdeDouble(cJSON_GetObjectItem(zonaJSON, "precio_max")->valuedouble);
+        zona->cantidad_min = cJSON_GetObjectItem(zonaJSON, "cantidad_min")->valueint;
+        zona->cantidad_max = cJSON_GetObjectItem(zonaJSON, "cantidad_max")->valueint;
+        uint64_t bits_archivo = strtoull(bits->valuestring, NULL, 16);
+        zona->categorias = 0;
+        for (int b = 0; b < 64; b++) {
+            if (bits_archivo & (1ULL << b)) {
+                zona->categorias |= equivalencias[b];
+            }
+        }
+    }
+
+    free(lista->zonas.zonas);
+    lista->zonas.zonas = nuevas;
+    lista->zonas.num_zonas = num_zonas;
+    lista->zonas.generacion = lista->generacion;
+    return 1;
+}
+
+// Tamaño máximo de la cabecera que se lee para revisar los datos procesados
+#define MAX_CABECERA_DATOS (16 * 1024 * 1024)
+
+// Suma de control de la cabecera: hash FNV-1a de su texto compacto, sin la propia suma
+int sumaControlCabecera(const cJSON *cabecera, char suma[17]) {
+    char *texto = cJSON_PrintUnformatted(cabecera);
+    if (texto == NULL) {
+        return 0;
+    }
+    snprintf(suma, 17, "%016llx", (unsigned long long)hashCadena(texto));
+    free(texto);
+    return 1;
+}
+
+// Agrega a la cabecera la cantidad de filas y, al final, su suma de control
+void sellarCabecera(cJSON *cabecera, size_t filas) {
+    char suma[17];
+    cJSON_AddNumberToObject(cabecera, "filas", (double)filas);
+    if (sumaControlCabecera(cabecera, suma)) {
+        cJSON_AddStringToObject(cabecera, "suma_control", suma);
     }
 }
 
+/*****Nombre****************************************
+ * enum EstadoCabecera
+ *****Descripción***********************************
+ * Resultado de revisar la cabecera de un archivo de
+ * datos procesados.
+ ***************************************************/
+typedef enum {
+    CABECERA_VALIDA,
+    CABECERA_AUSENTE,
+    CABECERA_INVALIDA
+} EstadoCabecera;
+
+// Posición de la clave "ventas" seguida de ':' desde `desde`, o -1 si todavía no aparece.
+// Un nombre de categoría igual a "ventas" no va seguido de ':'.
+long buscarClaveVentas(const char *texto, size_t desde) {
+    for (const char *clave = strstr(texto + desde, "\"ventas\""); clave != NULL; clave = strstr(clave + 1, "\"ventas\"")) {
+        const char *siguiente = clave + 8;
+        while (isspace((unsigned char)*siguiente)) siguiente++;
+        if (*siguiente == ':') {
+            return clave - texto;
+        }
+    }
+    return -1;
+}
+
+/*****Nombre***************************************
+ * Función revisarCabeceraDatos
+ *****Descripción**********************************
+ * Lee solo el comienzo de un archivo de datos
+ * procesados, hasta la clave "ventas", y comprueba la
+ * suma de control de su cabecera sin analizar las
+ * ventas.
+ *****Retorno**************************************
+ * @return: CABECERA_VALIDA si la suma coincide,
+ *          CABECERA_AUSENTE si el archivo es un arreglo
+ *          o su cabecera no tiene suma (formatos
+ *          anteriores), o CABECERA_INVALIDA si no se
+ *          pudo leer o la suma no coincide.
+ ****Entradas**************************************
+ * @param path: Ruta del archivo.
+ * @param filas: Recibe las filas declaradas en una
+ *               cabecera válida (puede ser NULL).
+ **************************************************/
+EstadoCabecera revisarCabeceraDatos(const char *path, size_t *filas) {
+    lectorArchivo *lector = abrirLector(path);
+    if (lector == NULL) {
+        return CABECERA_INVALIDA;
+    }
+
+    EstadoCabecera estado = CABECERA_INVALIDA;
+    size_t capacidad = BLOQUE_COMPRESION;
+    size_t largo = 0;
+    long fin_cabecera = -1;
+    char *texto = (char *)mallocContado(capacidad + 1);
+    while (texto != NULL && fin_cabecera < 0) {
+        if (largo == capacidad) {
+            char *temp = capacidad < MAX_CABECERA_DATOS ? (char *)reallocContado(texto, capacidad * 2 + 1) : NULL;
+            if (temp == NULL) {
+                break;
+            }
+            texto = temp;
+            capacidad *= 2;
+        }
+        size_t leidos = leerLector(lector, texto + largo, capacidad - largo);
+        if (leidos == 0) {
+            break;
+        }
+        // Se vuelve a revisar el final del bloque anterior por si la clave quedó cortada
+        size_t desde = largo > 64 ? largo - 64 : 0;
+        largo += leidos;
+        texto[largo] = '\0';
+
+        size_t inicio = 0;
+        while (inicio < largo && isspace((unsigned char)texto[inicio])) inicio++;
+        if (inicio < largo && texto[inicio] == '[') {
+            estado = CABECERA_AUSENTE;
+            break;
+        }
+        fin_cabecera = buscarClaveVentas(texto, desde);
+    }
+    cerrarLector(lector);
+
+    if (fin_cabecera > 0) {
+        // Cerrar el objeto justo antes de la clave "ventas"
+        size_t fin = (size_t)fin_cabecera;
+        while (fin > 0 && (isspace((unsigned char)texto[fin - 1]) || texto[fin - 1] == ',')) fin--;
+        texto[fin] = '}';
+        texto[fin + 1] = '\0';
+
+        cJSON *cabecera = cJSON_Parse(texto);
+        cJSON *suma = cJSON_GetObjectItem(cabecera, "suma_control");
+        if (cabecera != NULL && !cJSON_IsString(suma)) {
+            estado = CABECERA_AUSENTE;
+        } else if (cabecera != NULL) {
+            char guardada[17];
+            char calculada[17];
+            snprintf(guardada, sizeof(guardada), "%s", suma->valuestring);
+            cJSON_DeleteItemFromObject(cabecera, "suma_control");
+            if (sumaControlCabecera(cabecera, calculada) && strcmp(guardada, calculada) == 0) {
+                cJSON *declaradas = cJSON_GetObjectItem(cabecera, "filas");
+                if (filas != NULL) {
+                    *filas = cJSON_IsNumber(declaradas) ? (size_t)declaradas->valuedouble : 0;
+                }
+                estado = CABECERA_VALIDA;
+            }
+        }
+        cJSON_Delete(cabecera);
+    }
+    free(texto);
+    return estado;
+}
+
+// Suma de control del arreglo "ventas": FNV-1a de su texto, acumulado por partes al escribirlo o leerlo
+#define SUMA_CUERPO_INICIAL 0xcbf29ce484222325ULL
+
+uint64_t acumularSumaCuerpo(uint64_t suma, const char *datos, size_t largo) {
+    for (size_t i = 0; i < largo; i++) {
+        suma ^= (unsigned char)datos[i];
+        suma *= 0x100000001b3ULL;
+    }
+    return suma;
+}
+
+// Texto de la suma que se guarda al final del archivo, después del arreglo "ventas"
+void formatearSumaCuerpo(uint64_t suma, char texto[17]) {
+    snprintf(texto, 17, "%016llx", (unsigned long long)mezclar64(suma));
+}
 
 /*****Nombre***************************************
  * Función importarDatos
@@ -206,76 +886,115 @@ void reportarAtributosFaltantes(cJSON *item, int linea) {
  * del archivo, el parseo del contenido JSON y la 
  * adición de ventas a la lista. Reporta errores si no
  * se puede leer o parsear el archivo, y si falta algún
- * atributo en los objetos JSON.
+ * atributo en los objetos JSON. Si no hay memoria para
+ * agregar una venta, la lista queda como estaba antes
+ * de la importación, con sus diccionarios y bosquejos.
  *****Retorno**************************************
- * 
+ * @return: 1 si el archivo se importó (o estaba vacío),
+ *          0 si no se pudo leer, parsear o agregar.
  ****Entradas************************************** 
  * @param lista: Un puntero al struct `listaVentas` 
  *                donde se agregarán las ventas importadas.
  * @param path: Ruta del archivo JSON que contiene los datos 
  *               de ventas a importar.
  **************************************************/
-void importarDatos(listaVentas *lista, const char *path) {
+int importarDatos(listaVentas *lista, const char *path) {
+    inicioMetrica inicio = metricaInicio();
     char *contenido_json = leerArchivo(path);
     if (contenido_json == NULL) {
         printf("Error al leer el archivo JSON.\n");
-        return;
+        return 0;
     }
 
     // Verificar si el archivo está vacío
-    if (strlen(contenido_json) == 0) {
+    size_t bytes_leidos = strlen(contenido_json);
+    if (bytes_leidos == 0) {
         // El archivo está vacío, no hay nada que importar
         printf("El archivo JSON está vacío, no hay datos para importar.\n");
         free(contenido_json);
-        return;
+        return 1;
     }
 
-    cJSON *lista_json = cJSON_Parse(contenido_json);
-    if (lista_json == NULL) {
+    cJSON *raiz = cJSON_Parse(contenido_json);
+    // Los datos procesados son un objeto con el mapa de zonas y las ventas en "ventas"
+    cJSON *lista_json = cJSON_IsObject(raiz) ? cJSON_GetObjectItem(raiz, "ventas") : raiz;
+    if (!cJSON_IsArray(lista_json)) {
         printf("Error al parsear el archivo JSON.\n");
+        cJSON_Delete(raiz);
         free(contenido_json);
-        return;
+        return 0;
     }
+    // Se recuerda el tamaño de la lista y de los diccionarios para deshacerla si falla
+    size_t size_inicial = lista->size;
+    size_t productos_iniciales = lista->productos.num;
+    size_t categorias_iniciales = lista->categorias.num;
+
+    // Pre-dimensionar la lista con el largo del arreglo para evitar recopias
+    reservarListaVentas(lista, lista->size + cJSON_GetArraySize(lista_json));
 
     cJSON *item = NULL;
     int linea = 1;
     cJSON_ArrayForEach(item, lista_json) {
-        // Verificar si todos los campos obligatorios están presentes
-        if (!cJSON_HasObjectItem(item, "venta_id") ||
-            !cJSON_HasObjectItem(item, "fecha") ||
-            !cJSON_HasObjectItem(item, "producto_id") ||
-            !cJSON_HasObjectItem(item, "producto_nombre") ||
-            !cJSON_HasObjectItem(item, "categoria")) {
-            reportarAtributosFaltantes(item, linea);
+        // Verificar que estén todos los campos obligatorios y que sus tipos sean válidos
+        unsigned int rechazo = validarVenta(item);
+        if (rechazo != 0) {
+            reportarVentaRechazada(rechazo, linea);
+            linea++;
+            continue;
+        }
+        if (!ventaEnParticion(item)) {
             linea++;
             continue;
         }
 
-        Venta venta;
-        venta.venta_id = cJSON_GetObjectItem(item, "venta_id")->valueint;
-        venta.fecha = strdup(cJSON_GetObjectItem(item, "fecha")->valuestring);
-        venta.producto_id = cJSON_GetObjectItem(item, "producto_id")->valueint;
-        venta.producto_nombre = strdup(cJSON_GetObjectItem(item, "producto_nombre")->valuestring);
-        venta.categoria = strdup(cJSON_GetObjectItem(item, "categoria")->valuestring);
-        venta.cantidad = cJSON_GetObjectItem(item, "cantidad") ? cJSON_GetObjectItem(item, "cantidad")->valueint : 0;
-        venta.precio_unitario = cJSON_GetObjectItem(item, "precio_unitario") ? cJSON_GetObjectItem(item, "precio_unitario")->valuedouble : 0.0;
-        venta.total = cJSON_GetObjectItem(item, "total") ? cJSON_GetObjectItem(item, "total")->valuedouble : 0.0;
-
-        agregarVenta(lista, venta);
+        Venta venta = convertirVenta(item);
+        codificarVenta(lista, &venta, item);
+        if (!agregarVenta(lista, venta)) {
+            lista->size = size_inicial;
+            truncarDiccionario(&lista->productos, productos_iniciales);
+            truncarDiccionario(&lista->categorias, categorias_iniciales);
+            lista->generacion++;
+            cJSON_Delete(raiz);
+            free(contenido_json);
+            resumirDiagnosticos();
+            printf("Error al asignar memoria para las ventas importadas.\n");
+            return 0;
+        }
         linea++;
     }
 
-    cJSON_Delete(lista_json);
+    // Los bosquejos solo se actualizan cuando el archivo se importó completo, porque no se pueden deshacer
+    for (size_t i = size_inicial; i < lista->size; i++) {
+        registrarVentaImportada(lista, &lista->ventas[i]);
+    }
+
+    if (lista_json != raiz) {
+        cargarMapaZonas(lista, raiz, size_inicial);
+    }
+    cJSON_Delete(raiz);
     free(contenido_json);
 
+    resumirDiagnosticos();
+    metricaBytesLeidos(ETAPA_IMPORTAR, bytes_leidos);
+    metricaFin(ETAPA_IMPORTAR, inicio, linea - 1);
+
     printf("\nDatos importados correctamente.\n");
+    return 1;
 }
 
 /*****Nombre***************************************
  * Función guardarDatosProcesados
  *****Descripción**********************************
  * Guarda los datos de ventas procesados en un 
- * archivo JSON.
+ * archivo JSON: un objeto con el mapa de zonas
+ * (mapaZonasAJSON), la cantidad de filas y la suma de
+ * control de esa cabecera (sellarCabecera), el
+ * arreglo "ventas" y, al final, la suma de control del
+ * texto del arreglo ("suma_ventas"). Cada venta
+ * se convierte y se escribe por separado, sin armar el
+ * documento completo en memoria; si se configuró una compresión de salida
+ * (configurarCompresionSalida), el archivo se escribe
+ * comprimido.
  *****Retorno**************************************
  *
  ****Entradas************************************** 
@@ -285,51 +1004,99 @@ void importarDatos(listaVentas *lista, const char *path) {
  *              los datos.
  **************************************************/
 void guardarDatosProcesados(listaVentas *lista, const char *path) {
-    cJSON *jsonExistente = cJSON_CreateArray();
+    inicioMetrica inicio = metricaInicio();
 
-    // Añadir los datos de ventas procesados
-    for (size_t i = 0; i < lista->size; i++) {
+    // Guardar en el archivo (sobrescribir el contenido anterior)
+    escritorArchivo *archivo = abrirEscritor(path, compresion_salida);
+    if (archivo == NULL) {
+        // Manejo de errores: fallo al abrir el archivo
+        fprintf(stderr, "Error al abrir el archivo para escritura.\n");
+        return;
+    }
+
+    // La cabecera va primero para que la importación la lea antes que las ventas
+    cJSON *cabecera = mapaZonasAJSON(lista);
+    if (cabecera != NULL) {
+        sellarCabecera(cabecera, lista->size);
+    }
+    char *textoCabecera = cabecera != NULL ? cJSON_Print(cabecera) : NULL;
+    cJSON_Delete(cabecera);
+    if (textoCabecera == NULL) {
+        fprintf(stderr, "Error al convertir JSON a cadena.\n");
+        archivo->error = 1;
+    } else {
+        // Reabrir el objeto impreso para agregarle el arreglo de ventas
+        size_t largo = strrchr(textoCabecera, '}') - textoCabecera;
+        while (largo > 0 && isspace((unsigned char)textoCabecera[largo - 1])) largo--;
+        escribirEscritor(archivo, textoCabecera, largo);
+        free(textoCabecera);
+    }
+    // El texto del arreglo se escribe por partes y se acumula en su suma de control
+    uint64_t suma = SUMA_CUERPO_INICIAL;
+    escribirCadenaEscritor(archivo, ",\n\t\"ventas\": ");
+    escribirCadenaEscritor(archivo, "[");
+    suma = acumularSumaCuerpo(suma, "[", 1);
+    for (size_t i = 0; !archivo->error && i < lista->size; i++) {
         cJSON *ventaJSON = cJSON_CreateObject();
         cJSON_AddNumberToObject(ventaJSON, "venta_id", lista->ventas[i].venta_id);
-        cJSON_AddStringToObject(ventaJSON, "fecha", lista->ventas[i].fecha);
+        char fecha[16];
+        snprintf(fecha, sizeof(fecha), "%04d-%02d-%02d", lista->ventas[i].fecha / 10000, lista->ventas[i].fecha / 100 % 100, lista->ventas[i].fecha % 100);
+        cJSON_AddStringToObject(ventaJSON, "fecha", fecha);
         cJSON_AddNumberToObject(ventaJSON, "producto_id", lista->ventas[i].producto_id);
-        cJSON_AddStringToObject(ventaJSON, "producto_nombre", lista->ventas[i].producto_nombre);
-        cJSON_AddStringToObject(ventaJSON, "categoria", lista->ventas[i].categoria);
+        cJSON_AddStringToObject(ventaJSON, "producto_nombre", nombreProducto(lista, &lista->ventas[i]));
+        cJSON_AddStringToObject(ventaJSON, "categoria", nombreCategoria(lista, &lista->ventas[i]));
         cJSON_AddNumberToObject(ventaJSON, "cantidad", lista->ventas[i].cantidad);
-        cJSON_AddNumberToObject(ventaJSON, "precio_unitario", lista->ventas[i].precio_unitario);
-        cJSON_AddNumberToObject(ventaJSON, "total", lista->ventas[i].total);
-
-        cJSON_AddItemToArray(jsonExistente, ventaJSON);
+        cJSON_AddNumberToObject(ventaJSON, "precio_unitario", dineroADouble(lista->ventas[i].precio_unitario));
+        cJSON_AddNumberToObject(ventaJSON, "total", dineroADouble(lista->ventas[i].total));
+
+        // Convertir la venta a una cadena
+        char *jsonString = cJSON_Print(ventaJSON);
+        cJSON_Delete(ventaJSON);
+        if (jsonString == NULL) {
+            // Manejo de errores: fallo al convertir a cadena
+            fprintf(stderr, "Error al convertir JSON a cadena.\n");
+            archivo->error = 1;
+            break;
+        }
+        if (i > 0) {
+            escribirCadenaEscritor(archivo, ", ");
+            suma = acumularSumaCuerpo(suma, ", ", 2);
+        }
+        escribirCadenaEscritor(archivo, jsonString);
+        suma = acumularSumaCuerpo(suma, jsonString, strlen(jsonString));
+        free(jsonString);
     }
-
-    // Convertir el JSON modificado a una cadena
-    char *jsonString = cJSON_Print(jsonExistente);
-    if (jsonString == NULL) {
-        // Manejo de errores: fallo al convertir a cadena
-        fprintf(stderr, "Error al convertir JSON a cadena.\n");
-        cJSON_Delete(jsonExistente);
-        return;
+    escribirCadenaEscritor(archivo, "]");
+    suma = acumularSumaCuerpo(suma, "]", 1);
+
+    char texto_suma[17];
+    char cierre[64];
+    formatearSumaCuerpo(suma, texto_suma);
+    snprintf(cierre, sizeof(cierre), ",\n\t\"suma_ventas\": \"%s\"\n}\n", texto_suma);
+    escribirCadenaEscritor(archivo, cierre);
+
+    size_t bytes_escritos = 0;
+    if (!cerrarEscritor(archivo, &bytes_escritos)) {
+        fprintf(stderr, "Error al escribir el archivo %s.\n", path);
     }
+    metricaBytesEscritos(ETAPA_GUARDAR, bytes_escritos);
 
-    // Guardar en el archivo (sobrescribir el contenido anterior)
-    FILE *archivo = fopen(path, "w");
-    if (archivo != NULL) {
-        fputs(jsonString, archivo);
-        fclose(archivo);
-    } else {
-        // Manejo de errores: fallo al abrir el archivo
-        fprintf(stderr, "Error al abrir el archivo para escritura.\n");
-    }
+    metricaFin(ETAPA_GUARDAR, inicio, lista->size);
+}
 
-    // Liberar memoria
-    free(jsonString);
-    cJSON_Delete(jsonExistente);
+int compararEnteros(const void *a, const void *b) {
+    int x = *(const int *)a;
+    int y = *(const int *)b;
+    return (x > y) - (x < y);
 }
 
 /*****Nombre***************************************
  * Función calcularModa
  *****Descripción**********************************
- * Calcula la moda para una lista de enteros.
+ * Calcula la moda para una lista de enteros. Ordena una
+ * copia de los valores para contar frecuencias; ante un
+ * empate devuelve el primer valor del arreglo original 
+ * que tenga la frecuencia máxima.
  *****Retorno**************************************
  * @return: La moda de los enteros dados.
  ****Entradas************************************** 
@@ -339,84 +1106,163 @@ void guardarDatosProcesados(listaVentas *lista, const char *path) {
 int calcularModa(int *valores, size_t size) {
     if (size == 0) return 0;
 
-    int max_count, moda = valores[0];
+    int *ordenados = (int *)mallocContado(sizeof(int) * size);
+    if (ordenados == NULL) {
+        printf("Error al asignar memoria para calcular la moda.\n");
+        return valores[0];
+    }
+    memcpy(ordenados, valores, sizeof(int) * size);
+    qsort(ordenados, size, sizeof(int), compararEnteros);
+
+    // Frecuencia máxima según las corridas de valores iguales
+    size_t max_count = 0;
+    for (size_t i = 0; i < size; ) {
+        size_t j = i;
+        while (j < size && ordenados[j] == ordenados[i]) j++;
+        if (j - i > max_count) max_count = j - i;
+        i = j;
+    }
+
+    // Compactar al inicio los valores que alcanzan la frecuencia máxima (quedan ordenados)
+    size_t num_modas = 0;
+    for (size_t i = 0; i < size; ) {
+        size_t j = i;
+        while (j < size && ordenados[j] == ordenados[i]) j++;
+        if (j - i == max_count) ordenados[num_modas++] = ordenados[i];
+        i = j;
+    }
+
+    int moda = valores[0];
     for (size_t i = 0; i < size; i++) {
-        int count = 0;
-        for (size_t j = 0; j < size; j++) {
-            if (valores[i] == valores[j]) {
-                count++;
-            }
-        }
-        if (count > max_count) {
-            max_count = count;
+        if (bsearch(&valores[i], ordenados, num_modas, sizeof(int), compararEnteros) != NULL) {
             moda = valores[i];
+            break;
         }
     }
+
+    free(ordenados);
     return moda;
 }
 
 /*****Nombre***************************************
  * Función calcularMedia
  *****Descripción**********************************
- * Calcula la media para una lista de flotantes.
+ * Calcula la media de una lista de montos. La suma en
+ * punto fijo es exacta; solo se redondea la división.
  *****Retorno**************************************
- * @return: La media de los flotantes dados.
+ * @return: La media de los montos dados.
  ****Entradas************************************** 
- * @param valores: Un arreglo de flotantes.
+ * @param valores: Un arreglo de montos.
  * @param size: El tamaño del arreglo.
  **************************************************/
-float calcularMedia(float *valores, size_t size) {
-    if (size == 0) return 0.0f;
+dinero calcularMedia(const dinero *valores, size_t size) {
+    if (size == 0) return 0;
 
-    float suma = 0.0f;
+    dinero suma = 0;
     for (size_t i = 0; i < size; i++) {
         suma += valores[i];
     }
-    return suma / size;
+    return dividirDinero(suma, (int64_t)size);
 }
 
 /*****Nombre***************************************
- * Función calcularMediana
+ * Función seleccionarKesimo
  *****Descripción**********************************
- * Calcula la mediana para una lista de flotantes.
+ * Reordena parcialmente el arreglo (quickselect) de modo
+ * que `valores[k]` quede con el valor que tendría si el
+ * arreglo estuviera ordenado, los anteriores sean menores
+ * o iguales y los posteriores mayores o iguales. Tiempo
+ * lineal esperado, sin ordenar todo el arreglo.
  *****Retorno**************************************
- * @return: La mediana de los flotantes dados.
+ * @return: El k-ésimo menor valor.
  ****Entradas************************************** 
- * @param valores: Un arreglo de flotantes.
+ * @param valores: Un arreglo de enteros, por ejemplo
+ *                 montos en punto fijo (se reordena).
  * @param size: El tamaño del arreglo.
+ * @param k: Posición buscada (0 es el menor).
  **************************************************/
-float calcularMediana(float *valores, size_t size) {
-    if (size == 0) return 0.0f;
-
-    for (size_t i = 0; i < size - 1; i++) {
-        for (size_t j = i + 1; j < size; j++) {
-            if (valores[i] > valores[j]) {
-                float temp = valores[i];
+int64_t seleccionarKesimo(int64_t *valores, size_t size, size_t k) {
+    size_t izq = 0;
+    size_t der = size - 1;
+
+    while (izq < der) {
+        // Pivote: mediana de tres
+        size_t medio = izq + (der - izq) / 2;
+        int64_t a = valores[izq], b = valores[medio], c = valores[der];
+        int64_t pivote = (a < b) ? ((b < c) ? b : (a < c ? c : a)) : ((a < c) ? a : (b < c ? c : b));
+
+        size_t i = izq;
+        size_t j = der;
+        while (i <= j) {
+            while (valores[i] < pivote) i++;
+            while (valores[j] > pivote) j--;
+            if (i <= j) {
+                int64_t temp = valores[i];
                 valores[i] = valores[j];
                 valores[j] = temp;
+                i++;
+                if (j == 0) break;
+                j--;
             }
         }
+
+        if (k <= j) {
+            der = j;
+        } else if (k >= i) {
+            izq = i;
+        } else {
+            break;
+        }
     }
+    return valores[k];
+}
+
+/*****Nombre***************************************
+ * Función calcularMediana
+ *****Descripción**********************************
+ * Calcula la mediana de una lista de montos por
+ * selección, sin ordenar todo el arreglo. Con una
+ * cantidad par se promedian los dos centrales,
+ * redondeando al monto más cercano.
+ *****Retorno**************************************
+ * @return: La mediana de los montos dados.
+ ****Entradas************************************** 
+ * @param valores: Un arreglo de montos (se reordena).
+ * @param size: El tamaño del arreglo.
+ **************************************************/
+dinero calcularMediana(dinero *valores, size_t size) {
+    if (size == 0) return 0;
+
+    dinero superior = seleccionarKesimo(valores, size, size / 2);
     if (size % 2 == 0) {
-        return (valores[size / 2 - 1] + valores[size / 2]) / 2.0f;
+        // Tras la selección, el anterior en orden es el máximo de la parte izquierda
+        dinero inferior = valores[0];
+        for (size_t i = 1; i < size / 2; i++) {
+            if (valores[i] > inferior) inferior = valores[i];
+        }
+        return dividirDinero(inferior + superior, 2);
     } else {
-        return valores[size / 2];
+        return superior;
     }
 }
 
 /*****Nombre***************************************
- * Función completarDatosFaltantes
+ * Función completarDatosConMetodo
  *****Descripción**********************************
- * Completa los datos faltantes en la lista de ventas utilizando moda, media o mediana.
+ * Completa los datos faltantes en la lista de ventas utilizando moda, media o mediana,
+ * y deja calculado el total de cada registro. Si `metodo` es '1' (media) o '2' (mediana) se usa ese método para todos los
+ * precios faltantes; con cualquier otro valor se le pregunta al usuario por registro.
  *****Retorno**************************************
  * 
  ****Entradas************************************** 
  * @param lista: Un puntero al struct `listaVentas` 
  *                que contiene las ventas a procesar.
+ * @param metodo: Método de imputación de precios, o '\0' para preguntar.
  **************************************************/
-void completarDatos(listaVentas *lista) {
-    int *cantidades = (int *)malloc(sizeof(int) * lista->size);
-    float *precios = (float *)malloc(sizeof(float) * lista->size);
+void completarDatosConMetodo(listaVentas *lista, char metodo) {
+    inicioMetrica inicio = metricaInicio();
+    int *cantidades = (int *)mallocContado(sizeof(int) * lista->size);
+    dinero *precios = (dinero *)mallocContado(sizeof(dinero) * lista->size);
     size_t cantidadCount = 0;
     size_t precioCount = 0;
 
@@ -430,49 +1276,193 @@ void completarDatos(listaVentas *lista) {
         }
     }
 
+    // En modo silencioso se pregunta el método una sola vez para toda la etapa
+    size_t preciosFaltantes = lista->size - precioCount;
+    if (metodo != '1' && metodo != '2' && diagnosticosSilenciosos() && preciosFaltantes > 0) {
+        printf("\n%zu registros con precio unitario faltante. Seleccione el método de imputación:\n", preciosFaltantes);
+        printf("  1. Media\n");
+        printf("  2. Mediana\n");
+        printf("  Seleccione una opción: ");
+        scanf(" %c", &metodo);
+        if (metodo != '1' && metodo != '2') {
+            printf("\nOpción inválida. Usando media por defecto.\n");
+            metodo = '1';
+        }
+    }
+
+    // Los valores de imputación no cambian durante la etapa; se calculan una sola vez
+    int modaCantidad = 0;
+    dinero media = 0, mediana = 0;
+    int modaLista = 0, mediaLista = 0, medianaLista = 0;
+
     // Completar datos faltantes
     for (size_t i = 0; i < lista->size; i++) { 
         if (lista->ventas[i].cantidad <= 0) {
-            int modaCantidad = calcularModa(cantidades, cantidadCount);
+            if (!modaLista) {
+                modaCantidad = calcularModa(cantidades, cantidadCount);
+                modaLista = 1;
+            }
             lista->ventas[i].cantidad = modaCantidad;
-            printf("\nRegistro %d: cantidad reemplazada por moda %d\n", lista->ventas[i].venta_id, modaCantidad);
+            registrarDiagnostico(DIAG_CANTIDAD_IMPUTADA, "Registro %d: cantidad reemplazada por moda %d", lista->ventas[i].venta_id, modaCantidad);
         }
 
         if (lista->ventas[i].precio_unitario <= 0) {
-            char opcion;
-            printf("\nRegistro %d: Precio unitario faltante. Seleccione el método de imputación:\n", lista->ventas[i].venta_id);
-            printf("  1. Media\n");
-            printf("  2. Mediana\n");
-            printf("  Seleccione una opción: ");
-            scanf(" %c", &opcion);
-
-            float valor_imputado = 0.0f;
-            switch (opcion) {
-                case '1':
-                    valor_imputado = calcularMedia(precios, precioCount);
-                    printf("\nRegistro %d: precio unitario reemplazado por media %.2f\n", lista->ventas[i].venta_id, valor_imputado);
-                    break;
-                case '2':
-                    valor_imputado = calcularMediana(precios, precioCount);
-                    printf("\nRegistro %d: precio unitario reemplazado por mediana %.2f\n", lista->ventas[i].venta_id, valor_imputado);
-                    break;
-                default:
+            char opcion = metodo;
+            if (opcion != '1' && opcion != '2') {
+                vaciarDiagnosticos();
+                printf("\nRegistro %d: Precio unitario faltante. Seleccione el método de imputación:\n", lista->ventas[i].venta_id);
+                printf("  1. Media\n");
+                printf("  2. Mediana\n");
+                printf("  Seleccione una opción: ");
+                scanf(" %c", &opcion);
+                if (opcion != '1' && opcion != '2') {
                     printf("\nOpción inválida. Usando media por defecto.\n");
-                    valor_imputado = calcularMedia(precios, precioCount);
-                    printf("\nRegistro %d: precio unitario reemplazado por media %.2f\n", lista->ventas[i].venta_id, valor_imputado);
-                    break;
+                    opcion = '1';
+                }
+            }
+
+            dinero valor_imputado;
+            if (opcion == '2') {
+                if (!medianaLista) {
+                    // En modo aproximado la mediana sale del t-digest, sin ordenar los precios
+                    if (lista->bosquejos != NULL && lista->bosquejos->precios.peso_total + lista->bosquejos->precios.num_buffer > 0) {
+                        mediana = dineroDesdeDouble(cuantilTDigest(&lista->bosquejos->precios, 0.5));
+                    } else {
+                        mediana = calcularMediana(precios, precioCount);
+                    }
+                    medianaLista = 1;
+                }
+                valor_imputado = mediana;
+                registrarDiagnostico(DIAG_PRECIO_IMPUTADO, "Registro %d: precio unitario reemplazado por mediana %.2f", lista->ventas[i].venta_id, dineroADouble(valor_imputado));
+            } else {
+                if (!mediaLista) {
+                    media = calcularMedia(precios, precioCount);
+                    mediaLista = 1;
+                }
+                valor_imputado = media;
+                registrarDiagnostico(DIAG_PRECIO_IMPUTADO, "Registro %d: precio unitario reemplazado por media %.2f", lista->ventas[i].venta_id, dineroADouble(valor_imputado));
             }
             lista->ventas[i].precio_unitario = valor_imputado;
         }
+
+        // Igual que el canal de limpieza, el total queda calculado con los valores ya imputados
+        lista->ventas[i].total = importeVenta(&lista->ventas[i]);
     }
     free(cantidades);
     free(precios);
+    resumirDiagnosticos();
+    lista->generacion++;
+
+    metricaFin(ETAPA_COMPLETAR, inicio, lista->size);
+}
+
+/*****Nombre***************************************
+ * Función completarDatos
+ *****Descripción**********************************
+ * Completa los datos faltantes en la lista de ventas utilizando moda, media o mediana,
+ * preguntando al usuario el método de imputación para cada precio faltante.
+ *****Retorno**************************************
+ * 
+ ****Entradas************************************** 
+ * @param lista: Un puntero al struct `listaVentas` 
+ *                que contiene las ventas a procesar.
+ **************************************************/
+void completarDatos(listaVentas *lista) {
+    completarDatosConMetodo(lista, '\0');
+}
+
+/*****Nombre****************************************
+ * struct idVenta
+ *****Descripción***********************************
+ * Registro del ordenamiento externo de ids: al ordenar
+ * por id y posición, la primera aparición de cada id
+ * queda antes que sus duplicados.
+ *****Campos****************************************
+ * @indice: Posición de la venta en la lista.
+ * @venta_id: Identificador de la venta.
+ ***************************************************/
+typedef struct {
+    size_t indice;
+    int32_t venta_id;
+} idVenta;
+
+int compararIdsVenta(const void *a, const void *b) {
+    const idVenta *x = (const idVenta *)a;
+    const idVenta *y = (const idVenta *)b;
+    if (x->venta_id != y->venta_id) {
+        return (x->venta_id > y->venta_id) - (x->venta_id < y->venta_id);
+    }
+    return (x->indice > y->indice) - (x->indice < y->indice);
+}
+
+// Estado del recorrido ordenado de ids: marca cada id igual al anterior
+typedef struct {
+    unsigned char *duplicado;
+    int hay_anterior;
+    int32_t anterior;
+} marcaDuplicados;
+
+void marcarIdRepetido(void *contexto, const void *registro) {
+    marcaDuplicados *marca = (marcaDuplicados *)contexto;
+    const idVenta *id = (const idVenta *)registro;
+    if (marca->hay_anterior && marca->anterior == id->venta_id) {
+        marca->duplicado[id->indice / 8] |= (unsigned char)(1u << (id->indice % 8));
+    }
+    marca->hay_anterior = 1;
+    marca->anterior = id->venta_id;
+}
+
+/*****Nombre***************************************
+ * Función marcarDuplicadosExterno
+ *****Descripción**********************************
+ * Marca las ventas cuyo venta_id ya apareció en una
+ * posición anterior sin tener todos los ids en memoria:
+ * los pares (id, posición) se ordenan con corridas en
+ * archivos temporales dentro del presupuesto de memoria
+ * y se recorren en orden.
+ *****Retorno**************************************
+ * @return: Un bit por venta (1 si es duplicada), o NULL
+ *          si falló la memoria o un archivo temporal.
+ ****Entradas**************************************
+ * @param lista: Un puntero al struct `listaVentas`.
+ **************************************************/
+unsigned char* marcarDuplicadosExterno(listaVentas *lista) {
+    unsigned char *duplicado = (unsigned char *)callocContado(lista->size / 8 + 1, 1);
+    corridasOrdenadas corridas;
+    if (duplicado == NULL || !iniciarCorridas(&corridas, sizeof(idVenta), compararIdsVenta, presupuesto_memoria)) {
+        free(duplicado);
+        return NULL;
+    }
+
+    idVenta id;
+    memset(&id, 0, sizeof(id));
+    for (size_t i = 0; i < lista->size && !corridas.error; i++) {
+        id.indice = i;
+        id.venta_id = lista->ventas[i].venta_id;
+        agregarACorridas(&corridas, &id);
+    }
+    marcaDuplicados marca = { duplicado, 0, 0 };
+    int completo = mezclarCorridas(&corridas, marcarIdRepetido, &marca);
+
+    // Cada par se escribe en una corrida y se vuelve a leer en la mezcla
+    metricaBytesEscritos(ETAPA_DUPLICADOS, corridas.bytes_escritos);
+    metricaBytesLeidos(ETAPA_DUPLICADOS, corridas.bytes_escritos);
+    liberarCorridas(&corridas);
+    if (!completo) {
+        free(duplicado);
+        return NULL;
+    }
+    return duplicado;
 }
 
 /*****Nombre***************************************
  * Función eliminarDatosDuplicados
  *****Descripción**********************************
  * Elimina las ventas duplicadas basándose en el identificador de venta.
+ * Con un presupuesto de memoria configurado, los
+ * duplicados se marcan antes con marcarDuplicadosExterno,
+ * que ordena en memoria si los ids caben en el
+ * presupuesto y en corridas en disco si no.
  *****Retorno**************************************
  * 
  ****Entradas************************************** 
@@ -480,73 +1470,128 @@ void completarDatos(listaVentas *lista) {
  *                que contiene las ventas a procesar.
  **************************************************/
 void eliminarDatosDuplicados(listaVentas *lista) {
-    // Usar un arreglo para marcar si un ID de venta ya ha sido visto
-    int *ids_vistos = (int *)malloc(sizeof(int) * lista->size);
-    size_t count_ids = 0;
-    size_t i = 0;
+    inicioMetrica inicio = metricaInicio();
+    size_t filas = lista->size;
+    size_t sondeos = 0;
+
+    // Conjunto hash de los ids ya vistos (posición + 1 del registro conservado, 0 si la
+    // casilla está libre), o las marcas del ordenamiento externo si hay un presupuesto de memoria
+    size_t *ids_vistos = NULL;
+    size_t capacidad = 16;
+    unsigned char *marcas_externas = NULL;
+    if (presupuesto_memoria == 0) {
+        while (capacidad < lista->size * 2) capacidad *= 2;
+        ids_vistos = (size_t *)callocContado(capacidad, sizeof(size_t));
+    } else {
+        marcas_externas = marcarDuplicadosExterno(lista);
+    }
+    if (ids_vistos == NULL && marcas_externas == NULL) {
+        printf("Error al asignar memoria para eliminar los duplicados.\n");
+        return;
+    }
+    size_t mascara = capacidad - 1;
     
     printf("\n");
     
-    while (i < lista->size) {
+    // Compactación estable en una sola pasada: los registros conservados se copian a `destino`
+    size_t destino = 0;
+    for (size_t i = 0; i < lista->size; i++) {
         int id_actual = lista->ventas[i].venta_id;
         int duplicado = 0;
+        size_t casilla = 0;
 
-        for (size_t j = 0; j < count_ids; j++) {
-            if (ids_vistos[j] == id_actual) {
-                duplicado = 1;
-                break;
+        if (marcas_externas != NULL) {
+            duplicado = (marcas_externas[i / 8] >> (i % 8)) & 1;
+        } else {
+            casilla = mezclar64((uint32_t)id_actual) & mascara;
+            while (ids_vistos[casilla] != 0) {
+                sondeos++;
+                if (lista->ventas[ids_vistos[casilla] - 1].venta_id == id_actual) {
+                    duplicado = 1;
+                    break;
+                }
+                casilla = (casilla + 1) & mascara;
             }
         }
 
         if (duplicado) {
-            printf("Se eliminó el registro duplicado con venta ID %d\n", id_actual);
-            // Desplazar todos los elementos hacia la izquierda
-            for (size_t k = i; k < lista->size - 1; k++) {
-                lista->ventas[k] = lista->ventas[k + 1];
-            }
-            lista->size--;
+            registrarDiagnostico(DIAG_DUPLICADO, "Se eliminó el registro duplicado con venta ID %d", id_actual);
         } else {
-            ids_vistos[count_ids++] = id_actual;
-            i++;
+            lista->ventas[destino++] = lista->ventas[i];
+            if (ids_vistos != NULL) {
+                ids_vistos[casilla] = destino;
+            }
         }
     }
+    lista->size = destino;
+    lista->generacion++;
 
     free(ids_vistos);
+    free(marcas_externas);
+    resumirDiagnosticos();
+
+    metricaSondeos(ETAPA_DUPLICADOS, sondeos);
+    metricaFin(ETAPA_DUPLICADOS, inicio, filas);
+}
+
+// Reducción de totalVentas: el parcial es la suma de importes de un rango de ventas
+void iniciarSumaImportes(void *contexto, void *parcial) {
+    (void)contexto;
+    *(dinero *)parcial = 0;
+}
+
+void sumarImportes(void *contexto, size_t desde, size_t hasta, void *parcial) {
+    const Venta *ventas = ((listaVentas *)contexto)->ventas;
+    dinero suma = 0;
+    for (size_t i = desde; i < hasta; i++) {
+        suma += importeVenta(&ventas[i]);
+    }
+    *(dinero *)parcial += suma;
+}
+
+void combinarSumaImportes(void *contexto, void *destino, const void *origen) {
+    (void)contexto;
+    *(dinero *)destino += *(const dinero *)origen;
 }
 
 /*****Nombre***************************************
  * Función totalVentas
  *****Descripción**********************************
  * Calcula el total de ventas sumando el importe de cada venta.
+ * La suma se reparte en bloques entre hilos (reduccion.h);
+ * el resultado no depende de la cantidad de hilos.
  *****Retorno**************************************
  * @return: El total de ventas.
  ****Entradas************************************** 
  * @param lista: Un puntero al struct `listaVentas` 
  *                que contiene las ventas a procesar.
  **************************************************/
-float totalVentas(listaVentas *lista) {
+dinero totalVentas(listaVentas *lista) {
     // Verificar que la lista no sea nula
     if (lista == NULL) {
         printf("Error: La lista de ventas no está inicializada.\n");
-        return 0.0f;
+        return 0;
     }
 
-    float total = 0.0f;
+    inicioMetrica inicio = metricaInicio();
+    dinero total = 0;
 
-    // Iterar sobre las ventas para calcular el total
-    for (size_t i = 0; i < lista->size; i++) {
-        if (lista->ventas[i].total != 0.0f) {
-            // Si el total de la venta ya está calculado, usarlo
-            total += lista->ventas[i].total;
-        } else {
-            // Calcular el total a partir de la cantidad y el precio unitario
-            total += lista->ventas[i].cantidad * lista->ventas[i].precio_unitario;
-        }
+    // Sumar el importe de cada venta (el total de la venta, o cantidad por precio)
+    reduccionDeterminista reduccion = { lista->size, sizeof(dinero), lista, iniciarSumaImportes, sumarImportes, combinarSumaImportes, NULL };
+    if (!reducirEnBloques(&reduccion, 0, &total)) {
+        sumarImportes(lista, 0, lista->size, &total);
     }
 
+    metricaFin(ETAPA_TOTAL, inicio, lista->size);
     return total;
 }
 
+// Nombres de los meses, en el orden del calendario
+const char *nombres_meses[] = {
+    "Enero", "Febrero", "Marzo", "Abril", "Mayo", "Junio",
+    "Julio", "Agosto", "Septiembre", "Octubre", "Noviembre", "Diciembre"
+};
+
 /*****Nombre***************************************
  * Función totalVentasMensuales
  *****Descripción**********************************
@@ -556,44 +1601,35 @@ float totalVentas(listaVentas *lista) {
  ****Entradas************************************** 
  * @param lista: Un puntero al struct `listaVentas` que contiene las ventas a procesar.
  * @param meses_totales: Un puntero a un array de cadenas de texto para almacenar los nombres de los meses.
- * @param totales_mensuales: Un puntero a un array de flotantes para almacenar los totales de ventas por mes.
+ * @param totales_mensuales: Un puntero a un array de montos para almacenar los totales de ventas por mes.
  * @param num_meses: Un puntero a un entero que contendrá la cantidad de meses únicos encontrados.
  **************************************************/
-void totalVentasMensuales(listaVentas *lista, char ***meses_totales, float **totales_mensuales, size_t *num_meses) {
+void totalVentasMensuales(listaVentas *lista, char ***meses_totales, dinero **totales_mensuales, size_t *num_meses) {
     if (lista == NULL) {
         printf("Error: la lista de ventas no está inicializada.\n");
         return;
     }
 
-    const char *nombres_meses[] = {
-        "Enero", "Febrero", "Marzo", "Abril", "Mayo", "Junio",
-        "Julio", "Agosto", "Septiembre", "Octubre", "Noviembre", "Diciembre"
-    };
+    inicioMetrica inicio = metricaInicio();
+    size_t sondeos = 0;
 
     *meses_totales = NULL;
     *totales_mensuales = NULL;
     *num_meses = 0;
 
     for (size_t i = 0; i < lista->size; i++) {
-        char *fecha = lista->ventas[i].fecha;
-        
-        // Extraer el año y el mes de la fecha en formato "YYYY-MM-DD"
-        char anio[5];
-        char mes_numero[3];
-        strncpy(anio, fecha, 4);
-        anio[4] = '\0';
-        strncpy(mes_numero, fecha + 5, 2);
-        mes_numero[2] = '\0';
-
-        int mes_index = atoi(mes_numero) - 1; 
+        // Extraer el año y el mes de la fecha AAAAMMDD
+        int anio = lista->ventas[i].fecha / 10000;
+        int mes_index = lista->ventas[i].fecha / 100 % 100 - 1;
 
         // Construir la cadena con el nombre del mes y el año ("Mes YYYY")
         char mes_nombre[20];
-        snprintf(mes_nombre, sizeof(mes_nombre), "%s %s", nombres_meses[mes_index], anio);
+        snprintf(mes_nombre, sizeof(mes_nombre), "%s %04d", nombres_meses[mes_index], anio);
 
         // Verificar si el mes ya está en la lista de meses_totales
         int mes_existente = -1;
         for (size_t j = 0; j < *num_meses; j++) {
+            sondeos++;
             if (strcmp((*meses_totales)[j], mes_nombre) == 0) {
                 mes_existente = j;
                 break;
@@ -602,18 +1638,21 @@ void totalVentasMensuales(listaVentas *lista, char ***meses_totales, float **tot
 
         // Si el mes no está en la lista, agregarlo
         if (mes_existente == -1) {
-            *meses_totales = (char **)realloc(*meses_totales, (*num_meses + 1) * sizeof(char *));
-            (*meses_totales)[*num_meses] = strdup(mes_nombre);
+            *meses_totales = (char **)reallocContado(*meses_totales, (*num_meses + 1) * sizeof(char *));
+            (*meses_totales)[*num_meses] = strdupContado(mes_nombre);
 
-            *totales_mensuales = (float *)realloc(*totales_mensuales, (*num_meses + 1) * sizeof(float));
-            (*totales_mensuales)[*num_meses] = 0.0f;
+            *totales_mensuales = (dinero *)reallocContado(*totales_mensuales, (*num_meses + 1) * sizeof(dinero));
+            (*totales_mensuales)[*num_meses] = 0;
 
             mes_existente = (*num_meses)++;
         }
 
-        float total = (lista->ventas[i].total != 0.0f) ? lista->ventas[i].total : (lista->ventas[i].cantidad * lista->ventas[i].precio_unitario);
+        dinero total = importeVenta(&lista->ventas[i]);
         (*totales_mensuales)[mes_existente] += total;
     }
+
+    metricaSondeos(ETAPA_MENSUAL, sondeos);
+    metricaFin(ETAPA_MENSUAL, inicio, lista->size);
 }
 
 
@@ -626,27 +1665,31 @@ void totalVentasMensuales(listaVentas *lista, char ***meses_totales, float **tot
  ****Entradas************************************** 
  * @param lista: Un puntero al struct `listaVentas` que contiene las ventas a procesar.
  * @param años_totales: Un puntero a un array de cadenas de texto para almacenar los años.
- * @param totales_anuales: Un puntero a un array de flotantes para almacenar los totales de ventas por año.
+ * @param totales_anuales: Un puntero a un array de montos para almacenar los totales de ventas por año.
  * @param num_años: Un puntero a un entero que contendrá la cantidad de años únicos encontrados.
  **************************************************/
-void totalVentasAnuales(listaVentas *lista, char ***años_totales, float **totales_anuales, size_t *num_años) {
+void totalVentasAnuales(listaVentas *lista, char ***años_totales, dinero **totales_anuales, size_t *num_años) {
     if (lista == NULL) {
         printf("Error: La lista de ventas no está inicializada.\n");
         return;
     }
 
+    inicioMetrica inicio = metricaInicio();
+    size_t sondeos = 0;
+
     *años_totales = NULL;
     *totales_anuales = NULL;
     *num_años = 0;
 
     for (size_t i = 0; i < lista->size; i++) {
         // Obtener el año de la fecha en formato "YYYY"
-        char *fecha = lista->ventas[i].fecha;
-        char *año = strndup(fecha, 4); 
+        char año[8];
+        snprintf(año, sizeof(año), "%04d", lista->ventas[i].fecha / 10000);
 
         // Verificar si el año ya está en la lista de años_totales
         int año_existente = -1;
         for (size_t j = 0; j < *num_años; j++) {
+            sondeos++;
             if (strcmp((*años_totales)[j], año) == 0) {
                 año_existente = j;
                 break;
@@ -655,20 +1698,21 @@ void totalVentasAnuales(listaVentas *lista, char ***años_totales, float **total
 
         // Si el año no está en la lista, agregarlo
         if (año_existente == -1) {
-            *años_totales = (char **)realloc(*años_totales, (*num_años + 1) * sizeof(char *));
-            (*años_totales)[*num_años] = año;
+            *años_totales = (char **)reallocContado(*años_totales, (*num_años + 1) * sizeof(char *));
+            (*años_totales)[*num_años] = strdupContado(año);
 
-            *totales_anuales = (float *)realloc(*totales_anuales, (*num_años + 1) * sizeof(float));
-            (*totales_anuales)[*num_años] = 0.0f;
+            *totales_anuales = (dinero *)reallocContado(*totales_anuales, (*num_años + 1) * sizeof(dinero));
+            (*totales_anuales)[*num_años] = 0;
 
             año_existente = (*num_años)++;
-        } else {
-            free(año); 
         }
 
-        float total = (lista->ventas[i].total != 0.0f) ? lista->ventas[i].total : (lista->ventas[i].cantidad * lista->ventas[i].precio_unitario);
+        dinero total = importeVenta(&lista->ventas[i]);
         (*totales_anuales)[año_existente] += total;
     }
+
+    metricaSondeos(ETAPA_ANUAL, sondeos);
+    metricaFin(ETAPA_ANUAL, inicio, lista->size);
 }
 
 /*****Nombre***************************************
@@ -684,8 +1728,9 @@ void totalVentasAnuales(listaVentas *lista, char ***años_totales, float **total
  * que contiene las ventas a procesar.
  **************************************************/
 char* mesConMayorVenta(listaVentas *lista) {
+    inicioMetrica inicio = metricaInicio();
     char **meses_totales = NULL;
-    float *totales_mensuales = NULL;
+    dinero *totales_mensuales = NULL;
     size_t num_meses = 0;
     totalVentasMensuales(lista, &meses_totales, &totales_mensuales, &num_meses);
 
@@ -703,7 +1748,7 @@ char* mesConMayorVenta(listaVentas *lista) {
 
     // Formatear el resultado
     static char resultado[50];
-    snprintf(resultado, sizeof(resultado), "%s - Total: %.2f", meses_totales[i_mayorVenta], totales_mensuales[i_mayorVenta]);
+    snprintf(resultado, sizeof(resultado), "%s - Total: %.2f", meses_totales[i_mayorVenta], dineroADouble(totales_mensuales[i_mayorVenta]));
 
     // Liberar memoria
     for (size_t i = 0; i < num_meses; i++) {
@@ -712,9 +1757,23 @@ char* mesConMayorVenta(listaVentas *lista) {
     free(meses_totales);
     free(totales_mensuales);
 
+    metricaFin(ETAPA_MES_MAYOR, inicio, lista->size);
     return resultado;
 }
 
+// Nombres de los días de la semana, según `tm_wday` (0 = domingo)
+const char *nombres_dias[] = {
+    "Domingo", "Lunes", "Martes", "Miércoles", "Jueves", "Viernes", "Sábado"
+};
+
+// Cuenta las transacciones de cada día de la semana (índice `tm_wday`)
+void contarTransaccionesPorDia(listaVentas *lista, int transacciones_dias[7]) {
+    memset(transacciones_dias, 0, sizeof(int) * 7);
+    for (size_t i = 0; i < lista->size; i++) {
+        transacciones_dias[diaSemanaDeFecha(lista->ventas[i].fecha)]++;
+    }
+}
+
 /*****Nombre***************************************
  * Función diaMasActivo
  *****Descripción**********************************
@@ -732,26 +1791,9 @@ char* diaMasActivo(listaVentas *lista) {
         return "Error: la lista de ventas no está inicializada.";
     }
 
-    const char *nombres_dias[] = {
-        "Domingo", "Lunes", "Martes", "Miércoles", "Jueves", "Viernes", "Sábado"
-    };
-    int transacciones_dias[7] = {0}; 
-
-    for (size_t i = 0; i < lista->size; i++) {
-        char *fecha = lista->ventas[i].fecha;
-
-        // Extraer año, mes y día
-        struct tm tiempo = {0};
-        sscanf(fecha, "%4d-%2d-%2d", &tiempo.tm_year, &tiempo.tm_mon, &tiempo.tm_mday);
-        tiempo.tm_year -= 1900; // Ajustar para el tipo tm
-        tiempo.tm_mon -= 1;     // Ajustar del rango de meses (0-11)
-
-        // Determinar el día de la semana
-        mktime(&tiempo); 
-        int dia_semana = tiempo.tm_wday; // 'tm_wday' es el día de la semana (0=domingo, 6=sábado)
-
-        transacciones_dias[dia_semana]++;
-    }
+    int transacciones_dias[7];
+    inicioMetrica inicio = metricaInicio();
+    contarTransaccionesPorDia(lista, transacciones_dias);
 
     // Encontrar el día de la semana con más transacciones
     int dia_mas_activo = 0;
@@ -765,44 +1807,58 @@ char* diaMasActivo(listaVentas *lista) {
     static char resultado[50];
     snprintf(resultado, sizeof(resultado), "%s - Total de transacciones: %d", nombres_dias[dia_mas_activo], transacciones_dias[dia_mas_activo]);
 
+    metricaFin(ETAPA_DIA_ACTIVO, inicio, lista->size);
     return resultado;
 }
 
 /*****Nombre***************************************
- * Función tasaCrecimientoTrimestral
+ * Función sumarTrimestres
  *****Descripción**********************************
- * Calcula la tasa de crecimiento o decrecimiento de las 
- * ventas en un trimestre específico en comparación con 
- * el trimestre anterior.
+ * Suma las ventas de un trimestre y del trimestre
+ * anterior. Los bloques cuyo rango de fechas (mapa de
+ * zonas) no toca ninguno de los dos se saltan.
  *****Retorno**************************************
- * Retorna la tasa de crecimiento o decrecimiento en porcentaje.
+ *
  ****Entradas************************************** 
  * @param lista: Un puntero al struct `listaVentas` que contiene las ventas a procesar.
- * @param trimestre: Un entero que representa el trimestre a analizar (1, 2, 3 o 4).
- * @param anio: Un entero que representa el año del trimestre a analizar.
+ * @param trimestre: Trimestre a analizar (1, 2, 3 o 4).
+ * @param anio: Año del trimestre.
+ * @param actual: Recibe el total del trimestre.
+ * @param anterior: Recibe el total del trimestre anterior.
  **************************************************/
-float tasaCrecimientoTrimestral(listaVentas *lista, int trimestre, int anio) {
-    if (lista == NULL) {
-        printf("Error: La lista de ventas no está inicializada.\n");
-        return 0.0f;
-    }
-
-    float total_actual = 0.0f;
-    float total_anterior = 0.0f;
+void sumarTrimestres(listaVentas *lista, int trimestre, int anio, dinero *actual, dinero *anterior) {
+    inicioMetrica inicio = metricaInicio();
+    dinero total_actual = 0;
+    dinero total_anterior = 0;
 
     // Definir el rango de meses para el trimestre actual y anterior
     int mes_inicio_actual = (trimestre - 1) * 3 + 1; // Mes de inicio del trimestre actual
     int mes_fin_actual = trimestre * 3;              // Mes de fin del trimestre actual
     int mes_inicio_anterior = mes_inicio_actual - 3; // Mes de inicio del trimestre anterior
 
+    // Rango AAAAMMDD que cubre ambos trimestres, para descartar bloques
+    int fecha_desde = (trimestre == 1) ? (anio - 1) * 10000 + 1001 : anio * 10000 + mes_inicio_anterior * 100 + 1;
+    int fecha_hasta = anio * 10000 + mes_fin_actual * 100 + 31;
+    int usar_zonas = actualizarMapaZonas(lista);
+    size_t revisadas = 0;
+
     // Calcular totales del trimestre actual y anterior
     for (size_t i = 0; i < lista->size; i++) {
+        // Una zona con fecha_min 0 (mapa guardado con fechas sin validar) no se salta
+        if (usar_zonas && i % FILAS_POR_ZONA == 0) {
+            const zonaVentas *zona = &lista->zonas.zonas[i / FILAS_POR_ZONA];
+            if (zona->fecha_min > 0 && (zona->fecha_max < fecha_desde || zona->fecha_min > fecha_hasta)) {
+                i += FILAS_POR_ZONA - 1;
+                continue;
+            }
+        }
+        revisadas++;
+
         // Extraer el año y el mes de la fecha
-        char *fecha = lista->ventas[i].fecha;
-        int anio_venta, mes_venta;
-        sscanf(fecha, "%d-%d", &anio_venta, &mes_venta);
+        int anio_venta = lista->ventas[i].fecha / 10000;
+        int mes_venta = lista->ventas[i].fecha / 100 % 100;
 
-        float total = (lista->ventas[i].total != 0.0f) ? lista->ventas[i].total : (lista->ventas[i].cantidad * lista->ventas[i].precio_unitario);
+        dinero total = importeVenta(&lista->ventas[i]);
 
         // Acumular total para el trimestre actual
         if (anio_venta == anio && mes_venta >= mes_inicio_actual && mes_venta <= mes_fin_actual) {
@@ -818,64 +1874,135 @@ float tasaCrecimientoTrimestral(listaVentas *lista, int trimestre, int anio) {
         }
     }
 
-    // Calcular la tasa de crecimiento
-    if (total_anterior == 0.0f) {
+    metricaFin(ETAPA_TASA_CRECIMIENTO, inicio, revisadas);
+    *actual = total_actual;
+    *anterior = total_anterior;
+}
+
+/*****Nombre***************************************
+ * Función informarTasaCrecimiento
+ *****Descripción**********************************
+ * Calcula la tasa de crecimiento a partir de los totales
+ * de dos trimestres e imprime el resultado, o el aviso
+ * de datos insuficientes si el trimestre anterior no
+ * tiene ventas.
+ *****Retorno**************************************
+ * Retorna la tasa en porcentaje, o 0 sin datos suficientes.
+ ****Entradas**************************************
+ * @param trimestre: Trimestre analizado (1, 2, 3 o 4).
+ * @param anio: Año del trimestre analizado.
+ * @param total_actual: Total de ventas del trimestre.
+ * @param total_anterior: Total de ventas del trimestre anterior.
+ **************************************************/
+float informarTasaCrecimiento(int trimestre, int anio, dinero total_actual, dinero total_anterior) {
+    if (total_anterior == 0) {
         printf("No hay datos suficientes para calcular la tasa de crecimiento.\n");
         return 0.0f;
     }
 
-    float tasa_crecimiento = ((total_actual - total_anterior) / total_anterior) * 100.0f;
+    float tasa_crecimiento = (float)((double)(total_actual - total_anterior) / total_anterior * 100.0);
 
     printf("Tasa de crecimiento para el trimestre %d del año %d: %.2f%%\n", trimestre, anio, tasa_crecimiento);
     return tasa_crecimiento;
 }
 
 /*****Nombre***************************************
- * Función obtenerTopCategorias
+ * Función tasaCrecimientoTrimestral
  *****Descripción**********************************
- * Calcula las ventas totales por categoría y muestra 
- * el top 5 de categorías con mayores ventas.
+ * Calcula la tasa de crecimiento o decrecimiento de las 
+ * ventas en un trimestre específico en comparación con 
+ * el trimestre anterior.
  *****Retorno**************************************
- * No retorna valor. Imprime el top 5 de categorías en consola.
+ * Retorna la tasa de crecimiento o decrecimiento en porcentaje.
  ****Entradas************************************** 
  * @param lista: Un puntero al struct `listaVentas` que contiene las ventas a procesar.
+ * @param trimestre: Un entero que representa el trimestre a analizar (1, 2, 3 o 4).
+ * @param anio: Un entero que representa el año del trimestre a analizar.
  **************************************************/
-void obtenerTopCategorias(listaVentas *lista) {
-    if (lista == NULL || lista->size == 0) {
-        printf("No hay datos de ventas disponibles.\n");
-        return;
+float tasaCrecimientoTrimestral(listaVentas *lista, int trimestre, int anio) {
+    if (lista == NULL) {
+        printf("Error: La lista de ventas no está inicializada.\n");
+        return 0.0f;
     }
 
-    // struct para almacenar las ventas totales por categoría
-    CategoriaVenta *categorias = NULL;
-    size_t numCategorias = 0;
+    dinero total_actual, total_anterior;
+    sumarTrimestres(lista, trimestre, anio, &total_actual, &total_anterior);
+    return informarTasaCrecimiento(trimestre, anio, total_actual, total_anterior);
+}
 
-    // Calcular ventas totales por categoria
-    for (size_t i = 0; i < lista->size; i++) {
-        char *categoriaActual = lista->ventas[i].categoria;
-        float totalVenta = (lista->ventas[i].total != 0.0f) ? lista->ventas[i].total : (lista->ventas[i].cantidad * lista->ventas[i].precio_unitario);
+// Reducción de obtenerTopCategorias: el parcial tiene el total y la cantidad de ventas
+// de cada código de categoría, con una posición extra para los códigos inválidos
+void iniciarTotalesCategoria(void *contexto, void *parcial) {
+    memset(parcial, 0, sizeof(dinero) * 2 * (((listaVentas *)contexto)->categorias.num + 1));
+}
 
-        int categoriaExistente = -1;
-        for (size_t j = 0; j < numCategorias; j++) {
-            if (strcmp(categorias[j].categoria, categoriaActual) == 0) {
-                categoriaExistente = j;
-                break;
-            }
-        }
+void sumarTotalesCategoria(void *contexto, size_t desde, size_t hasta, void *parcial) {
+    listaVentas *lista = (listaVentas *)contexto;
+    size_t numCodigos = lista->categorias.num;
+    dinero *totales = (dinero *)parcial;
+    dinero *conteos = totales + numCodigos + 1;
+    for (size_t i = desde; i < hasta; i++) {
+        codigoCadena codigo = lista->ventas[i].codigo_categoria;
+        size_t posicion = (codigo < numCodigos) ? codigo : numCodigos;
+        totales[posicion] += importeVenta(&lista->ventas[i]);
+        conteos[posicion]++;
+    }
+}
 
-        // Si la categoria no existe, agregarla
-        if (categoriaExistente == -1) {
-            categorias = (CategoriaVenta *)realloc(categorias, (numCategorias + 1) * sizeof(CategoriaVenta));
-            categorias[numCategorias].categoria = strdup(categoriaActual);
-            categorias[numCategorias].totalVentas = totalVenta;
-            numCategorias++; 
-        } else {
-            categorias[categoriaExistente].totalVentas += totalVenta;
+void combinarTotalesCategoria(void *contexto, void *destino, const void *origen) {
+    size_t num = 2 * (((listaVentas *)contexto)->categorias.num + 1);
+    for (size_t c = 0; c < num; c++) {
+        ((dinero *)destino)[c] += ((const dinero *)origen)[c];
+    }
+}
+
+/*****Nombre***************************************
+ * Función calcularTotalesCategorias
+ *****Descripción**********************************
+ * Calcula las ventas totales de cada categoría con
+ * ventas y las ordena de mayor a menor.
+ *****Retorno**************************************
+ * @return: Arreglo de categorías (el llamador lo libera),
+ *          o NULL si falla la asignación de memoria.
+ ****Entradas************************************** 
+ * @param lista: Un puntero al struct `listaVentas` que contiene las ventas a procesar.
+ * @param num_categorias: Recibe la cantidad de categorías.
+ **************************************************/
+CategoriaVenta* calcularTotalesCategorias(listaVentas *lista, size_t *num_categorias) {
+    inicioMetrica inicio = metricaInicio();
+    *num_categorias = 0;
+
+    // Total por código de categoría: la agrupación es un acceso directo al arreglo
+    size_t numCodigos = lista->categorias.num;
+    dinero *totales = (dinero *)mallocContado(sizeof(dinero) * 2 * (numCodigos + 1));
+    CategoriaVenta *categorias = (CategoriaVenta *)mallocContado(sizeof(CategoriaVenta) * (numCodigos + 1));
+    if (totales == NULL || categorias == NULL) {
+        printf("Error al asignar memoria para las categorías.\n");
+        free(totales);
+        free(categorias);
+        return NULL;
+    }
+
+    // Calcular ventas totales por categoria, repartiendo la lista en bloques entre hilos
+    reduccionDeterminista reduccion = { lista->size, sizeof(dinero) * 2 * (numCodigos + 1), lista,
+                                        iniciarTotalesCategoria, sumarTotalesCategoria, combinarTotalesCategoria, NULL };
+    if (!reducirEnBloques(&reduccion, 0, totales)) {
+        iniciarTotalesCategoria(lista, totales);
+        sumarTotalesCategoria(lista, 0, lista->size, totales);
+    }
+
+    size_t numCategorias = 0;
+    for (size_t c = 0; c <= numCodigos; c++) {
+        if (totales[numCodigos + 1 + c] > 0) {
+            categorias[numCategorias].codigo = (c < numCodigos) ? (codigoCadena)c : CODIGO_INVALIDO;
+            categorias[numCategorias].totalVentas = totales[c];
+            numCategorias++;
         }
     }
+    free(totales);
 
     // Aplicar Bubble sort descendente
-    for (size_t i = 0; i < numCategorias - 1; i++) {
+    for (size_t i = 0; i + 1 < numCategorias; i++) {
         for (size_t j = i; j < numCategorias; j++) {
             if (categorias[i].totalVentas < categorias[j].totalVentas) {
                 CategoriaVenta temp = categorias[i];
@@ -885,16 +2012,40 @@ void obtenerTopCategorias(listaVentas *lista) {
         }
     }
 
+    metricaFin(ETAPA_TOP_CATEGORIAS, inicio, lista->size);
+    *num_categorias = numCategorias;
+    return categorias;
+}
+
+/*****Nombre***************************************
+ * Función obtenerTopCategorias
+ *****Descripción**********************************
+ * Calcula las ventas totales por categoría y muestra 
+ * el top 5 de categorías con mayores ventas.
+ *****Retorno**************************************
+ * No retorna valor. Imprime el top 5 de categorías en consola.
+ ****Entradas************************************** 
+ * @param lista: Un puntero al struct `listaVentas` que contiene las ventas a procesar.
+ **************************************************/
+void obtenerTopCategorias(listaVentas *lista) {
+    if (lista == NULL || lista->size == 0) {
+        printf("No hay datos de ventas disponibles.\n");
+        return;
+    }
+
+    size_t numCategorias;
+    CategoriaVenta *categorias = calcularTotalesCategorias(lista, &numCategorias);
+    if (categorias == NULL) {
+        return;
+    }
+
     // Mostrar el Top 5 de categorías con mayores ventas
     printf("Top 5 de categorías con mayores ventas:\n");
     for (size_t i = 0; i < (numCategorias < 5 ? numCategorias : 5); i++) {
-        printf("%zu) %-30s - Total Ventas: %.2f\n", i + 1, categorias[i].categoria, categorias[i].totalVentas);
+        printf("%zu) %-30s - Total Ventas: %.2f\n", i + 1, cadenaDeCodigo(&lista->categorias, categorias[i].codigo), dineroADouble(categorias[i].totalVentas));
     }
 
     // Liberar memoria
-    for (size_t i = 0; i < numCategorias; i++) {
-        free(categorias[i].categoria);
-    }
     free(categorias);
 }
 
@@ -0,0 +1,497 @@
+#ifndef VERSIONES_H
+#define VERSIONES_H
+
+/*****Datos administrativos************************
+ * Nombre del archivo: versiones
+ * Tipo de archivo: C Encabezado
+ * Proyecto: Sistema de Análisis de Datos de Ventas
+ *****Descripción**********************************
+ * Almacén de ventas versionado, para importar lotes
+ * nuevos mientras otros hilos calculan reportes.
+ *
+ * Cada versión es una `listaVentas` inmutable: los
+ * reportes de siempre se ejecutan sobre ella sin
+ * cambios. Las ventas viven en un arreglo compartido
+ * al que solo se agregan filas al final; una versión
+ * ve únicamente sus primeras `size` filas, así que
+ * agregar filas no la altera. Los diccionarios se
+ * comparten de la misma forma: una versión solo usa los
+ * códigos menores que su cantidad de cadenas, y un lote
+ * con cadenas nuevas solo rehace la tabla hash. Cada
+ * versión tiene su copia del mapa de zonas.
+ *
+ * Un lote se publica armando la versión siguiente y
+ * reemplazando el puntero vigente con una escritura
+ * atómica. Los lectores no toman candados: anuncian la
+ * época en que empezaron y leen el puntero vigente
+ * (reclamación por épocas). Una versión reemplazada,
+ * y el arreglo que dejó de usarse al crecer, se liberan
+ * cuando ya no queda ningún lector de una época anterior
+ * a su retiro.
+ **************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include "ventas.h"
+#include "importacion.h"
+
+#define MAX_LECTORES MAX_HILOS
+
+/*****Nombre****************************************
+ * struct versionVentas
+ *****Descripción***********************************
+ * Estado publicado de las ventas.
+ *****Campos****************************************
+ * @lista: Ventas de la versión (solo lectura).
+ * @numero: Número de versión (1 para los datos iniciales).
+ * @libera_ventas: Si al liberar la versión se libera su
+ *                 arreglo de ventas (ya reemplazado por uno mayor).
+ * @libera_productos: Partes (PARTE_*) del diccionario de productos
+ *                    que la versión siguiente reemplazó.
+ * @libera_categorias: Ídem para el diccionario de categorías.
+ * @epoca_retiro: Época en que la versión dejó de estar vigente.
+ * @siguiente: Siguiente versión retirada.
+ ***************************************************/
+typedef struct versionVentas {
+    listaVentas lista;
+    unsigned long numero;
+    int libera_ventas;
+    unsigned int libera_productos;
+    unsigned int libera_categorias;
+    unsigned long epoca_retiro;
+    struct versionVentas *siguiente;
+} versionVentas;
+
+/*****Nombre****************************************
+ * struct almacenVersiones
+ *****Descripción***********************************
+ * Versiones de las ventas y lectores activos.
+ *****Campos****************************************
+ * @vigente: Versión que ven los lectores nuevos.
+ * @epoca: Época global; avanza con cada publicación.
+ * @lectores: Época de cada lector activo, o 0 si está inactivo.
+ * @escritura: Ordena las publicaciones.
+ * @capacidad: Capacidad del arreglo de ventas compartido.
+ * @retiradas: Versiones reemplazadas aún no liberadas, de la más vieja a la más nueva.
+ * @ultima_retirada: Final de `retiradas`.
+ ***************************************************/
+typedef struct {
+    _Atomic(versionVentas *) vigente;
+    atomic_ulong epoca;
+    atomic_ulong lectores[MAX_LECTORES];
+    pthread_mutex_t escritura;
+    size_t capacidad;
+    versionVentas *retiradas;
+    versionVentas *ultima_retirada;
+} almacenVersiones;
+
+// Libera una versión retirada; las cadenas de los diccionarios siguen en uso por las versiones nuevas
+void liberarVersionVentas(versionVentas *version) {
+    liberarPartesDiccionario(&version->lista.productos, version->libera_productos);
+    liberarPartesDiccionario(&version->lista.categorias, version->libera_categorias);
+    free(version->lista.zonas.zonas);
+    if (version->libera_ventas) {
+        free(version->lista.ventas);
+    }
+    free(version);
+}
+
+/*****Nombre***************************************
+ * Función iniciarAlmacenVersiones
+ *****Descripción**********************************
+ * Crea el almacén con la lista como versión 1. El
+ * almacén toma las ventas, los diccionarios y el mapa
+ * de zonas de la lista hasta cerrarAlmacenVersiones;
+ * los bosquejos quedan en la lista.
+ *****Retorno**************************************
+ * @return: 1 si se creó, 0 si falla la asignación de memoria.
+ ****Entradas**************************************
+ * @param almacen: Almacén a iniciar.
+ * @param lista: Ventas iniciales.
+ **************************************************/
+int iniciarAlmacenVersiones(almacenVersiones *almacen, listaVentas *lista) {
+    versionVentas *version = (versionVentas *)callocContado(1, sizeof(versionVentas));
+    if (version == NULL || !actualizarMapaZonas(lista)) {
+        printf("Error al asignar memoria para el almacén de versiones.\n");
+        free(version);
+        return 0;
+    }
+    version->lista = *lista;
+    version->lista.bosquejos = NULL;
+    version->numero = 1;
+
+    memset(almacen, 0, sizeof(almacenVersiones));
+    atomic_init(&almacen->vigente, version);
+    atomic_init(&almacen->epoca, 1);
+    for (size_t l = 0; l < MAX_LECTORES; l++) {
+        atomic_init(&almacen->lectores[l], 0);
+    }
+    pthread_mutex_init(&almacen->escritura, NULL);
+    almacen->capacidad = lista->capacity;
+    return 1;
+}
+
+// Comienza una lectura del lector `lector`; la versión devuelta no cambia hasta terminarLectura
+versionVentas* comenzarLectura(almacenVersiones *almacen, size_t lector) {
+    atomic_store(&almacen->lectores[lector], atomic_load(&almacen->epoca));
+    return atomic_load(&almacen->vigente);
+}
+
+void terminarLectura(almacenVersiones *almacen, size_t lector) {
+    atomic_store(&almacen->lectores[lector], 0);
+}
+
+// Libera las versiones retiradas que ningún lector activo puede estar usando
+void recolectarVersiones(almacenVersiones *almacen) {
+    unsigned long minima = ULONG_MAX;
+    for (size_t l = 0; l < MAX_LECTORES; l++) {
+        unsigned long epoca = atomic_load(&almacen->lectores[l]);
+        if (epoca != 0 && epoca < minima) {
+            minima = epoca;
+        }
+    }
+    while (almacen->retiradas != NULL && almacen->retiradas->epoca_retiro < minima) {
+        versionVentas *version = almacen->retiradas;
+        almacen->retiradas = version->siguiente;
+        liberarVersionVentas(version);
+    }
+    if (almacen->retiradas == NULL) {
+        almacen->ultima_retirada = NULL;
+    }
+}
+
+/*****Nombre***************************************
+ * Función traducirDiccionarioLote
+ *****Descripción**********************************
+ * Agrega al diccionario de la versión nueva (una copia
+ * superficial del de la vigente) las cadenas del lote
+ * que todavía no tiene, sin modificar lo que leen las
+ * versiones publicadas, y arma la traducción de cada
+ * código del lote al de la versión. El trabajo depende
+ * de las cadenas distintas del lote, no de las filas
+ * ni del tamaño del diccionario compartido.
+ *****Retorno**************************************
+ * @return: Traducción por código del lote (el llamador
+ *          la libera), o NULL si falla la asignación de memoria.
+ ****Entradas**************************************
+ * @param diccionario: Diccionario de la versión nueva.
+ * @param lote: Diccionario del lote.
+ * @param reemplazadas: Recibe las partes (PARTE_*) que la
+ *                      versión nueva dejó de compartir.
+ **************************************************/
+codigoCadena* traducirDiccionarioLote(diccionarioCadenas *diccionario, const diccionarioCadenas *lote, unsigned int *reemplazadas) {
+    *reemplazadas = 0;
+    codigoCadena *traduccion = (codigoCadena *)mallocContado(sizeof(codigoCadena) * (lote->num > 0 ? lote->num : 1));
+    if (traduccion == NULL) {
+        return NULL;
+    }
+
+    size_t nuevas = 0;
+    for (size_t c = 0; c < lote->num; c++) {
+        traduccion[c] = buscarCadena(diccionario, lote->cadenas[c]);
+        nuevas += (traduccion[c] == CODIGO_INVALIDO);
+    }
+    if (nuevas > 0) {
+        if (!ampliarDiccionarioCompartido(diccionario, nuevas, reemplazadas)) {
+            free(traduccion);
+            return NULL;
+        }
+        for (size_t c = 0; c < lote->num; c++) {
+            if (traduccion[c] == CODIGO_INVALIDO) {
+                traduccion[c] = internarCadena(diccionario, lote->cadenas[c]);
+            }
+        }
+    }
+    return traduccion;
+}
+
+// Deshace lo que traducirDiccionarioLote agregó a la copia `nuevo` de `previo`
+void descartarDiccionarioLote(diccionarioCadenas *nuevo, const diccionarioCadenas *previo, unsigned int reemplazadas) {
+    for (size_t c = previo->num; c < nuevo->num; c++) {
+        free(nuevo->cadenas[c]);
+    }
+    liberarPartesDiccionario(nuevo, reemplazadas);
+}
+
+/*****Nombre***************************************
+ * Función publicarVentas
+ *****Descripción**********************************
+ * Agrega las ventas del lote al final del arreglo
+ * compartido y publica la versión resultante. Si el
+ * arreglo no alcanza, se copia a uno del doble de
+ * tamaño y el anterior se libera con la última versión
+ * que lo usa. Las ventas se copian; el lote se puede
+ * liberar con liberarListaVentas.
+ *****Retorno**************************************
+ * @return: Número de la versión publicada, o 0 si falla
+ *          la asignación de memoria (la versión vigente
+ *          no cambia).
+ ****Entradas**************************************
+ * @param almacen: Un puntero al `almacenVersiones`.
+ * @param lote: Ventas a agregar.
+ **************************************************/
+unsigned long publicarVentas(almacenVersiones *almacen, listaVentas *lote) {
+    pthread_mutex_lock(&almacen->escritura);
+    versionVentas *actual = atomic_load(&almacen->vigente);
+    const listaVentas *previa = &actual->lista;
+    size_t size = previa->size + lote->size;
+
+    versionVentas *nueva = (versionVentas *)callocContado(1, sizeof(versionVentas));
+    size_t num_zonas = (size + FILAS_POR_ZONA - 1) / FILAS_POR_ZONA;
+    zonaVentas *zonas = (zonaVentas *)mallocContado(sizeof(zonaVentas) * (num_zonas > 0 ? num_zonas : 1));
+    Venta *ventas = previa->ventas;
+    size_t capacidad = almacen->capacidad;
+    if (size > capacidad) {
+        capacidad = (capacidad * 2 > size) ? capacidad * 2 : size;
+        ventas = (Venta *)mallocContado(sizeof(Venta) * capacidad);
+    }
+    // Los diccionarios parten de los de la versión vigente y solo suman las cadenas nuevas del lote
+    codigoCadena *traduccion_productos = NULL;
+    codigoCadena *traduccion_categorias = NULL;
+    unsigned int partes_productos = 0, partes_categorias = 0;
+    if (nueva != NULL) {
+        nueva->lista.productos = previa->productos;
+        nueva->lista.categorias = previa->categorias;
+        traduccion_productos = traducirDiccionarioLote(&nueva->lista.productos, &lote->productos, &partes_productos);
+        traduccion_categorias = traducirDiccionarioLote(&nueva->lista.categorias, &lote->categorias, &partes_categorias);
+    }
+    if (nueva == NULL || zonas == NULL || ventas == NULL || traduccion_productos == NULL || traduccion_categorias == NULL) {
+        printf("Error al asignar memoria para la nueva versión de las ventas.\n");
+        if (nueva != NULL) {
+            descartarDiccionarioLote(&nueva->lista.productos, &previa->productos, partes_productos);
+            descartarDiccionarioLote(&nueva->lista.categorias, &previa->categorias, partes_categorias);
+            free(nueva);
+        }
+        free(traduccion_productos);
+        free(traduccion_categorias);
+        free(zonas);
+        if (ventas != previa->ventas) free(ventas);
+        pthread_mutex_unlock(&almacen->escritura);
+        return 0;
+    }
+    if (ventas != previa->ventas) {
+        memcpy(ventas, previa->ventas, sizeof(Venta) * previa->size);
+    }
+
+    // Las filas nuevas van después de las que ven los lectores; los códigos se traducen al diccionario de la versión
+    for (size_t i = 0; i < lote->size; i++) {
+        Venta venta = lote->ventas[i];
+        venta.codigo_producto = (venta.codigo_producto < lote->productos.num) ? traduccion_productos[venta.codigo_producto] : CODIGO_INVALIDO;
+        venta.codigo_categoria = (venta.codigo_categoria < lote->categorias.num) ? traduccion_categorias[venta.codigo_categoria] : CODIGO_INVALIDO;
+        ventas[previa->size + i] = venta;
+    }
+    free(traduccion_productos);
+    free(traduccion_categorias);
+
+    listaVentas *lista = &nueva->lista;
+    lista->ventas = ventas;
+    lista->size = size;
+    lista->capacity = capacidad;
+    lista->generacion = previa->generacion + 1;
+    lista->bosquejos = NULL;
+
+    // Las zonas completas de la versión anterior no cambian; el resto se recalcula
+    size_t zonas_completas = previa->size / FILAS_POR_ZONA;
+    memcpy(zonas, previa->zonas.zonas, sizeof(zonaVentas) * zonas_completas);
+    for (size_t z = zonas_completas; z < num_zonas; z++) {
+        zonas[z] = calcularZona(lista, z);
+    }
+    lista->zonas.zonas = zonas;
+    lista->zonas.num_zonas = num_zonas;
+    lista->zonas.generacion = lista->generacion;
+    nueva->numero = actual->numero + 1;
+    almacen->capacidad = capacidad;
+
+    // Publicar y retirar la versión anterior con la época en curso
+    atomic_store(&almacen->vigente, nueva);
+    actual->libera_ventas = (ventas != previa->ventas);
+    actual->libera_productos = partes_productos;
+    actual->libera_categorias = partes_categorias;
+    actual->epoca_retiro = atomic_fetch_add(&almacen->epoca, 1);
+    if (almacen->ultima_retirada != NULL) {
+        almacen->ultima_retirada->siguiente = actual;
+    } else {
+        almacen->retiradas = actual;
+    }
+    almacen->ultima_retirada = actual;
+    recolectarVersiones(almacen);
+
+    unsigned long numero = nueva->numero;
+    pthread_mutex_unlock(&almacen->escritura);
+    return numero;
+}
+
+/*****Nombre***************************************
+ * Función cerrarAlmacenVersiones
+ *****Descripción**********************************
+ * Libera las versiones retiradas y devuelve a la lista
+ * la versión vigente, con las ventas importadas. No
+ * debe quedar ningún lector activo.
+ *****Retorno**************************************
+ *
+ ****Entradas**************************************
+ * @param almacen: Almacén a cerrar.
+ * @param lista: Lista que recibe las ventas (la misma de iniciarAlmacenVersiones).
+ **************************************************/
+void cerrarAlmacenVersiones(almacenVersiones *almacen, listaVentas *lista) {
+    recolectarVersiones(almacen);
+    versionVentas *vigente = atomic_load(&almacen->vigente);
+    bosquejosVentas *bosquejos = lista->bosquejos;
+    *lista = vigente->lista;
+    lista->capacity = almacen->capacidad;
+    lista->bosquejos = bosquejos;
+    free(vigente);
+    pthread_mutex_destroy(&almacen->escritura);
+}
+
+/*****Nombre****************************************
+ * struct archivoPendiente
+ *****Descripción***********************************
+ * Archivo en la cola de ingesta.
+ *****Campos****************************************
+ * @ruta: Ruta del archivo.
+ * @siguiente: Siguiente archivo de la cola.
+ ***************************************************/
+typedef struct archivoPendiente {
+    char *ruta;
+    struct archivoPendiente *siguiente;
+} archivoPendiente;
+
+/*****Nombre****************************************
+ * struct ingestaVentas
+ *****Descripción***********************************
+ * Hilo que importa archivos en segundo plano y publica
+ * cada uno como una versión nueva del almacén.
+ *****Campos****************************************
+ * @almacen: Almacén donde se publican los lotes.
+ * @hilos: Hilos de cada importación.
+ * @hilo: Hilo de ingesta.
+ * @candado: Protege la cola y `detener`.
+ * @aviso: Señala archivos nuevos o la detención.
+ * @primero: Primer archivo pendiente.
+ * @ultimo: Último archivo pendiente.
+ * @pendientes: Archivos en la cola o en importación.
+ * @detener: Pide al hilo que termine.
+ ***************************************************/
+typedef struct {
+    almacenVersiones *almacen;
+    int hilos;
+    pthread_t hilo;
+    pthread_mutex_t candado;
+    pthread_cond_t aviso;
+    archivoPendiente *primero;
+    archivoPendiente *ultimo;
+    size_t pendientes;
+    int detener;
+} ingestaVentas;
+
+void* trabajarIngesta(void *argumento) {
+    ingestaVentas *ingesta = (ingestaVentas *)argumento;
+    pthread_mutex_lock(&ingesta->candado);
+    for (;;) {
+        while (ingesta->primero == NULL && !ingesta->detener) {
+            pthread_cond_wait(&ingesta->aviso, &ingesta->candado);
+        }
+        if (ingesta->detener) {
+            break;
+        }
+        archivoPendiente *archivo = ingesta->primero;
+        ingesta->primero = archivo->siguiente;
+        if (ingesta->primero == NULL) {
+            ingesta->ultimo = NULL;
+        }
+        pthread_mutex_unlock(&ingesta->candado);
+
+        // El lote se importa aparte; los lectores siguen con la versión vigente
+        listaVentas *lote = crearListaVentas();
+        if (lote != NULL) {
+            importarDatosEnParalelo(lote, archivo->ruta, ingesta->hilos);
+            if (lote->size > 0) {
+                unsigned long numero = publicarVentas(ingesta->almacen, lote);
+                if (numero != 0) {
+                    printf("Versión %lu publicada: %zu ventas nuevas de %s.\n", numero, lote->size, archivo->ruta);
+                }
+            }
+            liberarListaVentas(lote);
+        }
+        fflush(stdout);
+        free(archivo->ruta);
+        free(archivo);
+
+        pthread_mutex_lock(&ingesta->candado);
+        ingesta->pendientes--;
+    }
+    pthread_mutex_unlock(&ingesta->candado);
+    return NULL;
+}
+
+// Arranca el hilo de ingesta; devuelve 0 si no se pudo crear
+int iniciarIngesta(ingestaVentas *ingesta, almacenVersiones *almacen, int hilos) {
+    memset(ingesta, 0, sizeof(ingestaVentas));
+    ingesta->almacen = almacen;
+    ingesta->hilos = hilos;
+    pthread_mutex_init(&ingesta->candado, NULL);
+    pthread_cond_init(&ingesta->aviso, NULL);
+    if (pthread_create(&ingesta->hilo, NULL, trabajarIngesta, ingesta) != 0) {
+        pthread_mutex_destroy(&ingesta->candado);
+        pthread_cond_destroy(&ingesta->aviso);
+        return 0;
+    }
+    return 1;
+}
+
+// Agrega un archivo a la cola; devuelve la cantidad de archivos pendientes, o 0 si falla
+size_t encolarIngesta(ingestaVentas *ingesta, const char *ruta) {
+    archivoPendiente *archivo = (archivoPendiente *)mallocContado(sizeof(archivoPendiente));
+    char *copia = strdupContado(ruta);
+    if (archivo == NULL || copia == NULL) {
+        free(archivo);
+        free(copia);
+        return 0;
+    }
+    archivo->ruta = copia;
+    archivo->siguiente = NULL;
+
+    pthread_mutex_lock(&ingesta->candado);
+    if (ingesta->ultimo != NULL) {
+        ingesta->ultimo->siguiente = archivo;
+    } else {
+        ingesta->primero = archivo;
+    }
+    ingesta->ultimo = archivo;
+    size_t pendientes = ++ingesta->pendientes;
+    pthread_cond_signal(&ingesta->aviso);
+    pthread_mutex_unlock(&ingesta->candado);
+    return pendientes;
+}
+
+size_t ingestasPendientes(ingestaVentas *ingesta) {
+    pthread_mutex_lock(&ingesta->candado);
+    size_t pendientes = ingesta->pendientes;
+    pthread_mutex_unlock(&ingesta->candado);
+    return pendientes;
+}
+
+// Detiene el hilo al terminar el archivo en curso; los archivos aún en cola se descartan
+void detenerIngesta(ingestaVentas *ingesta) {
+    pthread_mutex_lock(&ingesta->candado);
+    ingesta->detener = 1;
+    pthread_cond_signal(&ingesta->aviso);
+    pthread_mutex_unlock(&ingesta->candado);
+    pthread_join(ingesta->hilo, NULL);
+
+    while (ingesta->primero != NULL) {
+        archivoPendiente *archivo = ingesta->primero;
+        ingesta->primero = archivo->siguiente;
+        printf("Importación descartada al detener: %s\n", archivo->ruta);
+        free(archivo->ruta);
+        free(archivo);
+    }
+    pthread_mutex_destroy(&ingesta->candado);
+    pthread_cond_destroy(&ingesta->aviso);
+}
+
+#endif // VERSIONES_H